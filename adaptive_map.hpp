@@ -0,0 +1,617 @@
+#ifndef ADAPTIVE_MAP_HPP
+#define ADAPTIVE_MAP_HPP
+
+# include "map.hpp"
+
+namespace ft {
+	/**
+	 * Iterators of adaptive_map
+	 *
+	 * Point either to a slot of the inline array, or to a node of the tree when m_node
+	 * is not NULL, and step accordingly.
+	 *
+	 */
+	template<class T>
+	struct adaptive_iterator {
+		typedef T								value_type;
+		typedef T&								reference;
+		typedef T*								pointer;
+		typedef std::bidirectional_iterator_tag	iterator_category;
+		typedef std::ptrdiff_t					difference_type;
+		typedef adaptive_iterator<T>			_self;
+		typedef rb_node<T>*						_base_ptr;
+
+		adaptive_iterator() : m_slot( NULL ), m_node( NULL ) { }
+		adaptive_iterator(T *slot, _base_ptr node) : m_slot( slot ), m_node( node ) { }
+
+		reference operator*() const { return ( m_node != NULL ) ? m_node->data : *m_slot; }
+		pointer operator->() const { return &**this; }
+
+		_self &operator++(){
+			if ( m_node != NULL )
+				m_node = _rb_tree_increment(m_node);
+			else
+				++m_slot;
+			return *this;
+		}
+
+		_self operator++(int){
+			_self tmp = *this;
+
+			++*this;
+			return tmp;
+		}
+
+		_self &operator--(){
+			if ( m_node != NULL )
+				m_node = _rb_tree_decrement(m_node);
+			else
+				--m_slot;
+			return *this;
+		}
+
+		_self operator--(int){
+			_self tmp = *this;
+
+			--*this;
+			return tmp;
+		}
+
+		bool operator==(const _self &it) const { return m_slot == it.m_slot && m_node == it.m_node; }
+		bool operator!=(const _self &it) const { return !( *this == it ); }
+
+		T			*m_slot;
+		_base_ptr	m_node;
+	};
+
+	template<class T>
+	struct adaptive_const_iterator {
+		typedef T								value_type;
+		typedef const T&						reference;
+		typedef const T*						pointer;
+		typedef std::bidirectional_iterator_tag	iterator_category;
+		typedef std::ptrdiff_t					difference_type;
+		typedef adaptive_const_iterator<T>		_self;
+		typedef rb_node<T>*						_base_ptr;
+
+		adaptive_const_iterator() : m_slot( NULL ), m_node( NULL ) { }
+		adaptive_const_iterator(const T *slot, _base_ptr node) : m_slot( slot ), m_node( node ) { }
+		adaptive_const_iterator(const adaptive_iterator<T> &it) : m_slot( it.m_slot ), m_node( it.m_node ) { }
+
+		reference operator*() const { return ( m_node != NULL ) ? m_node->data : *m_slot; }
+		pointer operator->() const { return &**this; }
+
+		_self &operator++(){
+			if ( m_node != NULL )
+				m_node = _rb_tree_increment(m_node);
+			else
+				++m_slot;
+			return *this;
+		}
+
+		_self operator++(int){
+			_self tmp = *this;
+
+			++*this;
+			return tmp;
+		}
+
+		_self &operator--(){
+			if ( m_node != NULL )
+				m_node = _rb_tree_decrement(m_node);
+			else
+				--m_slot;
+			return *this;
+		}
+
+		_self operator--(int){
+			_self tmp = *this;
+
+			--*this;
+			return tmp;
+		}
+
+		bool operator==(const _self &it) const { return m_slot == it.m_slot && m_node == it.m_node; }
+		bool operator!=(const _self &it) const { return !( *this == it ); }
+
+		const T		*m_slot;
+		_base_ptr	m_node;
+	};
+
+	/**
+	 * Adaptive map
+	 *
+	 * Associative container with the interface of ft::map, holding up to N elements
+	 * sorted in an array inside the container itself: lookups are linear scans over
+	 * contiguous memory, and a small map allocates nothing at all. Inserting one more
+	 * element moves them all to an ft::map, allocated then, and erasing down to N / 2
+	 * elements moves them back to the array. The gap between both thresholds keeps a
+	 * map whose size hovers around N from switching back and forth.
+	 *
+	 * Elements move when the storage switches and, in the array, on every insertion
+	 * and erasure before them. Insertions and erasures thus invalidate all iterators,
+	 * pointers and references, as for a sorted vector.
+	 *
+	 */
+	template<
+		class Key,
+		class T,
+		class Compare = std::less<Key>,
+		class Alloc = std::allocator<ft::pair<const Key, T> >,
+		std::size_t N = 16
+	>
+	class adaptive_map {
+		public:
+			typedef Key												key_type;
+			typedef T												mapped_type;
+			typedef ft::pair<const key_type, mapped_type>			value_type;
+			typedef Compare											key_compare;
+			typedef Alloc											allocator_type;
+			typedef typename allocator_type::reference				reference;
+			typedef typename allocator_type::const_reference		const_reference;
+			typedef typename allocator_type::pointer				pointer;
+			typedef typename allocator_type::const_pointer			const_pointer;
+			typedef std::ptrdiff_t									difference_type;
+			typedef std::size_t										size_type;
+			typedef adaptive_iterator<value_type>					iterator;
+			typedef adaptive_const_iterator<value_type>				const_iterator;
+			typedef ft::reverse_iterator<iterator>					reverse_iterator;
+			typedef ft::reverse_iterator<const_iterator>			const_reverse_iterator;
+			typedef ft::map<Key, T, Compare, Alloc>					map_type;
+
+			class value_compare : std::binary_function<value_type, value_type, bool> {
+				friend class adaptive_map;
+				protected:
+					Compare m_comp;
+					value_compare(Compare comp) : m_comp(comp) {}
+				public:
+					typedef bool result_type;
+					typedef value_type first_argument_type;
+					typedef value_type second_argument_type;
+					bool operator()(const value_type &x, const value_type &y) const {
+						return m_comp(x.first, y.first);
+					}
+			};
+
+		private:
+			typedef std::allocator<map_type>						map_allocator_type;
+
+			union storage_ {
+				char		bytes[N * sizeof(value_type)];
+				long double	align_float;
+				long		align_integer;
+				void		*align_pointer;
+			};
+
+			storage_		m_storage;
+			size_type		m_size;
+			map_type		*m_tree;
+			key_compare		m_comp;
+			allocator_type	m_alloc;
+
+		public:
+			explicit adaptive_map( const key_compare &comp = key_compare(), const allocator_type &alloc = allocator_type() )
+				: m_size( 0 ), m_tree( NULL ), m_comp( comp ), m_alloc( alloc ) { }
+
+			template<class InputIterator>
+			adaptive_map( InputIterator first, InputIterator last, const key_compare &comp = key_compare(),
+				const allocator_type &alloc = allocator_type() )
+				: m_size( 0 ), m_tree( NULL ), m_comp( comp ), m_alloc( alloc )
+			{
+				this->insert(first, last);
+			}
+
+			adaptive_map( const adaptive_map &x )
+				: m_size( 0 ), m_tree( NULL ), m_comp( x.m_comp ), m_alloc( x.m_alloc )
+			{
+				this->assign_(x);
+			}
+
+			adaptive_map &operator=( const adaptive_map &x ){
+				if ( this == &x )
+					return *this;
+				this->clear();
+				m_comp = x.m_comp;
+				this->assign_(x);
+				return *this;
+			}
+
+			~adaptive_map(){
+				this->clear();
+			}
+
+			/**
+			 * Iterators
+			 */
+			iterator begin(){
+				if ( m_tree != NULL )
+					return iterator( NULL, m_tree->begin().m_ptr );
+				return iterator( this->items_(), NULL );
+			}
+
+			const_iterator begin() const {
+				if ( m_tree != NULL )
+					return const_iterator( NULL, m_tree->begin().m_ptr );
+				return const_iterator( this->items_(), NULL );
+			}
+
+			iterator end(){
+				if ( m_tree != NULL )
+					return iterator( NULL, m_tree->end().m_ptr );
+				return iterator( this->items_() + m_size, NULL );
+			}
+
+			const_iterator end() const {
+				if ( m_tree != NULL )
+					return const_iterator( NULL, m_tree->end().m_ptr );
+				return const_iterator( this->items_() + m_size, NULL );
+			}
+
+			reverse_iterator rbegin(){ return reverse_iterator( end() ); }
+			const_reverse_iterator rbegin() const { return const_reverse_iterator( end() ); }
+			reverse_iterator rend(){ return reverse_iterator( begin() ); }
+			const_reverse_iterator rend() const { return const_reverse_iterator( begin() ); }
+
+			/**
+			 * Capacity
+			 */
+			bool empty() const { return this->size() == 0; }
+			size_type size() const { return ( m_tree != NULL ) ? m_tree->size() : m_size; }
+			size_type max_size() const { return typename rb_node<value_type>::node_allocator_type().max_size(); }
+
+			/**
+			 * Whether the elements are held in the inline array.
+			 */
+			bool is_inline() const { return m_tree == NULL; }
+
+			/**
+			 * Element access
+			 */
+			mapped_type &operator[]( const key_type &k ){
+				return this->insert( value_type( k, mapped_type() ) ).first->second;
+			}
+
+			/**
+			 * Modifiers
+			 */
+			ft::pair<iterator, bool> insert( const value_type &val ){
+				value_type	*items = this->items_();
+				size_type	index;
+
+				if ( m_tree != NULL ){
+					ft::pair<typename map_type::iterator, bool> ret = m_tree->insert(val);
+
+					return ft::make_pair(iterator( NULL, ret.first.m_ptr ), ret.second);
+				}
+				index = this->lower_index_(val.first);
+				if ( index < m_size && !m_comp(val.first, items[index].first) )
+					return ft::make_pair(iterator( items + index, NULL ), false);
+				if ( m_size == N ){
+					this->grow_();
+					return this->insert(val);
+				}
+				if ( index == m_size ){
+					m_alloc.construct(items + m_size, val);
+				} else {
+					// Shift the greater elements up by one, last one first
+					m_alloc.construct(items + m_size, items[m_size - 1]);
+					for ( size_type slot = m_size - 1 ; slot > index ; slot-- ){
+						m_alloc.destroy(items + slot);
+						m_alloc.construct(items + slot, items[slot - 1]);
+					}
+					m_alloc.destroy(items + index);
+					m_alloc.construct(items + index, val);
+				}
+				m_size++;
+				return ft::make_pair(iterator( items + index, NULL ), true);
+			}
+
+			iterator insert( iterator position, const value_type &val ){
+				(void)position;
+				return this->insert(val).first;
+			}
+
+			template<class InputIterator>
+			void insert( InputIterator first, InputIterator last ){
+				for ( ; first != last ; ++first ){
+					this->insert(*first);
+				}
+			}
+
+			void erase( iterator position ){
+				if ( m_tree != NULL ){
+					m_tree->erase(typename map_type::iterator( position.m_node ));
+					this->shrink_();
+					return ;
+				}
+				this->erase_slots_(position.m_slot - this->items_(), 1);
+			}
+
+			size_type erase( const key_type &k ){
+				iterator it = this->find(k);
+
+				if ( it == this->end() )
+					return 0;
+				this->erase(it);
+				return 1;
+			}
+
+			void erase( iterator first, iterator last ){
+				if ( m_tree != NULL ){
+					m_tree->erase(typename map_type::iterator( first.m_node ), typename map_type::iterator( last.m_node ));
+					this->shrink_();
+					return ;
+				}
+				this->erase_slots_(first.m_slot - this->items_(), last.m_slot - first.m_slot);
+			}
+
+			/**
+			 * Exchanges the trees, and the inline elements one by one.
+			 */
+			void swap( adaptive_map &x ){
+				adaptive_map	tmp( m_comp, m_alloc );
+				map_type		*tree = m_tree;
+				key_compare		comp = m_comp;
+				allocator_type	alloc = m_alloc;
+
+				if ( this == &x )
+					return ;
+				this->move_items_(tmp);
+				x.move_items_(*this);
+				tmp.move_items_(x);
+				m_tree = x.m_tree;
+				x.m_tree = tree;
+				m_comp = x.m_comp;
+				x.m_comp = comp;
+				m_alloc = x.m_alloc;
+				x.m_alloc = alloc;
+			}
+
+			void clear(){
+				value_type *items = this->items_();
+
+				for ( size_type index = 0 ; index < m_size ; index++ ){
+					m_alloc.destroy(items + index);
+				}
+				m_size = 0;
+				if ( m_tree != NULL ){
+					map_allocator_type().destroy(m_tree);
+					map_allocator_type().deallocate(m_tree, 1);
+					m_tree = NULL;
+				}
+			}
+
+			/**
+			 * Observers
+			 */
+			key_compare key_comp() const { return m_comp; }
+			value_compare value_comp() const { return value_compare( m_comp ); }
+			allocator_type get_allocator() const { return m_alloc; }
+
+			/**
+			 * Operations
+			 */
+			iterator find( const key_type &k ){
+				value_type	*items = this->items_();
+				size_type	index;
+
+				if ( m_tree != NULL )
+					return iterator( NULL, m_tree->find(k).m_ptr );
+				index = this->lower_index_(k);
+				if ( index < m_size && !m_comp(k, items[index].first) )
+					return iterator( items + index, NULL );
+				return this->end();
+			}
+
+			const_iterator find( const key_type &k ) const {
+				const value_type	*items = this->items_();
+				size_type			index;
+
+				if ( m_tree != NULL )
+					return const_iterator( NULL, m_tree->find(k).m_ptr );
+				index = this->lower_index_(k);
+				if ( index < m_size && !m_comp(k, items[index].first) )
+					return const_iterator( items + index, NULL );
+				return this->end();
+			}
+
+			size_type count( const key_type &k ) const {
+				return ( this->find(k) == this->end() ) ? 0 : 1;
+			}
+
+			iterator lower_bound( const key_type &k ){
+				if ( m_tree != NULL )
+					return iterator( NULL, m_tree->lower_bound(k).m_ptr );
+				return iterator( this->items_() + this->lower_index_(k), NULL );
+			}
+
+			const_iterator lower_bound( const key_type &k ) const {
+				if ( m_tree != NULL )
+					return const_iterator( NULL, m_tree->lower_bound(k).m_ptr );
+				return const_iterator( this->items_() + this->lower_index_(k), NULL );
+			}
+
+			iterator upper_bound( const key_type &k ){
+				if ( m_tree != NULL )
+					return iterator( NULL, m_tree->upper_bound(k).m_ptr );
+				return iterator( this->items_() + this->upper_index_(k), NULL );
+			}
+
+			const_iterator upper_bound( const key_type &k ) const {
+				if ( m_tree != NULL )
+					return const_iterator( NULL, m_tree->upper_bound(k).m_ptr );
+				return const_iterator( this->items_() + this->upper_index_(k), NULL );
+			}
+
+			ft::pair<iterator, iterator> equal_range( const key_type &k ){
+				return ft::make_pair(this->lower_bound(k), this->upper_bound(k));
+			}
+
+			ft::pair<const_iterator, const_iterator> equal_range( const key_type &k ) const {
+				return ft::make_pair(this->lower_bound(k), this->upper_bound(k));
+			}
+
+		private:
+			value_type *items_(){
+				return reinterpret_cast<value_type *>( m_storage.bytes );
+			}
+
+			const value_type *items_() const {
+				return reinterpret_cast<const value_type *>( m_storage.bytes );
+			}
+
+			/**
+			 * Linear scans for the first inline element not going before k, and after it.
+			 */
+			size_type lower_index_( const key_type &k ) const {
+				const value_type	*items = this->items_();
+				size_type			index = 0;
+
+				while ( index < m_size && m_comp(items[index].first, k) ){
+					index++;
+				}
+				return index;
+			}
+
+			size_type upper_index_( const key_type &k ) const {
+				const value_type	*items = this->items_();
+				size_type			index = 0;
+
+				while ( index < m_size && !m_comp(k, items[index].first) ){
+					index++;
+				}
+				return index;
+			}
+
+			/**
+			 * Destroys count inline elements from index and moves the following ones down.
+			 */
+			void erase_slots_( size_type index, size_type count ){
+				value_type *items = this->items_();
+
+				if ( count == 0 )
+					return ;
+				for ( size_type slot = index ; slot + count < m_size ; slot++ ){
+					m_alloc.destroy(items + slot);
+					m_alloc.construct(items + slot, items[slot + count]);
+				}
+				for ( size_type slot = ( m_size - count > index ) ? m_size - count : index ; slot < m_size ; slot++ ){
+					m_alloc.destroy(items + slot);
+				}
+				m_size -= count;
+			}
+
+			/**
+			 * Moves the inline elements to the end of the inline array of x.
+			 */
+			void move_items_( adaptive_map &x ){
+				value_type *items = this->items_();
+
+				for ( size_type index = 0 ; index < m_size ; index++ ){
+					x.m_alloc.construct(x.items_() + x.m_size++, items[index]);
+					m_alloc.destroy(items + index);
+				}
+				m_size = 0;
+			}
+
+			/**
+			 * Moves the inline elements to a new tree, appending each of them through
+			 * the hinted insertion at end.
+			 */
+			void grow_(){
+				value_type	*items = this->items_();
+				map_type	*tree = map_allocator_type().allocate(1);
+				bool		constructed = false;
+
+				try {
+					map_allocator_type().construct(tree, map_type( m_comp, m_alloc ));
+					constructed = true;
+					for ( size_type index = 0 ; index < m_size ; index++ ){
+						tree->insert(tree->end(), items[index]);
+					}
+				} catch ( ... ){
+					if ( constructed )
+						map_allocator_type().destroy(tree);
+					map_allocator_type().deallocate(tree, 1);
+					throw ;
+				}
+				for ( size_type index = 0 ; index < m_size ; index++ ){
+					m_alloc.destroy(items + index);
+				}
+				m_size = 0;
+				m_tree = tree;
+			}
+
+			/**
+			 * Moves the elements of the tree back to the inline array once it holds no
+			 * more than N / 2 of them.
+			 */
+			void shrink_(){
+				map_type *tree = m_tree;
+
+				if ( tree->size() > N / 2 )
+					return ;
+				for ( typename map_type::iterator it = tree->begin() ; it != tree->end() ; ++it ){
+					m_alloc.construct(this->items_() + m_size++, *it);
+				}
+				m_tree = NULL;
+				map_allocator_type().destroy(tree);
+				map_allocator_type().deallocate(tree, 1);
+			}
+
+			void assign_( const adaptive_map &x ){
+				if ( x.m_tree != NULL ){
+					map_type *tree = map_allocator_type().allocate(1);
+
+					try {
+						map_allocator_type().construct(tree, *x.m_tree);
+					} catch ( ... ){
+						map_allocator_type().deallocate(tree, 1);
+						throw ;
+					}
+					m_tree = tree;
+					return ;
+				}
+				for ( size_type index = 0 ; index < x.m_size ; index++ ){
+					m_alloc.construct(this->items_() + m_size++, x.items_()[index]);
+				}
+			}
+	};
+
+	template<class Key, class T, class Compare, class Alloc, std::size_t N>
+	void swap( adaptive_map<Key, T, Compare, Alloc, N> &x, adaptive_map<Key, T, Compare, Alloc, N> &y ){
+		x.swap( y );
+	}
+
+	template <class Key, class T, class Compare, class Alloc, std::size_t N>
+	bool operator==( const adaptive_map<Key,T,Compare,Alloc,N>& x, const adaptive_map<Key,T,Compare,Alloc,N>& y ){
+		return x.size() == y.size() && equal(x.begin(), x.end(), y.begin(), y.end());
+	}
+
+	template <class Key, class T, class Compare, class Alloc, std::size_t N>
+	bool operator!=( const adaptive_map<Key,T,Compare,Alloc,N>& x, const adaptive_map<Key,T,Compare,Alloc,N>& y ){
+		return !(x == y);
+	}
+
+	template <class Key, class T, class Compare, class Alloc, std::size_t N>
+	bool operator< ( const adaptive_map<Key,T,Compare,Alloc,N>& x, const adaptive_map<Key,T,Compare,Alloc,N>& y ){
+		return lexicographical_compare(x.begin(), x.end(), y.begin(), y.end());
+	}
+
+	template <class Key, class T, class Compare, class Alloc, std::size_t N>
+	bool operator<=( const adaptive_map<Key,T,Compare,Alloc,N>& x, const adaptive_map<Key,T,Compare,Alloc,N>& y ){
+		return !( y < x );
+	}
+
+	template <class Key, class T, class Compare, class Alloc, std::size_t N>
+	bool operator> ( const adaptive_map<Key,T,Compare,Alloc,N>& x, const adaptive_map<Key,T,Compare,Alloc,N>& y ){
+		return y < x;
+	}
+
+	template <class Key, class T, class Compare, class Alloc, std::size_t N>
+	bool operator>=( const adaptive_map<Key,T,Compare,Alloc,N>& x, const adaptive_map<Key,T,Compare,Alloc,N>& y ){
+		return !( x < y );
+	}
+}
+
+#endif
@@ -0,0 +1,530 @@
+#ifndef BITMAP_SET_HPP
+#define BITMAP_SET_HPP
+
+# include <cstring>
+# include <stdexcept>
+# include <stdint.h>
+# include "map.hpp"
+
+namespace ft {
+	/**
+	 * Index of the lowest and of the highest set bit of a word that is not zero, a
+	 * single instruction (tzcnt or bsf, lzcnt or bsr) where the compiler has one.
+	 */
+	inline unsigned bitmap_lowest_( uint64_t word ){
+# if defined(__GNUC__)
+		return static_cast<unsigned>( __builtin_ctzll(word) );
+# else
+		unsigned bit = 0;
+
+		while ( !( word & 1 ) ){
+			word >>= 1;
+			bit++;
+		}
+		return bit;
+# endif
+	}
+
+	inline unsigned bitmap_highest_( uint64_t word ){
+# if defined(__GNUC__)
+		return static_cast<unsigned>( 63 - __builtin_clzll(word) );
+# else
+		unsigned bit = 63;
+
+		while ( !( word >> bit ) ){
+			bit--;
+		}
+		return bit;
+# endif
+	}
+
+	/**
+	 * Iterators of a bitmap_set
+	 *
+	 * Hold the key they point to rather than a node, the end being npos, and step to
+	 * the next or previous key through the bitmaps. Keys are computed, so they are
+	 * returned by value. An iterator stays valid as long as its key is in the set,
+	 * whatever is inserted, and still steps from there once its key is erased.
+	 *
+	 */
+	template<class Set>
+	struct bitmap_iterator {
+		typedef typename Set::value_type		value_type;
+		typedef value_type						reference;
+		typedef const value_type*				pointer;
+		typedef std::bidirectional_iterator_tag	iterator_category;
+		typedef std::ptrdiff_t					difference_type;
+		typedef typename Set::size_type			size_type;
+		typedef bitmap_iterator<Set>			_self;
+
+		bitmap_iterator() : m_set( NULL ), m_key( Set::npos ) { }
+		bitmap_iterator(const Set *set, size_type key) : m_set( set ), m_key( key ) { }
+
+		reference operator*() const { return static_cast<value_type>( m_key ); }
+
+		_self &operator++(){ m_key = m_set->next_(m_key + 1); return *this; }
+		_self operator++(int){ _self tmp = *this; ++*this; return tmp; }
+		_self &operator--(){
+			m_key = m_set->prev_(( m_key == Set::npos ) ? m_set->m_universe - 1 : m_key - 1);
+			return *this;
+		}
+		_self operator--(int){ _self tmp = *this; --*this; return tmp; }
+
+		bool operator==(const _self &it) const { return m_key == it.m_key; }
+		bool operator!=(const _self &it) const { return m_key != it.m_key; }
+
+		const Set	*m_set;
+		size_type	m_key;
+	};
+
+	/**
+	 * Bitmap set
+	 *
+	 * Ordered set of unsigned integer keys from a bounded universe [0, universe()),
+	 * with the interface of a std::set. It holds one bit per possible key, and above
+	 * those bits levels of summary bits, one per 64 bit word of the level below telling
+	 * whether it has any bit set, up to a single word. Insertions and erasures flip a
+	 * bit and only go up while a word turns empty or stops being so. lower_bound goes
+	 * up until a word has a bit past the key and back down to the lowest bits, one
+	 * tzcnt per level: a 32 bit universe has 6 levels.
+	 *
+	 * Memory is about one bit per possible key, not per element: the universe grows to
+	 * the largest key inserted, doubling, and can be set up front with reserve(). clear
+	 * keeps it, like a vector keeps its capacity.
+	 *
+	 */
+	template<
+		class Key = unsigned int,
+		class Alloc = std::allocator<Key>
+	>
+	class bitmap_set {
+		public:
+			typedef Key												key_type;
+			typedef Key												value_type;
+			typedef std::less<Key>									key_compare;
+			typedef std::less<Key>									value_compare;
+			typedef Alloc											allocator_type;
+			typedef typename allocator_type::reference				reference;
+			typedef typename allocator_type::const_reference		const_reference;
+			typedef typename allocator_type::pointer				pointer;
+			typedef typename allocator_type::const_pointer			const_pointer;
+			typedef std::ptrdiff_t									difference_type;
+			typedef std::size_t										size_type;
+			typedef bitmap_iterator<bitmap_set>						iterator;
+			typedef bitmap_iterator<bitmap_set>						const_iterator;
+			typedef ft::reverse_iterator<iterator>					reverse_iterator;
+			typedef ft::reverse_iterator<const_iterator>			const_reverse_iterator;
+
+			const static size_type									npos = static_cast<size_type>( -1 );
+
+		private:
+			friend struct bitmap_iterator<bitmap_set>;
+
+			typedef typename Alloc::template rebind<uint64_t>::other	word_allocator_type;
+
+			// 64 bit keys need 11 levels of 6 bits
+			const static size_type									LEVELS = 11;
+
+			uint64_t		*m_words;
+			uint64_t		*m_level[LEVELS];
+			size_type		m_count[LEVELS];
+			size_type		m_levels;
+			size_type		m_universe;
+			size_type		m_size;
+			allocator_type	m_alloc;
+
+		public:
+			explicit bitmap_set( const key_compare &comp = key_compare(), const allocator_type &alloc = allocator_type() )
+				: m_words( NULL ), m_levels( 0 ), m_universe( 0 ), m_size( 0 ), m_alloc( alloc )
+			{
+				(void)comp;
+			}
+
+			explicit bitmap_set( size_type universe, const allocator_type &alloc = allocator_type() )
+				: m_words( NULL ), m_levels( 0 ), m_universe( 0 ), m_size( 0 ), m_alloc( alloc )
+			{
+				this->reserve(universe);
+			}
+
+			template<class InputIterator>
+			bitmap_set( InputIterator first, InputIterator last, const key_compare &comp = key_compare(),
+				const allocator_type &alloc = allocator_type() )
+				: m_words( NULL ), m_levels( 0 ), m_universe( 0 ), m_size( 0 ), m_alloc( alloc )
+			{
+				(void)comp;
+				this->insert(first, last);
+			}
+
+			bitmap_set( const bitmap_set &x )
+				: m_words( NULL ), m_levels( 0 ), m_universe( 0 ), m_size( 0 ), m_alloc( x.m_alloc )
+			{
+				this->copy_(x);
+			}
+
+			bitmap_set &operator=( const bitmap_set &x ){
+				if ( this == &x )
+					return *this;
+				this->release_();
+				this->copy_(x);
+				return *this;
+			}
+
+			~bitmap_set(){
+				this->release_();
+			}
+
+			/**
+			 * Iterators
+			 */
+			iterator begin() const { return iterator( this, this->next_(0) ); }
+			iterator end() const { return iterator( this, npos ); }
+			reverse_iterator rbegin() const { return reverse_iterator( end() ); }
+			reverse_iterator rend() const { return reverse_iterator( begin() ); }
+
+			/**
+			 * Capacity
+			 *
+			 * max_size is the size of the largest universe: every value of a key narrower
+			 * than size_type, else as many keys as words can be allocated, a bound
+			 * no allocation reaches anyway.
+			 */
+			bool empty() const { return m_size == 0; }
+			size_type size() const { return m_size; }
+			size_type max_size() const {
+				if ( sizeof(Key) < sizeof(size_type) )
+					return static_cast<size_type>( static_cast<Key>( ~Key() ) ) + 1;
+				return word_allocator_type( m_alloc ).max_size();
+			}
+			size_type universe() const { return m_universe; }
+
+			/**
+			 * Grows the universe to at least universe keys, rounded up to a whole word,
+			 * moving the bits over and building the levels above them again.
+			 */
+			void reserve( size_type universe ){
+				size_type	count[LEVELS];
+				size_type	levels;
+				size_type	total;
+				uint64_t	*words;
+
+				if ( universe <= m_universe )
+					return ;
+				if ( universe > this->max_size() )
+					throw std::length_error("bitmap_set::reserve");
+				levels = layout_(universe, count, total);
+				words = word_allocator_type( m_alloc ).allocate(total);
+				std::memset(words, 0, total * sizeof(uint64_t));
+				if ( m_words != NULL )
+					std::memcpy(words, m_words, m_count[0] * sizeof(uint64_t));
+				this->release_();
+				m_words = words;
+				m_levels = levels;
+				m_universe = count[0] * 64;
+				for ( size_type level = 0 ; level < levels ; level++ ){
+					m_count[level] = count[level];
+					m_level[level] = words;
+					words += count[level];
+				}
+				for ( size_type level = 0 ; level + 1 < levels ; level++ ){
+					for ( size_type index = 0 ; index < m_count[level] ; index++ ){
+						if ( m_level[level][index] != 0 )
+							m_level[level + 1][index >> 6] |= uint64_t( 1 ) << ( index & 63 );
+					}
+				}
+			}
+
+			/**
+			 * Modifiers
+			 */
+			ft::pair<iterator, bool> insert( const value_type &val ){
+				size_type key = static_cast<size_type>( val );
+
+				if ( key >= m_universe )
+					this->grow_(key);
+				if ( !this->set_(key) )
+					return ft::make_pair(iterator( this, key ), false);
+				m_size++;
+				return ft::make_pair(iterator( this, key ), true);
+			}
+
+			iterator insert( iterator position, const value_type &val ){
+				(void)position;
+				return this->insert(val).first;
+			}
+
+			template<class InputIterator>
+			void insert( InputIterator first, InputIterator last ){
+				for ( ; first != last ; ++first ){
+					this->insert(*first);
+				}
+			}
+
+			void erase( iterator position ){
+				this->reset_(position.m_key);
+				m_size--;
+			}
+
+			size_type erase( const key_type &k ){
+				size_type key = static_cast<size_type>( k );
+
+				if ( key >= m_universe || !this->reset_(key) )
+					return 0;
+				m_size--;
+				return 1;
+			}
+
+			void erase( iterator first, iterator last ){
+				while ( first != last ){
+					this->erase(first++);
+				}
+			}
+
+			void swap( bitmap_set &x ){
+				for ( size_type level = 0 ; level < LEVELS ; level++ ){
+					std::swap(m_level[level], x.m_level[level]);
+					std::swap(m_count[level], x.m_count[level]);
+				}
+				std::swap(m_words, x.m_words);
+				std::swap(m_levels, x.m_levels);
+				std::swap(m_universe, x.m_universe);
+				std::swap(m_size, x.m_size);
+				std::swap(m_alloc, x.m_alloc);
+			}
+
+			void clear(){
+				if ( m_words != NULL )
+					std::memset(m_words, 0, this->total_() * sizeof(uint64_t));
+				m_size = 0;
+			}
+
+			/**
+			 * Observers
+			 */
+			key_compare key_comp() const { return key_compare(); }
+			value_compare value_comp() const { return value_compare(); }
+			allocator_type get_allocator() const { return m_alloc; }
+
+			/**
+			 * Operations
+			 */
+			iterator find( const key_type &k ) const {
+				size_type key = static_cast<size_type>( k );
+
+				return this->contains_(key) ? iterator( this, key ) : this->end();
+			}
+
+			size_type count( const key_type &k ) const {
+				return this->contains_(static_cast<size_type>( k )) ? 1 : 0;
+			}
+
+			iterator lower_bound( const key_type &k ) const {
+				return iterator( this, this->next_(static_cast<size_type>( k )) );
+			}
+
+			iterator upper_bound( const key_type &k ) const {
+				size_type key = static_cast<size_type>( k );
+
+				if ( key >= m_universe )
+					return this->end();
+				return iterator( this, this->next_(key + 1) );
+			}
+
+			ft::pair<iterator, iterator> equal_range( const key_type &k ) const {
+				return ft::make_pair(this->lower_bound(k), this->upper_bound(k));
+			}
+
+		private:
+			/**
+			 * Number of words of every level for universe keys, the first level being
+			 * the keys themselves and the last a single word. Returns the number of
+			 * levels, total the number of words of them all.
+			 */
+			static size_type layout_( size_type universe, size_type *count, size_type &total ){
+				size_type levels = 0;
+				size_type words = ( universe + 63 ) / 64;
+
+				total = 0;
+				do {
+					count[levels++] = words;
+					total += words;
+					words = ( words + 63 ) / 64;
+				} while ( count[levels - 1] > 1 );
+				return levels;
+			}
+
+			size_type total_() const {
+				size_type total = 0;
+
+				for ( size_type level = 0 ; level < m_levels ; level++ ){
+					total += m_count[level];
+				}
+				return total;
+			}
+
+			void release_(){
+				if ( m_words != NULL )
+					word_allocator_type( m_alloc ).deallocate(m_words, this->total_());
+				m_words = NULL;
+				m_levels = 0;
+				m_universe = 0;
+			}
+
+			void copy_( const bitmap_set &x ){
+				m_size = x.m_size;
+				if ( x.m_words == NULL )
+					return ;
+				this->reserve(x.m_universe);
+				std::memcpy(m_words, x.m_words, x.total_() * sizeof(uint64_t));
+			}
+
+			/**
+			 * Makes room for key, at least doubling the universe.
+			 */
+			void grow_( size_type key ){
+				size_type universe = 2 * m_universe;
+
+				if ( key >= this->max_size() )
+					throw std::length_error("bitmap_set::insert");
+				if ( universe < key + 1 )
+					universe = key + 1;
+				if ( universe > this->max_size() )
+					universe = this->max_size();
+				this->reserve(universe);
+			}
+
+			bool contains_( size_type key ) const {
+				return key < m_universe && ( m_level[0][key >> 6] >> ( key & 63 ) & 1 );
+			}
+
+			/**
+			 * Sets the bit of key, then the summary bits above as long as the word
+			 * below was empty. Returns false if key was already there.
+			 */
+			bool set_( size_type key ){
+				for ( size_type level = 0 ; level < m_levels ; level++ ){
+					uint64_t	&word = m_level[level][key >> 6];
+					uint64_t	bit = uint64_t( 1 ) << ( key & 63 );
+					bool		was_empty = ( word == 0 );
+
+					if ( level == 0 && ( word & bit ) )
+						return false;
+					word |= bit;
+					if ( !was_empty )
+						break ;
+					key >>= 6;
+				}
+				return true;
+			}
+
+			/**
+			 * Clears the bit of key, then the summary bits above as long as the word
+			 * below gets empty. Returns false if key was not there.
+			 */
+			bool reset_( size_type key ){
+				for ( size_type level = 0 ; level < m_levels ; level++ ){
+					uint64_t	&word = m_level[level][key >> 6];
+					uint64_t	bit = uint64_t( 1 ) << ( key & 63 );
+
+					if ( level == 0 && !( word & bit ) )
+						return false;
+					word &= ~bit;
+					if ( word != 0 )
+						break ;
+					key >>= 6;
+				}
+				return true;
+			}
+
+			/**
+			 * Least key of the set from key on, npos if there is none. Goes up while
+			 * the word of key has no bit from key on, moving to the next word, then down
+			 * through the lowest bit of every word.
+			 */
+			size_type next_( size_type key ) const {
+				size_type level = 0;
+
+				if ( key >= m_universe )
+					return npos;
+				while ( true ){
+					uint64_t word = m_level[level][key >> 6] & ( ~uint64_t( 0 ) << ( key & 63 ) );
+
+					if ( word != 0 ){
+						key = ( key & ~static_cast<size_type>( 63 ) ) | bitmap_lowest_(word);
+						break ;
+					}
+					key = ( key >> 6 ) + 1;
+					if ( ++level == m_levels || key >= m_count[level - 1] )
+						return npos;
+				}
+				while ( level > 0 ){
+					level--;
+					key = ( key << 6 ) | bitmap_lowest_(m_level[level][key]);
+				}
+				return key;
+			}
+
+			/**
+			 * Greatest key of the set up to key, which is in the universe, npos if there
+			 * is none. Same as next_ the other way.
+			 */
+			size_type prev_( size_type key ) const {
+				size_type level = 0;
+
+				if ( m_levels == 0 )
+					return npos;
+				while ( true ){
+					uint64_t word = m_level[level][key >> 6] & ( ~uint64_t( 0 ) >> ( 63 - ( key & 63 ) ) );
+
+					if ( word != 0 ){
+						key = ( key & ~static_cast<size_type>( 63 ) ) | bitmap_highest_(word);
+						break ;
+					}
+					if ( ( key >> 6 ) == 0 || ++level == m_levels )
+						return npos;
+					key = ( key >> 6 ) - 1;
+				}
+				while ( level > 0 ){
+					level--;
+					key = ( key << 6 ) | bitmap_highest_(m_level[level][key]);
+				}
+				return key;
+			}
+	};
+
+	template<class Key, class Alloc>
+	void swap( bitmap_set<Key, Alloc> &x, bitmap_set<Key, Alloc> &y ){
+		x.swap( y );
+	}
+
+	template <class Key, class Alloc>
+	bool operator==( const bitmap_set<Key,Alloc>& x, const bitmap_set<Key,Alloc>& y ){
+		return x.size() == y.size() && ft::equal(x.begin(), x.end(), y.begin(), y.end());
+	}
+
+	template <class Key, class Alloc>
+	bool operator!=( const bitmap_set<Key,Alloc>& x, const bitmap_set<Key,Alloc>& y ){
+		return !(x == y);
+	}
+
+	template <class Key, class Alloc>
+	bool operator< ( const bitmap_set<Key,Alloc>& x, const bitmap_set<Key,Alloc>& y ){
+		return ft::lexicographical_compare(x.begin(), x.end(), y.begin(), y.end());
+	}
+
+	template <class Key, class Alloc>
+	bool operator<=( const bitmap_set<Key,Alloc>& x, const bitmap_set<Key,Alloc>& y ){
+		return !( y < x );
+	}
+
+	template <class Key, class Alloc>
+	bool operator> ( const bitmap_set<Key,Alloc>& x, const bitmap_set<Key,Alloc>& y ){
+		return y < x;
+	}
+
+	template <class Key, class Alloc>
+	bool operator>=( const bitmap_set<Key,Alloc>& x, const bitmap_set<Key,Alloc>& y ){
+		return !( x < y );
+	}
+}
+
+#endif
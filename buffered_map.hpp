@@ -0,0 +1,374 @@
+#ifndef BUFFERED_MAP_HPP
+#define BUFFERED_MAP_HPP
+
+# include <functional>
+# include <memory>
+# include <stdexcept>
+# include "map.hpp"
+# include "lazy_sorted_vector.hpp"
+# include "algorithm/algorithm.hpp"
+# include "utility/pair.hpp"
+
+namespace ft {
+	/**
+	 * A write waiting in the log of a buffered_map.
+	 */
+	template<class Key, class T>
+	struct buffered_write {
+		enum kind_type { INSERT, ASSIGN, ERASE };
+
+		Key			key;
+		T			mapped;
+		kind_type	kind;
+
+		buffered_write( const Key &k, const T &obj, kind_type what ) : key( k ), mapped( obj ), kind( what ) { }
+	};
+
+	template<class Write, class Compare>
+	struct buffered_write_less {
+		Compare comp;
+
+		explicit buffered_write_less( const Compare &c = Compare() ) : comp( c ) { }
+
+		bool operator()( const Write &x, const Write &y ) const {
+			return comp(x.key, y.key);
+		}
+	};
+
+	/**
+	 * Buffered map
+	 *
+	 * ft::map with a write-combining log in front of it. insert, insert_or_assign and
+	 * erase append to a ft::lazy_sorted_vector in amortized O(1) instead of descending
+	 * the tree. When the log holds buffer_size() writes, 65536 by default, it is sorted,
+	 * the writes to a key kept in the order they were made, and applied to the tree in
+	 * one pass: each key is searched from the node of the previous one with the finger
+	 * search of map::insert_sorted_batch, so a burst of random writes becomes a walk
+	 * through the tree in key order. The log has to be large for that walk to save
+	 * anything: keys thousands of elements apart cost as much as a descent from the root.
+	 *
+	 * count and at look in the log before the tree. Everything returning tree iterators,
+	 * as well as size and empty, applies the log first; they are const but may write to
+	 * the tree, so a buffered_map with writes pending must not be read from several
+	 * threads at once. Iterators are invalidated when the log is applied. mapped_type
+	 * must be default constructible, as for operator[].
+	 *
+	 */
+	template<
+		class Key,
+		class T,
+		class Compare = std::less<Key>,
+		class Alloc = std::allocator<ft::pair<const Key, T> >
+	>
+	class buffered_map {
+		public:
+			typedef ft::map<Key, T, Compare, Alloc>					map_type;
+			typedef Key												key_type;
+			typedef T												mapped_type;
+			typedef typename map_type::value_type					value_type;
+			typedef Compare											key_compare;
+			typedef typename map_type::value_compare				value_compare;
+			typedef Alloc											allocator_type;
+			typedef typename map_type::reference					reference;
+			typedef typename map_type::const_reference				const_reference;
+			typedef typename map_type::pointer						pointer;
+			typedef typename map_type::const_pointer				const_pointer;
+			typedef typename map_type::difference_type				difference_type;
+			typedef typename map_type::size_type					size_type;
+			typedef typename map_type::iterator						iterator;
+			typedef typename map_type::const_iterator				const_iterator;
+			typedef typename map_type::reverse_iterator				reverse_iterator;
+			typedef typename map_type::const_reverse_iterator		const_reverse_iterator;
+
+		private:
+			typedef ft::buffered_write<Key, T>						write_type;
+			typedef ft::buffered_write_less<write_type, Compare>	write_less;
+			typedef typename Alloc::template rebind<write_type>::other	write_allocator_type;
+			typedef ft::lazy_sorted_vector<write_type, write_less, write_allocator_type>	log_type;
+			typedef typename log_type::const_iterator				log_iterator;
+			typedef ft::vector<write_type, write_allocator_type>	tail_type;
+			typedef typename map_type::node_pointer					node_pointer;
+			typedef typename map_type::insert_handle				insert_handle;
+
+			const static size_type									DEFAULT_BUFFER_SIZE = 65536;
+			const static size_type									TAIL_SIZE = 256;
+
+			mutable map_type	m_tree;
+			mutable log_type	m_log;
+			mutable tail_type	m_tail;
+			size_type			m_buffer_size;
+
+		public:
+			explicit buffered_map( const key_compare &comp = key_compare(), const allocator_type &alloc = allocator_type() )
+				: m_tree( comp, alloc ), m_log( write_less( comp ), write_allocator_type( alloc ) ),
+				m_tail( write_allocator_type( alloc ) ), m_buffer_size( DEFAULT_BUFFER_SIZE ) { }
+
+			template<class InputIterator>
+			buffered_map( InputIterator first, InputIterator last, const key_compare &comp = key_compare(),
+				const allocator_type &alloc = allocator_type() )
+				: m_tree( first, last, comp, alloc ), m_log( write_less( comp ), write_allocator_type( alloc ) ),
+				m_tail( write_allocator_type( alloc ) ), m_buffer_size( DEFAULT_BUFFER_SIZE ) { }
+
+			/**
+			 * Iterators
+			 */
+			iterator begin(){ this->flush(); return m_tree.begin(); }
+			const_iterator begin() const { this->flush(); return static_cast<const map_type &>(m_tree).begin(); }
+			iterator end(){ this->flush(); return m_tree.end(); }
+			const_iterator end() const { this->flush(); return static_cast<const map_type &>(m_tree).end(); }
+			reverse_iterator rbegin(){ return reverse_iterator( this->end() ); }
+			const_reverse_iterator rbegin() const { return const_reverse_iterator( this->end() ); }
+			reverse_iterator rend(){ return reverse_iterator( this->begin() ); }
+			const_reverse_iterator rend() const { return const_reverse_iterator( this->begin() ); }
+
+			/**
+			 * Capacity
+			 *
+			 * A write in the log may or may not change the size, so size and empty apply it.
+			 */
+			bool empty() const { this->flush(); return m_tree.empty(); }
+			size_type size() const { this->flush(); return m_tree.size(); }
+			size_type max_size() const { return m_tree.max_size(); }
+
+			/**
+			 * Number of writes the log holds before it is applied to the tree.
+			 */
+			size_type buffer_size() const { return m_buffer_size; }
+
+			void buffer_size( size_type n ){
+				m_buffer_size = n > 0 ? n : 1;
+				if ( m_log.size() + m_tail.size() >= m_buffer_size )
+					this->flush();
+			}
+
+			/**
+			 * Element access
+			 */
+			mapped_type &operator[]( const key_type &k ){
+				this->flush();
+				return m_tree[k];
+			}
+
+			const mapped_type &at( const key_type &k ) const {
+				const mapped_type *value = this->lookup_(k);
+
+				if ( value == NULL )
+					throw std::out_of_range("buffered_map::at");
+				return *value;
+			}
+
+			/**
+			 * Modifiers
+			 *
+			 * Writes go to the log. insert leaves the value of a key already present, as
+			 * map::insert does, insert_or_assign replaces it.
+			 */
+			void insert( const value_type &val ){
+				this->write_(write_type( val.first, val.second, write_type::INSERT ));
+			}
+
+			template<class InputIterator>
+			void insert( InputIterator first, InputIterator last ){
+				for ( ; first != last ; ++first ){
+					this->insert(*first);
+				}
+			}
+
+			void insert_or_assign( const key_type &k, const mapped_type &obj ){
+				this->write_(write_type( k, obj, write_type::ASSIGN ));
+			}
+
+			void erase( const key_type &k ){
+				this->write_(write_type( k, mapped_type(), write_type::ERASE ));
+			}
+
+			void swap( buffered_map &x ){
+				size_type buffer_size = m_buffer_size;
+
+				m_tree.swap(x.m_tree);
+				m_log.swap(x.m_log);
+				m_tail.swap(x.m_tail);
+				m_buffer_size = x.m_buffer_size;
+				x.m_buffer_size = buffer_size;
+			}
+
+			void clear(){
+				m_log.clear();
+				m_tail.clear();
+				m_tree.clear();
+			}
+
+			/**
+			 * Applies the writes of the log to the tree, in key order. Reads returning
+			 * iterators do it first; calling it ahead keeps the cost out of them.
+			 */
+			void flush() const {
+				node_pointer finger = NULL;
+
+				m_log.insert(m_tail.begin(), m_tail.end());
+				m_tail.clear();
+				for ( log_iterator it = m_log.begin() ; it != m_log.end() ; ++it ){
+					finger = this->apply_(*it, finger);
+				}
+				m_log.clear();
+			}
+
+			/**
+			 * Observers
+			 */
+			key_compare key_comp() const { return m_tree.key_comp(); }
+			value_compare value_comp() const { return m_tree.value_comp(); }
+			allocator_type get_allocator() const { return m_tree.get_allocator(); }
+
+			/**
+			 * Operations
+			 *
+			 * count looks in the log first and only reads the tree when the writes to k
+			 * there do not settle it.
+			 */
+			size_type count( const key_type &k ) const {
+				return this->lookup_(k) != NULL;
+			}
+
+			iterator find( const key_type &k ){ this->flush(); return m_tree.find(k); }
+			const_iterator find( const key_type &k ) const { this->flush(); return static_cast<const map_type &>(m_tree).find(k); }
+			iterator lower_bound( const key_type &k ){ this->flush(); return m_tree.lower_bound(k); }
+			const_iterator lower_bound( const key_type &k ) const { this->flush(); return static_cast<const map_type &>(m_tree).lower_bound(k); }
+			iterator upper_bound( const key_type &k ){ this->flush(); return m_tree.upper_bound(k); }
+			const_iterator upper_bound( const key_type &k ) const { this->flush(); return static_cast<const map_type &>(m_tree).upper_bound(k); }
+
+			ft::pair<iterator, iterator> equal_range( const key_type &k ){
+				return ft::make_pair(this->lower_bound(k), this->upper_bound(k));
+			}
+
+			ft::pair<const_iterator, const_iterator> equal_range( const key_type &k ) const {
+				return ft::make_pair(this->lower_bound(k), this->upper_bound(k));
+			}
+
+		private:
+			/**
+			 * The last writes stay in a short unsorted tail, scanned by lookups, and only
+			 * join the log by TAIL_SIZE. The log is then sorted by the next lookup or when
+			 * applied, so reading between writes sorts it at most once per TAIL_SIZE writes.
+			 */
+			void write_( const write_type &w ){
+				m_tail.push_back(w);
+				if ( m_tail.size() < TAIL_SIZE && m_log.size() + m_tail.size() < m_buffer_size )
+					return ;
+				m_log.insert(m_tail.begin(), m_tail.end());
+				m_tail.clear();
+				if ( m_log.size() >= m_buffer_size )
+					this->flush();
+			}
+
+			/**
+			 * Runs the writes to k in the log then in the tail, oldest first, from the
+			 * state of the tree. An erase or an insert_or_assign settles the key; an insert
+			 * only matters when the key is missing, which for an insert before any of them
+			 * is only known from the tree. Returns the value of k, or NULL if it is absent.
+			 */
+			const mapped_type *lookup_( const key_type &k ) const {
+				ft::pair<log_iterator, log_iterator>	range = m_log.equal_range(write_type( k, mapped_type(), write_type::ERASE ));
+				key_compare								comp = m_tree.key_comp();
+				const write_type						*settled = NULL;
+				const write_type						*fallback = NULL;
+				bool									absent = false;
+				const_iterator							it;
+
+				for ( ; range.first != range.second ; ++range.first ){
+					run_(*range.first, settled, fallback, absent);
+				}
+				for ( size_type index = 0 ; index < m_tail.size() ; index++ ){
+					if ( !comp(m_tail[index].key, k) && !comp(k, m_tail[index].key) )
+						run_(m_tail[index], settled, fallback, absent);
+				}
+				if ( settled != NULL )
+					return &settled->mapped;
+				if ( absent )
+					return NULL;
+				it = static_cast<const map_type &>(m_tree).find(k);
+				if ( it != static_cast<const map_type &>(m_tree).end() )
+					return &it->second;
+				return fallback != NULL ? &fallback->mapped : NULL;
+			}
+
+			static void run_( const write_type &w, const write_type *&settled, const write_type *&fallback, bool &absent ){
+				if ( w.kind == write_type::ERASE ){
+					settled = NULL;
+					absent = true;
+				} else if ( w.kind == write_type::ASSIGN || absent ){
+					settled = &w;
+					absent = false;
+				} else if ( settled == NULL && fallback == NULL ){
+					fallback = &w;
+				}
+			}
+
+			/**
+			 * Applies one write, searching its key from finger, the node of the previous
+			 * key, and returns the node to search the next key from.
+			 */
+			node_pointer apply_( const write_type &w, node_pointer finger ) const {
+				insert_handle handle;
+
+				if ( finger == NULL )
+					handle = m_tree.insert_check(w.key);
+				else
+					handle = m_tree.rb_finger_check_(finger, w.key);
+				if ( w.kind == write_type::ERASE ){
+					if ( handle.found() ){
+						iterator position = handle.position();
+						iterator next = position;
+
+						++next;
+						m_tree.erase(position);
+						return next == m_tree.end() ? NULL : next.m_ptr;
+					}
+					return finger;
+				}
+				if ( handle.found() ){
+					if ( w.kind == write_type::ASSIGN )
+						handle.position()->second = w.mapped;
+					return handle.position().m_ptr;
+				}
+				return m_tree.insert_commit(handle, value_type( w.key, w.mapped )).m_ptr;
+			}
+	};
+
+	template<class Key, class T, class Compare, class Alloc>
+	void swap( buffered_map<Key, T, Compare, Alloc> &x, buffered_map<Key, T, Compare, Alloc> &y ){
+		x.swap( y );
+	}
+
+	template <class Key, class T, class Compare, class Alloc>
+	bool operator==( const buffered_map<Key,T,Compare,Alloc>& x, const buffered_map<Key,T,Compare,Alloc>& y ){
+		return x.size() == y.size() && ft::equal(x.begin(), x.end(), y.begin(), y.end());
+	}
+
+	template <class Key, class T, class Compare, class Alloc>
+	bool operator!=( const buffered_map<Key,T,Compare,Alloc>& x, const buffered_map<Key,T,Compare,Alloc>& y ){
+		return !(x == y);
+	}
+
+	template <class Key, class T, class Compare, class Alloc>
+	bool operator< ( const buffered_map<Key,T,Compare,Alloc>& x, const buffered_map<Key,T,Compare,Alloc>& y ){
+		return ft::lexicographical_compare(x.begin(), x.end(), y.begin(), y.end());
+	}
+
+	template <class Key, class T, class Compare, class Alloc>
+	bool operator<=( const buffered_map<Key,T,Compare,Alloc>& x, const buffered_map<Key,T,Compare,Alloc>& y ){
+		return !( y < x );
+	}
+
+	template <class Key, class T, class Compare, class Alloc>
+	bool operator> ( const buffered_map<Key,T,Compare,Alloc>& x, const buffered_map<Key,T,Compare,Alloc>& y ){
+		return y < x;
+	}
+
+	template <class Key, class T, class Compare, class Alloc>
+	bool operator>=( const buffered_map<Key,T,Compare,Alloc>& x, const buffered_map<Key,T,Compare,Alloc>& y ){
+		return !( x < y );
+	}
+}
+
+#endif
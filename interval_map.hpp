@@ -0,0 +1,241 @@
+#ifndef INTERVAL_MAP_HPP
+#define INTERVAL_MAP_HPP
+
+# include "map.hpp"
+
+namespace ft {
+	/**
+	 * Interval order
+	 *
+	 * Orders intervals by their low endpoint, then by their high endpoint.
+	 *
+	 */
+	template<class Point, class Compare>
+	struct interval_less {
+		Compare comp;
+
+		interval_less(const Compare &__comp = Compare()) : comp( __comp ) { }
+
+		bool operator()(const ft::pair<Point, Point> &x, const ft::pair<Point, Point> &y) const {
+			if ( comp(x.first, y.first) )
+				return true;
+			if ( comp(y.first, x.first) )
+				return false;
+			return comp(x.second, y.second);
+		}
+	};
+
+	/**
+	 * Subtree max endpoint
+	 *
+	 * Augment of the tree of an interval_map: the greatest high endpoint of a subtree,
+	 * empty for an empty one.
+	 *
+	 */
+	template<class Point, class T, class Compare>
+	struct interval_max_end {
+		struct summary_type {
+			bool	empty;
+			Point	max;
+		};
+
+		summary_type identity() const {
+			summary_type s;
+
+			s.empty = true;
+			s.max = Point();
+			return s;
+		}
+
+		summary_type lift(const ft::pair<const ft::pair<Point, Point>, T> &x) const {
+			summary_type s;
+
+			s.empty = false;
+			s.max = x.first.second;
+			return s;
+		}
+
+		summary_type combine(const summary_type &a, const summary_type &b) const {
+			if ( a.empty || ( !b.empty && Compare()(a.max, b.max) ) )
+				return b;
+			return a;
+		}
+	};
+
+	/**
+	 * Interval map
+	 *
+	 * Associative container whose keys are closed intervals [lo, hi] of points, stored as
+	 * ft::pair<Point, Point> with !comp(hi, lo). Intervals are unique and ordered by low
+	 * then high endpoint, several intervals may share an endpoint or overlap.
+	 *
+	 * It is a map on the same red black tree as ft::map, augmented with the greatest
+	 * high endpoint of every subtree, which insertions, erasures and rotations keep up
+	 * to date. Compare is default constructed to combine endpoints, so it must not hold
+	 * any state.
+	 *
+	 */
+	template<
+		class Point,
+		class T,
+		class Compare = std::less<Point>,
+		class Alloc = std::allocator<ft::pair<const ft::pair<Point, Point>, T> >
+	>
+	class interval_map {
+		public:
+			typedef Point													point_type;
+			typedef ft::pair<Point, Point>									key_type;
+			typedef T														mapped_type;
+			typedef ft::pair<const key_type, mapped_type>					value_type;
+			typedef Compare													point_compare;
+			typedef interval_less<Point, Compare>							key_compare;
+			typedef Alloc													allocator_type;
+			typedef ft::map<key_type, mapped_type, key_compare, allocator_type,
+				interval_max_end<Point, T, Compare> >						map_type;
+			typedef typename map_type::iterator								iterator;
+			typedef typename map_type::const_iterator						const_iterator;
+			typedef typename map_type::reverse_iterator						reverse_iterator;
+			typedef typename map_type::const_reverse_iterator				const_reverse_iterator;
+			typedef typename map_type::size_type							size_type;
+
+		private:
+			typedef typename map_type::node_type							node_type;
+			typedef typename map_type::node_pointer							node_pointer;
+			typedef typename map_type::summary_type							summary_type;
+
+			map_type		m_map;
+			point_compare	m_comp;
+
+		public:
+			explicit interval_map( const point_compare &comp = point_compare(), const allocator_type &alloc = allocator_type() )
+				: m_map( key_compare( comp ), alloc ), m_comp( comp ) { }
+
+			template<class InputIterator>
+			interval_map( InputIterator first, InputIterator last, const point_compare &comp = point_compare(),
+				const allocator_type &alloc = allocator_type() )
+				: m_map( first, last, key_compare( comp ), alloc ), m_comp( comp ) { }
+
+			interval_map( const interval_map &x ) : m_map( x.m_map ), m_comp( x.m_comp ) { }
+
+			interval_map &operator=( const interval_map &x ){
+				m_map = x.m_map;
+				m_comp = x.m_comp;
+				return *this;
+			}
+
+			iterator begin() { return m_map.begin(); }
+			const_iterator begin() const { return m_map.begin(); }
+			iterator end() { return m_map.end(); }
+			const_iterator end() const { return m_map.end(); }
+			reverse_iterator rbegin() { return m_map.rbegin(); }
+			const_reverse_iterator rbegin() const { return m_map.rbegin(); }
+			reverse_iterator rend() { return m_map.rend(); }
+			const_reverse_iterator rend() const { return m_map.rend(); }
+
+			bool empty() const { return m_map.empty(); }
+			size_type size() const { return m_map.size(); }
+			size_type max_size() const { return m_map.max_size(); }
+
+			ft::pair<iterator, bool> insert( const value_type &val ){
+				return m_map.insert( val );
+			}
+
+			ft::pair<iterator, bool> insert( const point_type &lo, const point_type &hi, const mapped_type &val ){
+				return m_map.insert( value_type( key_type( lo, hi ), val ) );
+			}
+
+			void erase( iterator position ){ m_map.erase( position ); }
+			size_type erase( const key_type &k ){ return m_map.erase( k ); }
+			void erase( iterator first, iterator last ){ m_map.erase( first, last ); }
+
+			void swap( interval_map &x ){
+				point_compare tmp = m_comp;
+
+				m_map.swap( x.m_map );
+				m_comp = x.m_comp;
+				x.m_comp = tmp;
+			}
+
+			void clear(){ m_map.clear(); }
+
+			iterator find( const key_type &k ){ return m_map.find( k ); }
+			const_iterator find( const key_type &k ) const { return m_map.find( k ); }
+			size_type count( const key_type &k ) const { return m_map.count( k ); }
+
+			point_compare point_comp() const { return m_comp; }
+			key_compare key_comp() const { return m_map.key_comp(); }
+			allocator_type get_allocator() const { return m_map.get_allocator(); }
+
+			/**
+			 * Overlap queries
+			 *
+			 * Writes to out, in key order, an iterator to every interval overlapping [a, b],
+			 * that is every [lo, hi] with !comp(b, lo) and !comp(hi, a), and returns the end
+			 * of the output. overlapping(p, p, out) gives the intervals containing p.
+			 *
+			 * The in-order walk skips every subtree whose max endpoint goes before a, and
+			 * stops at the first low endpoint after b, so only the paths leading to the k
+			 * intervals reported are walked: O(log n + k log(n / k)) at worst, O(log n) to
+			 * find that none overlaps.
+			 */
+			template<class OutputIterator>
+			OutputIterator overlapping( const point_type &a, const point_type &b, OutputIterator out ){
+				return this->overlap_<iterator>( m_map.m_root, a, b, out );
+			}
+
+			template<class OutputIterator>
+			OutputIterator overlapping( const point_type &a, const point_type &b, OutputIterator out ) const {
+				return this->overlap_<const_iterator>( m_map.m_root, a, b, out );
+			}
+
+			/**
+			 * Whether some interval overlaps [a, b], in O(log n).
+			 */
+			bool overlaps( const point_type &a, const point_type &b ) const {
+				node_pointer x = m_map.m_root;
+
+				while ( this->reaches_(x, a) ){
+					if ( this->reaches_(x->left, a) ){
+						x = x->left;
+					} else if ( m_comp(b, x->data.first.first) ){
+						return false;
+					} else if ( !m_comp(x->data.first.second, a) ){
+						return true;
+					} else {
+						x = x->right;
+					}
+				}
+				return false;
+			}
+
+		private:
+			/**
+			 * Whether the subtree x holds an interval whose high endpoint does not go before a.
+			 */
+			bool reaches_( node_pointer x, const point_type &a ) const {
+				summary_type s = node_type::summary_of( x );
+
+				return !s.empty && !m_comp(s.max, a);
+			}
+
+			template<class Iterator, class OutputIterator>
+			OutputIterator overlap_( node_pointer x, const point_type &a, const point_type &b, OutputIterator out ) const {
+				while ( this->reaches_(x, a) ){
+					out = this->overlap_<Iterator>( x->left, a, b, out );
+					if ( m_comp(b, x->data.first.first) )
+						break ;
+					if ( !m_comp(x->data.first.second, a) )
+						*out++ = Iterator( x );
+					x = x->right;
+				}
+				return out;
+			}
+	};
+
+	template<class Point, class T, class Compare, class Alloc>
+	void swap( interval_map<Point, T, Compare, Alloc> &x, interval_map<Point, T, Compare, Alloc> &y ){
+		x.swap( y );
+	}
+}
+
+#endif
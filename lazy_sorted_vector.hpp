@@ -0,0 +1,340 @@
+#ifndef LAZY_SORTED_VECTOR_HPP
+#define LAZY_SORTED_VECTOR_HPP
+
+# include <functional>
+# include <memory>
+# include "vector.hpp"
+# include "algorithm/algorithm.hpp"
+# include "utility/pair.hpp"
+
+namespace ft {
+	/**
+	 * Lazy sorted vector
+	 *
+	 * Sorted sequence of values in a ft::vector, equivalent values kept in the order
+	 * they came, with the lookups of a std::multiset. Appending does not sort: values go
+	 * to an unsorted tail at the end of the vector in amortized O(1). The first ordered
+	 * access after appends sorts the tail, merge sort falling back to insertion sort on
+	 * small ranges, then merges it into the sorted prefix in one pass from the back, the
+	 * prefix only moving from the first value the tail goes before. Lookups are binary
+	 * searches on contiguous memory.
+	 *
+	 * Ordered accesses are const but may sort, so a lazy_sorted_vector with appends
+	 * pending must not be read from several threads at once. Iterators are those of the
+	 * vector: any append may reallocate it and invalidate them all, and the first ordered
+	 * access after appends moves the values, so that no iterator taken before it can be
+	 * relied on either.
+	 *
+	 */
+	template<
+		class T,
+		class Compare = std::less<T>,
+		class Alloc = std::allocator<T>
+	>
+	class lazy_sorted_vector {
+		public:
+			typedef T												key_type;
+			typedef T												value_type;
+			typedef Compare											key_compare;
+			typedef Compare											value_compare;
+			typedef Alloc											allocator_type;
+			typedef typename allocator_type::reference				reference;
+			typedef typename allocator_type::const_reference		const_reference;
+			typedef typename allocator_type::pointer				pointer;
+			typedef typename allocator_type::const_pointer			const_pointer;
+			typedef std::ptrdiff_t									difference_type;
+			typedef std::size_t										size_type;
+			typedef typename ft::vector<T, Alloc>::const_iterator	iterator;
+			typedef typename ft::vector<T, Alloc>::const_iterator	const_iterator;
+			typedef ft::reverse_iterator<iterator>					reverse_iterator;
+			typedef ft::reverse_iterator<const_iterator>			const_reverse_iterator;
+
+		private:
+			const static size_type									INSERTION_SORT_MAX = 16;
+
+			mutable ft::vector<T, Alloc>	m_values;
+			mutable size_type				m_sorted;
+			key_compare						m_comp;
+
+		public:
+			explicit lazy_sorted_vector( const key_compare &comp = key_compare(), const allocator_type &alloc = allocator_type() )
+				: m_values( alloc ), m_sorted( 0 ), m_comp( comp ) { }
+
+			template<class InputIterator>
+			lazy_sorted_vector( InputIterator first, InputIterator last, const key_compare &comp = key_compare(),
+				const allocator_type &alloc = allocator_type() )
+				: m_values( alloc ), m_sorted( 0 ), m_comp( comp )
+			{
+				this->insert(first, last);
+			}
+
+			/**
+			 * Iterators
+			 */
+			const_iterator begin() const { this->sort(); return m_values.begin(); }
+			const_iterator end() const { this->sort(); return m_values.end(); }
+			const_reverse_iterator rbegin() const { return const_reverse_iterator( end() ); }
+			const_reverse_iterator rend() const { return const_reverse_iterator( begin() ); }
+
+			/**
+			 * Capacity
+			 */
+			bool empty() const { return m_values.empty(); }
+			size_type size() const { return m_values.size(); }
+			size_type max_size() const { return m_values.max_size(); }
+			size_type capacity() const { return m_values.capacity(); }
+			void reserve( size_type n ){ m_values.reserve(n); }
+
+			/**
+			 * Element access
+			 *
+			 * The value of rank n in the order.
+			 */
+			const_reference operator[]( size_type n ) const {
+				this->sort();
+				return m_values[n];
+			}
+
+			/**
+			 * Modifiers
+			 *
+			 * push_back and insert append to the unsorted tail.
+			 */
+			void push_back( const value_type &val ){
+				m_values.push_back(val);
+			}
+
+			void insert( const value_type &val ){
+				m_values.push_back(val);
+			}
+
+			template<class InputIterator>
+			void insert( InputIterator first, InputIterator last ){
+				for ( ; first != last ; ++first ){
+					m_values.push_back(*first);
+				}
+			}
+
+			const_iterator erase( const_iterator position ){
+				return this->erase(position, position + 1);
+			}
+
+			/**
+			 * Iterators come from the sorted prefix, which stays sorted without the range.
+			 * Values appended since they were taken stay in the unsorted tail.
+			 */
+			const_iterator erase( const_iterator first, const_iterator last ){
+				size_type index = first - m_values.begin();
+				size_type end = last - m_values.begin();
+
+				m_values.erase(m_values.begin() + index, m_values.begin() + end);
+				if ( index < m_sorted )
+					m_sorted -= ( end < m_sorted ? end : m_sorted ) - index;
+				return m_values.begin() + index;
+			}
+
+			size_type erase( const key_type &k ){
+				ft::pair<const_iterator, const_iterator>	range = this->equal_range(k);
+				size_type									count = range.second - range.first;
+
+				this->erase(range.first, range.second);
+				return count;
+			}
+
+			void swap( lazy_sorted_vector &x ){
+				size_type	sorted = m_sorted;
+				key_compare	comp = m_comp;
+
+				m_values.swap(x.m_values);
+				m_sorted = x.m_sorted;
+				m_comp = x.m_comp;
+				x.m_sorted = sorted;
+				x.m_comp = comp;
+			}
+
+			void clear(){
+				m_values.clear();
+				m_sorted = 0;
+			}
+
+			/**
+			 * Sorts the tail appended since the last ordered access and merges it into the
+			 * sorted prefix. Ordered accesses do it first; calling it ahead keeps the cost
+			 * out of the first lookup.
+			 */
+			void sort() const {
+				size_type				count = m_values.size() - m_sorted;
+				T						*values;
+				ft::vector<T, Alloc>	buffer( m_values.get_allocator() );
+
+				if ( count == 0 )
+					return ;
+				values = &m_values[0];
+				buffer.assign(values + m_sorted, values + m_values.size());
+				sort_(values + m_sorted, &buffer[0], count, m_comp);
+				if ( m_sorted > 0 && m_comp(values[m_sorted], values[m_sorted - 1]) ){
+					for ( size_type index = 0 ; index < count ; index++ ){
+						buffer[index] = values[m_sorted + index];
+					}
+					merge_back_(values, m_sorted, &buffer[0], count, m_comp);
+				}
+				m_sorted = m_values.size();
+			}
+
+			/**
+			 * Observers
+			 */
+			key_compare key_comp() const { return m_comp; }
+			value_compare value_comp() const { return m_comp; }
+			allocator_type get_allocator() const { return m_values.get_allocator(); }
+
+			/**
+			 * Operations
+			 */
+			const_iterator find( const key_type &k ) const {
+				const_iterator it = this->lower_bound(k);
+
+				if ( it == m_values.end() || m_comp(k, *it) )
+					return m_values.end();
+				return it;
+			}
+
+			size_type count( const key_type &k ) const {
+				ft::pair<const_iterator, const_iterator> range = this->equal_range(k);
+
+				return range.second - range.first;
+			}
+
+			const_iterator lower_bound( const key_type &k ) const {
+				size_type first = 0;
+				size_type last;
+
+				this->sort();
+				last = m_values.size();
+				while ( first < last ){
+					size_type middle = first + ( last - first ) / 2;
+
+					if ( m_comp(m_values[middle], k) )
+						first = middle + 1;
+					else
+						last = middle;
+				}
+				return m_values.begin() + first;
+			}
+
+			const_iterator upper_bound( const key_type &k ) const {
+				size_type first = 0;
+				size_type last;
+
+				this->sort();
+				last = m_values.size();
+				while ( first < last ){
+					size_type middle = first + ( last - first ) / 2;
+
+					if ( m_comp(k, m_values[middle]) )
+						last = middle;
+					else
+						first = middle + 1;
+				}
+				return m_values.begin() + first;
+			}
+
+			ft::pair<const_iterator, const_iterator> equal_range( const key_type &k ) const {
+				return ft::make_pair(this->lower_bound(k), this->upper_bound(k));
+			}
+
+		private:
+			/**
+			 * Stable merge sort of the count values of values, buffer holding as many.
+			 */
+			static void sort_( T *values, T *buffer, size_type count, const key_compare &comp ){
+				size_type	mid = count / 2;
+				T			*left = values;
+				T			*right = values + mid;
+				T			*out = buffer;
+
+				if ( count <= INSERTION_SORT_MAX ){
+					for ( size_type index = 1 ; index < count ; index++ ){
+						T			value = values[index];
+						size_type	hole = index;
+
+						for ( ; hole > 0 && comp(value, values[hole - 1]) ; hole-- ){
+							values[hole] = values[hole - 1];
+						}
+						values[hole] = value;
+					}
+					return ;
+				}
+				sort_(values, buffer, mid, comp);
+				sort_(values + mid, buffer + mid, count - mid, comp);
+				if ( !comp(values[mid], values[mid - 1]) )
+					return ;
+				while ( left != values + mid && right != values + count ){
+					if ( comp(*right, *left) )
+						*out++ = *right++;
+					else
+						*out++ = *left++;
+				}
+				while ( left != values + mid ){
+					*out++ = *left++;
+				}
+				// What is left of the right half is already in place
+				for ( size_type index = 0 ; buffer + index != out ; index++ ){
+					values[index] = buffer[index];
+				}
+			}
+
+			/**
+			 * Merges the count sorted values of tail into the sorted prefix of values,
+			 * filling the vector from its end. Among equivalent values those of the tail
+			 * stay last.
+			 */
+			static void merge_back_( T *values, size_type sorted, const T *tail, size_type count, const key_compare &comp ){
+				size_type out = sorted + count;
+
+				while ( count > 0 ){
+					if ( sorted > 0 && comp(tail[count - 1], values[sorted - 1]) )
+						values[--out] = values[--sorted];
+					else
+						values[--out] = tail[--count];
+				}
+			}
+	};
+
+	template<class T, class Compare, class Alloc>
+	void swap( lazy_sorted_vector<T, Compare, Alloc> &x, lazy_sorted_vector<T, Compare, Alloc> &y ){
+		x.swap( y );
+	}
+
+	template <class T, class Compare, class Alloc>
+	bool operator==( const lazy_sorted_vector<T,Compare,Alloc>& x, const lazy_sorted_vector<T,Compare,Alloc>& y ){
+		return x.size() == y.size() && ft::equal(x.begin(), x.end(), y.begin(), y.end());
+	}
+
+	template <class T, class Compare, class Alloc>
+	bool operator!=( const lazy_sorted_vector<T,Compare,Alloc>& x, const lazy_sorted_vector<T,Compare,Alloc>& y ){
+		return !(x == y);
+	}
+
+	template <class T, class Compare, class Alloc>
+	bool operator< ( const lazy_sorted_vector<T,Compare,Alloc>& x, const lazy_sorted_vector<T,Compare,Alloc>& y ){
+		return ft::lexicographical_compare(x.begin(), x.end(), y.begin(), y.end());
+	}
+
+	template <class T, class Compare, class Alloc>
+	bool operator<=( const lazy_sorted_vector<T,Compare,Alloc>& x, const lazy_sorted_vector<T,Compare,Alloc>& y ){
+		return !( y < x );
+	}
+
+	template <class T, class Compare, class Alloc>
+	bool operator> ( const lazy_sorted_vector<T,Compare,Alloc>& x, const lazy_sorted_vector<T,Compare,Alloc>& y ){
+		return y < x;
+	}
+
+	template <class T, class Compare, class Alloc>
+	bool operator>=( const lazy_sorted_vector<T,Compare,Alloc>& x, const lazy_sorted_vector<T,Compare,Alloc>& y ){
+		return !( x < y );
+	}
+}
+
+#endif
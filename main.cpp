@@ -5,15 +5,29 @@
 #include <iostream>
 #include <cstdio>
 #include <deque>
+#include <iterator>
+#include <string>
+#include <stdexcept>
 
 #ifdef FT
 	#include "vector.hpp"
 	#include "stack.hpp"
 	#include "map.hpp"
+	#include "interval_map.hpp"
+	#include "splay_map.hpp"
+	#include "adaptive_map.hpp"
+	#include "radix_map.hpp"
+	#include "trie_map.hpp"
+	#include "bitmap_set.hpp"
+	#include "roaring_set.hpp"
+	#include "lazy_sorted_vector.hpp"
+	#include "buffered_map.hpp"
 #else
+	#include <algorithm>
 	#include <vector>
 	#include <stack>
 	#include <map>
+	#include <set>
 	namespace ft = std;
 #endif
 
@@ -45,6 +59,34 @@ std::ostream &operator<<(std::ostream &os, const Dummy &x){
 	return os;
 }
 
+// Dummy whose copies throw once countdown, when set, runs out, counting live objects
+struct ThrowingDummy {
+	static int	countdown;
+	static int	live;
+	int			m_x;
+
+	ThrowingDummy(int x = 42) : m_x(x) { live++; }
+
+	ThrowingDummy(const ThrowingDummy &x) : m_x(x.m_x) {
+		if ( countdown > 0 && --countdown == 0 )
+			throw std::runtime_error("copy");
+		live++;
+	}
+	ThrowingDummy &operator=(const ThrowingDummy &x) {
+		m_x = x.m_x;
+		return *this;
+	}
+	~ThrowingDummy() { live--; }
+};
+
+int ThrowingDummy::countdown = 0;
+int ThrowingDummy::live = 0;
+
+std::ostream &operator<<(std::ostream &os, const ThrowingDummy &x){
+	os << x.m_x;
+	return os;
+}
+
 template<class A, class B>
 std::ostream &operator<<(std::ostream &os, const ft::pair<A, B> &p){
 	os << "(" << p.first << " : " << p.second << ")";
@@ -1649,6 +1691,44 @@ void test_map_insert_range(){
 	}
 }
 
+void test_map_insert_check(){
+	int keys[13] = { 12, 5, 15, 3, 7, 13, 17, 1, 4, 30, 25, 18, 27 };
+	ft::map<int, Dummy> map;
+
+	// Insert every key twice, the mapped value is only built when missing
+	for ( int round = 0 ; round < 2 ; round++ ){
+		for ( int index = 0 ; index < 13 ; index++ ){
+#ifdef FT
+			ft::map<int, Dummy>::insert_handle	handle = map.insert_check(keys[index]);
+			bool								found = handle.found();
+			ft::map<int, Dummy>::iterator		it = ( found ) ? handle.position()
+				: map.insert_commit(handle, ft::make_pair(keys[index], Dummy(keys[index] * 2)));
+#else
+			ft::map<int, Dummy>::iterator		it = map.lower_bound(keys[index]);
+			bool								found = it != map.end() && it->first == keys[index];
+
+			if ( !found )
+				it = map.insert(it, ft::make_pair(keys[index], Dummy(keys[index] * 2)));
+#endif
+			LOG("found", found);
+			LOG("position", *it);
+		}
+	}
+	LOG("size", map.size());
+	LOG_EACH("iterator", map.begin(), map.end());
+	// A default handle inserts as insert does
+	for ( int key = 10 ; key < 14 ; key++ ){
+#ifdef FT
+		ft::map<int, Dummy>::iterator it = map.insert_commit(ft::map<int, Dummy>::insert_handle(), ft::make_pair(key, Dummy(key)));
+#else
+		ft::map<int, Dummy>::iterator it = map.insert(ft::make_pair(key, Dummy(key))).first;
+#endif
+		LOG("position", *it);
+	}
+	LOG("size", map.size());
+	LOG_EACH("iterator", map.begin(), map.end());
+}
+
 void test_map_erase_it(){
 	int keys[13] = { 12, 5, 15, 3, 7, 13, 17, 1, 4, 30, 25, 18, 27 };
 	ft::map<int, int>::iterator		it;
@@ -1835,6 +1915,1387 @@ void test_map_erase_range(){
 		LOG("size", map.size());
 		LOG_EACH("iterator", map.begin(), map.end());
 	}
+	// Test with large ranges
+	{
+		ft::map<int, int> map;
+
+		for ( int index = 0 ; index < 1000 ; index++ ){
+			map.insert(ft::make_pair((index * 7919) % 1000, index));
+		}
+		map.erase(map.find(100), map.find(900));
+		LOG("size", map.size());
+		map.erase(map.begin(), map.find(50));
+		LOG("size", map.size());
+		map.erase(map.find(950), map.end());
+		LOG("size", map.size());
+		LOG_EACH("iterator", map.begin(), map.end());
+		LOG_EACH("reverse iterator", map.rbegin(), map.rend());
+	}
+}
+
+void test_map_extract(){
+	int keys[13] = { 12, 5, 15, 3, 7, 13, 17, 1, 4, 30, 25, 18, 27 };
+	ft::map<int, int> source;
+	ft::map<int, int> target;
+
+	for ( int index = 0 ; index < 13 ; index++ ){
+		source.insert(ft::make_pair(keys[index], index));
+		if ( index % 3 == 0 )
+			target.insert(ft::make_pair(keys[index], -index));
+	}
+	// Move single nodes, the ones already in target are rejected
+	for ( int index = 0 ; index < 6 ; index++ ){
+#ifdef FT
+		ft::map<int, int>::insert_return_type ret = target.insert(source.extract(keys[index]));
+		bool inserted = ret.inserted;
+		int  value = ( ret.inserted ) ? ret.position->second : ret.node.mapped();
+#else
+		int  value = source.find(keys[index])->second;
+		bool inserted = target.insert(*source.find(keys[index])).second;
+
+		source.erase(keys[index]);
+#endif
+		LOG("inserted", inserted);
+		LOG("value", value);
+	}
+	LOG("source size", source.size());
+	LOG("target size", target.size());
+	LOG_EACH("source", source.begin(), source.end());
+	LOG_EACH("target", target.begin(), target.end());
+
+	// Move everything left, keys already in target stay in source
+	target.insert(ft::make_pair(30, 100));
+#ifdef FT
+	target.merge(source);
+#else
+	for ( ft::map<int, int>::iterator it = source.begin() ; it != source.end() ; ){
+		if ( target.insert(*it).second )
+			source.erase(it++);
+		else
+			++it;
+	}
+#endif
+	LOG("source size", source.size());
+	LOG("target size", target.size());
+	LOG_EACH("source", source.begin(), source.end());
+	LOG_EACH("target", target.begin(), target.end());
+}
+
+// Select keys by their remainder, for erase_if
+struct KeyModulo {
+	int m_mod;
+	int m_limit;
+
+	KeyModulo(int mod, int limit) : m_mod(mod), m_limit(limit) {}
+
+	template<class Pair>
+	bool operator()(const Pair &x) const { return x.first % m_mod < m_limit; }
+};
+
+void test_map_erase_if(){
+	// Small fraction (unlink) then large fraction (rebuild)
+	for ( int limit = 1 ; limit < 10 ; limit += 7 ){
+		ft::map<int, int>	map;
+		KeyModulo			pred(10, limit);
+		size_t				count = 0;
+
+		for ( int index = 0 ; index < 200 ; index++ ){
+			map.insert(ft::make_pair((index * 37) % 200, index));
+		}
+#ifdef FT
+		count = ft::erase_if(map, pred);
+#else
+		for ( ft::map<int, int>::iterator it = map.begin() ; it != map.end() ; ){
+			if ( pred(*it) ){
+				map.erase(it++);
+				count++;
+			} else {
+				++it;
+			}
+		}
+#endif
+		LOG("count", count);
+		LOG("size", map.size());
+		LOG_EACH("iterator", map.begin(), map.end());
+		LOG_EACH("reverse iterator", map.rbegin(), map.rend());
+		map.insert(ft::make_pair(1000, 0));
+		map.erase(map.begin());
+		LOG_EACH("iterator", map.begin(), map.end());
+	}
+}
+
+void test_map_split_join(){
+	for ( int key = -10 ; key <= 210 ; key += 55 ){
+		ft::map<int, int>	map;
+		ft::map<int, int>	left;
+		ft::map<int, int>	right;
+
+		for ( int index = 0 ; index < 200 ; index++ ){
+			map.insert(ft::make_pair((index * 37) % 200, index));
+		}
+		left.insert(ft::make_pair(-1, 0));
+#ifdef FT
+		map.split(key, left, right);
+#else
+		left = ft::map<int, int>(map.begin(), map.lower_bound(key));
+		right = ft::map<int, int>(map.lower_bound(key), map.end());
+		map.clear();
+#endif
+		LOG("size", map.size());
+		LOG("size", left.size());
+		LOG_EACH("iterator", left.begin(), left.end());
+		LOG_EACH("reverse iterator", right.rbegin(), right.rend());
+
+#ifdef FT
+		map.join(left, right);
+#else
+		map.insert(left.begin(), left.end());
+		map.insert(right.begin(), right.end());
+		left.clear();
+		right.clear();
+#endif
+		LOG("size", map.size());
+		LOG("size", left.size());
+		LOG("size", right.size());
+		LOG_EACH("iterator", map.begin(), map.end());
+		LOG_EACH("reverse iterator", map.rbegin(), map.rend());
+		map.erase(map.begin());
+		map.insert(ft::make_pair(1000, 0));
+		LOG_EACH("iterator", map.begin(), map.end());
+	}
+}
+
+void test_map_set_operations(){
+	for ( int op = 0 ; op < 3 ; op++ ){
+		ft::map<int, int>	map;
+		ft::map<int, int>	other;
+
+		for ( int index = 0 ; index < 300 ; index++ ){
+			map.insert(ft::make_pair((index * 37) % 300, index));
+			other.insert(ft::make_pair((index * 41) % 600 + 150, -index));
+		}
+#ifdef FT
+		if ( op == 0 )
+			ft::map_union(map, other, 4);
+		else if ( op == 1 )
+			ft::map_intersection(map, other, 4);
+		else
+			ft::map_difference(map, other, 4);
+#else
+		ft::map<int, int> result;
+
+		for ( ft::map<int, int>::iterator it = map.begin() ; it != map.end() ; ++it ){
+			if ( ( op == 1 ) == ( other.count(it->first) == 1 ) || op == 0 )
+				result.insert(*it);
+		}
+		if ( op == 0 )
+			result.insert(other.begin(), other.end());
+		map.swap(result);
+		other.clear();
+#endif
+		LOG("size", map.size());
+		LOG("size", other.size());
+		LOG_EACH("iterator", map.begin(), map.end());
+		LOG_EACH("reverse iterator", map.rbegin(), map.rend());
+		map.erase(map.begin());
+		map.insert(ft::make_pair(1000, 0));
+		other.insert(ft::make_pair(0, 0));
+		LOG_EACH("iterator", map.begin(), map.end());
+		LOG_EACH("iterator", other.begin(), other.end());
+	}
+}
+
+void test_map_bulk_load(){
+	ft::vector<ft::pair<int, int> >	rows;
+	ft::map<int, int>				map;
+
+	for ( int index = 0 ; index < 500 ; index++ ){
+		rows.push_back(ft::make_pair((index * 37) % 400, index));
+	}
+	map.insert(ft::make_pair(-1, 0));
+#ifdef FT
+	map.bulk_load(rows.begin(), rows.end(), 4);
+#else
+	map = ft::map<int, int>(rows.begin(), rows.end());
+#endif
+	LOG("size", map.size());
+	LOG_EACH("iterator", map.begin(), map.end());
+	LOG_EACH("reverse iterator", map.rbegin(), map.rend());
+	map.erase(map.begin());
+	map.insert(ft::make_pair(1000, 0));
+	LOG_EACH("iterator", map.begin(), map.end());
+}
+
+void test_map_insert_sorted_batch(){
+	ft::vector<ft::pair<int, int> >	batch;
+	ft::map<int, int>				map;
+
+	for ( int index = 0 ; index < 200 ; index++ ){
+		map.insert(ft::make_pair(index * 3, index));
+		batch.push_back(ft::make_pair(index * 4 - 50, -index));
+	}
+	// Unsorted tail
+	batch.push_back(ft::make_pair(7, 0));
+	batch.push_back(ft::make_pair(-100, 0));
+#ifdef FT
+	map.insert_sorted_batch(batch.begin(), batch.end());
+#else
+	map.insert(batch.begin(), batch.end());
+#endif
+	LOG("size", map.size());
+	LOG_EACH("iterator", map.begin(), map.end());
+	LOG_EACH("reverse iterator", map.rbegin(), map.rend());
+	map.erase(map.begin());
+	map.insert(ft::make_pair(1000, 0));
+	LOG_EACH("iterator", map.begin(), map.end());
+}
+
+void test_map_find_batch(){
+	ft::map<int, int>					map;
+	ft::vector<int>						keys;
+	ft::vector<ft::map<int, int>::iterator>	found;
+	ft::vector<ft::map<int, int>::iterator>	lower;
+
+	for ( int index = 0 ; index < 100 ; index++ ){
+		map.insert(ft::make_pair(index * 3, index));
+	}
+	for ( int index = 0 ; index < 40 ; index++ ){
+		keys.push_back((index * 53) % 320 - 10);
+	}
+#ifdef FT
+	map.find_batch(keys.begin(), keys.end(), std::back_inserter(found));
+	map.lower_bound_batch(keys.begin(), keys.end(), std::back_inserter(lower));
+#else
+	for ( ft::vector<int>::iterator it = keys.begin() ; it != keys.end() ; ++it ){
+		found.push_back(map.find(*it));
+		lower.push_back(map.lower_bound(*it));
+	}
+#endif
+	LOG("size", found.size());
+	LOG("size", lower.size());
+	for ( size_t index = 0 ; index < keys.size() ; index++ ){
+		LOG("key", keys[index]);
+		LOG("found", ( found[index] != map.end() ));
+		if ( lower[index] != map.end() )
+			LOG("lower", *lower[index]);
+	}
+}
+
+void test_map_cursor(){
+	ft::map<int, int>	map;
+
+	for ( int index = 0 ; index < 200 ; index++ ){
+		map.insert(ft::make_pair((index * 37) % 200 * 3, index));
+	}
+#ifdef FT
+	ft::map<int, int>::cursor	cursor(map);
+#else
+	ft::map<int, int>::iterator	cursor = map.begin();
+#endif
+	LOG("begin", *cursor);
+	for ( int key = 0 ; key < 620 ; key += 1 + key % 7 ){
+#ifdef FT
+		ft::map<int, int>::iterator it = cursor.seek(key - 5);
+#else
+		ft::map<int, int>::iterator it = cursor = map.lower_bound(key - 5);
+#endif
+		if ( it == map.end() )
+			break ;
+		LOG("seek", *it);
+		++cursor;
+		++it;
+		if ( it != map.end() )
+			LOG("next", *cursor);
+	}
+#ifdef FT
+	cursor.seek(40);
+#else
+	cursor = map.lower_bound(40);
+#endif
+	LOG("back", *cursor);
+}
+
+void test_map_reserve(){
+	ft::map<int, int>	other;
+
+	{
+		ft::map<int, int>	map;
+
+#ifdef FT
+		map.reserve(150);
+#endif
+		for ( int index = 0 ; index < 200 ; index++ ){
+			map.insert(ft::make_pair((index * 37) % 200, index));
+		}
+		for ( int index = 0 ; index < 200 ; index += 3 ){
+			map.erase(index);
+		}
+#ifdef FT
+		map.reserve(300);
+#endif
+		for ( int index = 200 ; index < 300 ; index++ ){
+			map[index] = index;
+		}
+		LOG("size", map.size());
+		LOG_EACH("iterator", map.begin(), map.end());
+		// Nodes outliving the map they were reserved by
+		other.insert(map.begin(), map.find(50));
+		other.swap(map);
+	}
+	LOG("size", other.size());
+	LOG_EACH("reverse iterator", other.rbegin(), other.rend());
+}
+
+void test_map_compact(){
+	ft::map<int, int>	map;
+
+	for ( int index = 0 ; index < 300 ; index++ ){
+		map.insert(ft::make_pair((index * 37) % 300, index));
+	}
+	for ( int index = 0 ; index < 300 ; index += 4 ){
+		map.erase(index);
+	}
+#ifdef FT
+	map.compact();
+#endif
+	LOG("size", map.size());
+	LOG_EACH("iterator", map.begin(), map.end());
+	LOG_EACH("reverse iterator", map.rbegin(), map.rend());
+	map.erase(map.begin());
+	map.insert(ft::make_pair(1000, 0));
+	map.insert(ft::make_pair(-1, 0));
+	LOG_EACH("iterator", map.begin(), map.end());
+
+	ft::map<int, ThrowingDummy>	other;
+	int							live;
+
+	for ( int index = 0 ; index < 100 ; index++ ){
+		other.insert(ft::make_pair(( index * 37 ) % 100, ThrowingDummy( index )));
+	}
+	live = ThrowingDummy::live;
+	// A copy throwing halfway leaves the map as it was
+	ThrowingDummy::countdown = 50;
+	try {
+#ifdef FT
+		other.compact();
+#else
+		ft::map<int, ThrowingDummy> copy(other);
+#endif
+	} catch ( std::runtime_error & ){
+		LOG("compact", "thrown");
+	}
+	ThrowingDummy::countdown = 0;
+	LOG("live", ThrowingDummy::live - live);
+	LOG("size", other.size());
+	LOG_EACH("iterator", other.begin(), other.end());
+	LOG_EACH("reverse iterator", other.rbegin(), other.rend());
+#ifdef FT
+	other.compact();
+#endif
+	other.erase(50);
+	LOG("live", ThrowingDummy::live - live);
+	LOG_EACH("iterator", other.begin(), other.end());
+}
+
+struct KeyList {
+	std::string operator()(const std::string &list, const ft::pair<const int, int> &x) const {
+		char buffer[16];
+
+		sprintf(buffer, "%d ", x.first);
+		return list + buffer;
+	}
+
+	std::string operator()(const std::string &a, const std::string &b) const { return a + b; }
+};
+
+struct AddOne {
+	void operator()(ft::pair<const int, int> &x) const { x.second++; }
+};
+
+void test_map_parallel(){
+	ft::map<int, int>	map;
+	std::string			keys;
+
+	for ( int index = 0 ; index < 500 ; index++ ){
+		map.insert(ft::make_pair((index * 37) % 500, index));
+	}
+#ifdef FT
+	ft::parallel_for_each(map, AddOne(), 4);
+	keys = ft::parallel_reduce(map, std::string(), KeyList(), 4);
+#else
+	for ( ft::map<int, int>::iterator it = map.begin() ; it != map.end() ; ++it ){
+		AddOne()(*it);
+		keys = KeyList()(keys, *it);
+	}
+#endif
+	LOG("keys", keys);
+	LOG_EACH("iterator", map.begin(), map.end());
+}
+
+struct SumValues {
+	typedef long summary_type;
+
+	long identity() const { return 0; }
+	long lift(const ft::pair<const int, int> &x) const { return x.second; }
+	long combine(long a, long b) const { return a + b; }
+};
+
+#ifdef FT
+typedef ft::map<int, int, std::less<int>, std::allocator<ft::pair<const int, int> >, SumValues> sum_map;
+#else
+typedef std::map<int, int> sum_map;
+#endif
+
+long sum_values(const sum_map &map, int lo, int hi){
+#ifdef FT
+	return map.aggregate(lo, hi);
+#else
+	long sum = 0;
+
+	for ( sum_map::const_iterator it = map.lower_bound(lo) ; it != map.end() && it->first < hi ; ++it ){
+		sum += it->second;
+	}
+	return sum;
+#endif
+}
+
+void test_map_aggregate(){
+	sum_map	map;
+
+	LOG("empty", sum_values(map, 0, 100));
+	for ( int index = 0 ; index < 400 ; index++ ){
+		map.insert(ft::make_pair((index * 37) % 400, index));
+	}
+	LOG("all", sum_values(map, -1, 400));
+	LOG("range", sum_values(map, 10, 20));
+	LOG("range", sum_values(map, 123, 321));
+	LOG("single", sum_values(map, 57, 58));
+	LOG("reversed", sum_values(map, 300, 100));
+	for ( int index = 0 ; index < 400 ; index += 3 ){
+		map.erase(index);
+	}
+	map.erase(map.lower_bound(200), map.lower_bound(260));
+	LOG("erased", sum_values(map, 0, 400));
+	LOG("erased", sum_values(map, 150, 300));
+	map[100] = 1000;
+	map[101] = 1000;
+#ifdef FT
+	map.refresh(map.find(100));
+	map.refresh(map.find(101));
+#endif
+	LOG("assigned", sum_values(map, 90, 110));
+	LOG("assigned", sum_values(map, 0, 400));
+}
+
+#ifdef FT
+typedef ft::interval_map<int, int> intervals;
+#else
+typedef std::map<std::pair<int, int>, int> intervals;
+#endif
+
+std::string list_overlapping(const intervals &map, int a, int b){
+	std::string								list;
+	char									buffer[32];
+	ft::vector<intervals::const_iterator>	found;
+
+#ifdef FT
+	map.overlapping(a, b, std::back_inserter(found));
+#else
+	for ( intervals::const_iterator it = map.begin() ; it != map.end() ; ++it ){
+		if ( it->first.first <= b && a <= it->first.second )
+			found.push_back(it);
+	}
+#endif
+	for ( size_t index = 0 ; index < found.size() ; index++ ){
+		sprintf(buffer, "[%d %d] ", found[index]->first.first, found[index]->first.second);
+		list += buffer;
+	}
+	return list;
+}
+
+bool any_overlapping(const intervals &map, int a, int b){
+#ifdef FT
+	return map.overlaps(a, b);
+#else
+	return !list_overlapping(map, a, b).empty();
+#endif
+}
+
+void test_interval_map(){
+	intervals	map;
+
+	LOG("empty", list_overlapping(map, 0, 100));
+	LOG("overlaps", any_overlapping(map, 0, 100));
+	// Intervals sharing endpoints, a point, and two starting together
+	map.insert(ft::make_pair(ft::make_pair(10, 20), 0));
+	map.insert(ft::make_pair(ft::make_pair(20, 30), 1));
+	map.insert(ft::make_pair(ft::make_pair(30, 30), 2));
+	map.insert(ft::make_pair(ft::make_pair(10, 15), 3));
+	map.insert(ft::make_pair(ft::make_pair(5, 9), 4));
+	map.insert(ft::make_pair(ft::make_pair(31, 40), 5));
+	LOG("insert", map.insert(ft::make_pair(ft::make_pair(10, 20), 6)).second);
+	LOG("overlap", list_overlapping(map, 20, 20));
+	LOG("overlap", list_overlapping(map, 21, 29));
+	LOG("overlap", list_overlapping(map, 30, 30));
+	LOG("overlap", list_overlapping(map, 15, 15));
+	LOG("overlap", list_overlapping(map, 16, 19));
+	LOG("overlap", list_overlapping(map, 9, 10));
+	LOG("overlap", list_overlapping(map, 40, 40));
+	LOG("overlap", list_overlapping(map, 41, 50));
+	LOG("overlap", list_overlapping(map, 0, 4));
+	LOG("overlaps", any_overlapping(map, 41, 50));
+	LOG("overlaps", any_overlapping(map, 4, 5));
+	// Disjoint intervals deep in the tree, the leftmost one reaching past all of them
+	for ( int index = 0 ; index < 100 ; index++ ){
+		int lo = 200 + ( ( index * 37 ) % 100 ) * 10;
+
+		map.insert(ft::make_pair(ft::make_pair(lo, lo + 5), index));
+	}
+	map.insert(ft::make_pair(ft::make_pair(-1000, 5000), 7));
+	LOG("size", map.size());
+	LOG("overlap", list_overlapping(map, 206, 209));
+	LOG("overlap", list_overlapping(map, 205, 210));
+	LOG("overlap", list_overlapping(map, 1195, 1200));
+	LOG("overlap", list_overlapping(map, 5000, 6000));
+	LOG("overlap", list_overlapping(map, -2000, -1001));
+	LOG("overlaps", any_overlapping(map, 4000, 4000));
+	// Without it, the max endpoints of its ancestors drop back
+	map.erase(ft::make_pair(-1000, 5000));
+	LOG("overlap", list_overlapping(map, 206, 209));
+	LOG("overlap", list_overlapping(map, 1196, 1200));
+	LOG("overlaps", any_overlapping(map, 1196, 5000));
+	LOG("overlaps", any_overlapping(map, 1195, 5000));
+	map.erase(ft::make_pair(20, 30));
+	map.erase(ft::make_pair(10, 20));
+	LOG("overlap", list_overlapping(map, 16, 30));
+	for ( int index = 0 ; index < 100 ; index += 2 ){
+		map.erase(ft::make_pair(200 + index * 10, 205 + index * 10));
+	}
+	LOG("size", map.size());
+	LOG("overlap", list_overlapping(map, 200, 260));
+	LOG("overlap", list_overlapping(map, 1180, 1200));
+}
+
+#ifdef FT
+typedef ft::map<int, int, std::less<int>, std::allocator<ft::pair<const int, int> >, ft::rb_no_augment, ft::avl_balance> avl_map;
+#else
+typedef std::map<int, int> avl_map;
+#endif
+
+void test_map_avl(){
+	avl_map	map;
+	avl_map	zigzag;
+	int		keys[6] = { 30, 10, 20, 40, 60, 50 };
+
+	// Ascending then descending runs rotate at every level, left then right
+	for ( int index = 0 ; index < 64 ; index++ ){
+		map[index] = index;
+	}
+	for ( int index = 1 ; index <= 64 ; index++ ){
+		map.insert(map.begin(), ft::make_pair(-index, index));
+	}
+	LOG("size", map.size());
+	LOG("begin", map.begin()->first);
+	LOG("rbegin", map.rbegin()->first);
+	LOG("find", map.find(-64)->second);
+	LOG("lower_bound", ( map.lower_bound(64) == map.end() ));
+	// A right then left child, and a left then right child: double rotations
+	for ( int index = 0 ; index < 6 ; index++ ){
+		zigzag[keys[index]] = index;
+	}
+	LOG_EACH("iterator", zigzag.begin(), zigzag.end());
+	LOG_EACH("reverse iterator", zigzag.rbegin(), zigzag.rend());
+	// Emptying one side leaves the other two levels taller, rebalanced on the way up
+	map.erase(map.begin(), map.find(40));
+	LOG("size", map.size());
+	LOG("begin", map.begin()->first);
+	LOG("lower_bound", map.lower_bound(-1)->first);
+	for ( int index = 63 ; index > 44 ; index-- ){
+		map.erase(index);
+	}
+	LOG_EACH("iterator", map.begin(), map.end());
+	// From both ends down to a single node, then nothing
+	while ( map.size() > 1 ){
+		map.erase(map.begin());
+		if ( map.size() > 1 )
+			map.erase(--map.end());
+	}
+	LOG_EACH("iterator", map.begin(), map.end());
+	map.erase(map.begin());
+	LOG("empty", map.empty());
+	map[7] = 7;
+	map.insert(map.end(), ft::make_pair(8, 8));
+	map.insert(map.begin(), ft::make_pair(6, 6));
+	LOG_EACH("iterator", map.begin(), map.end());
+}
+
+#ifdef FT
+typedef ft::map<std::string, int, ft::prefix_less<std::string> > prefix_map;
+#else
+typedef std::map<std::string, int> prefix_map;
+#endif
+
+void test_map_prefix(){
+	prefix_map	map;
+	std::string	keys[12] = { "", "a", "ab", "abcdefg", "abcdefgh", "abcdefghi", "abcdefgha",
+		"abcdefgg", "abcdefhh", std::string("ab\0", 3), std::string("abcdefg\0", 8), "\xff" };
+
+	for ( int index = 0 ; index < 12 ; index++ ){
+		map[keys[index]] = index;
+	}
+	LOG("size", map.size());
+	LOG("insert", map.insert(ft::make_pair(std::string("abcdefgh"), 0)).second);
+	// Zero bytes pad the prefix, so a key and the same with trailing zeros tie on it
+	LOG("find", map.find("ab")->second);
+	LOG("find", map.find(std::string("ab\0", 3))->second);
+	LOG("find", ( map.find(std::string("ab\0\0", 4)) == map.end() ));
+	LOG("find", map.find(std::string("abcdefg\0", 8))->second);
+	LOG("upper_bound", map.upper_bound("abcdefg")->first.size());
+	// Keys telling apart on the 7th byte, the 8th, or only past the prefix
+	LOG("lower_bound", map.lower_bound("abcdefgz")->first);
+	LOG("lower_bound", map.lower_bound("abcdefh")->first);
+	LOG("upper_bound", map.upper_bound("abcdefgh")->first);
+	LOG("lower_bound", map.lower_bound("abcdefgh\x01")->first);
+	LOG("upper_bound", map.upper_bound("abcdefghz")->first);
+	// Bytes past 0x7f go after every other one
+	LOG("lower_bound", ( map.lower_bound("\x80")->first == "\xff" ));
+	LOG("upper_bound", ( map.upper_bound("\xff") == map.end() ));
+	// Hinted inserts search from the hint with the prefixes too
+	map.insert(map.find("abcdefgh"), ft::make_pair(std::string("abcdefgh!"), 20));
+	map.insert(map.begin(), ft::make_pair(std::string("abcdefga"), 21));
+	map.insert(map.end(), ft::make_pair(std::string("abcdefgi"), 22));
+	LOG_EACH("iterator", map.begin(), map.end());
+	map.erase(map.lower_bound("abcdefg"), map.lower_bound("abcdefgh"));
+	map.erase("a");
+	LOG("size", map.size());
+	LOG_EACH("reverse iterator", map.rbegin(), map.rend());
+	map.clear();
+	LOG("empty", map.empty());
+}
+
+#ifdef FT
+typedef ft::splay_map<int, int> splay_map;
+#else
+typedef std::map<int, int> splay_map;
+#endif
+
+void test_splay_map(){
+	splay_map			map;
+	splay_map::iterator	it;
+
+	LOG("empty", map.empty());
+	LOG("find", ( map.find(0) == map.end() ));
+	// Ascending inserts each splay the new maximum, leaving a path of left children
+	for ( int index = 0 ; index < 300 ; index++ ){
+		map.insert(ft::make_pair(index, index));
+	}
+	LOG("begin", map.begin()->first);
+	LOG("rbegin", map.rbegin()->first);
+	// The deepest node goes up the whole path, the sentinels moving with their subtrees
+	LOG("find", map.find(0)->second);
+	LOG("begin", map.begin()->first);
+	LOG("rbegin", map.rbegin()->first);
+	// Iterators survive the splaying of other lookups, found or not
+	it = map.find(10);
+	map.find(200);
+	map.find(1000);
+	map.lower_bound(-5);
+	map.upper_bound(150);
+	LOG("iterator", (++it)->first);
+	LOG("iterator", (--it)->first);
+	// A working set accessed again and again stays near the root
+	for ( int round = 0 ; round < 5 ; round++ ){
+		for ( int index = 100 ; index < 105 ; index++ ){
+			map[index] += 1;
+		}
+	}
+	LOG("find", map.find(102)->second);
+	LOG("count", static_cast<const splay_map &>( map ).count(104));
+	LOG("find", static_cast<const splay_map &>( map ).find(299)->second);
+	// The root erased, its predecessor takes its place; without one, its right child
+	map.find(150);
+	map.erase(150);
+	map.find(0);
+	map.erase(0);
+	map.erase(map.find(299));
+	LOG("size", map.size());
+	LOG("begin", map.begin()->first);
+	LOG("rbegin", map.rbegin()->first);
+	LOG("lower_bound", map.lower_bound(150)->first);
+	LOG("upper_bound", map.upper_bound(149)->first);
+	map.erase(map.lower_bound(20), map.upper_bound(280));
+	LOG_EACH("iterator", map.begin(), map.end());
+	LOG_EACH("reverse iterator", map.rbegin(), map.rend());
+
+	// Copies are built in key order
+	splay_map	copy(map);
+
+	LOG("equal", ( copy == map ));
+	LOG("find", copy.find(1)->second);
+	LOG_EACH("reverse iterator", copy.rbegin(), copy.rend());
+}
+
+#ifdef FT
+typedef ft::adaptive_map<int, int> adaptive_map;
+#else
+typedef std::map<int, int> adaptive_map;
+#endif
+
+void test_adaptive_map(){
+	adaptive_map	map;
+	adaptive_map	other;
+
+	LOG("empty", map.empty());
+	LOG("find", ( map.find(0) == map.end() ));
+	// Up to 16 elements inline, each inserted in front shifting the others
+	for ( int index = 16 ; index > 0 ; index-- ){
+		map.insert(ft::make_pair(index * 2, index));
+	}
+	LOG("size", map.size());
+	LOG("insert", map.insert(ft::make_pair(2, 0)).second);
+	LOG("insert", map.insert(ft::make_pair(32, 0)).second);
+	LOG("lower_bound", map.lower_bound(-5)->first);
+	LOG("lower_bound", map.lower_bound(31)->first);
+	LOG("upper_bound", ( map.upper_bound(32) == map.end() ));
+	// The 17th moves them all to a tree
+	LOG("insert", map.insert(ft::make_pair(17, 0)).second);
+	LOG("size", map.size());
+	LOG("find", map.find(17)->second);
+	LOG_EACH("iterator", map.begin(), map.end());
+	// Back inline at 8, not 9
+	for ( int index = 2 ; index <= 16 ; index += 2 ){
+		map.erase(index);
+	}
+	LOG("size", map.size());
+	LOG_EACH("reverse iterator", map.rbegin(), map.rend());
+	map.erase(map.find(17));
+	LOG("size", map.size());
+	LOG("find", map.find(18)->second);
+	LOG_EACH("iterator", map.begin(), map.end());
+	// Filled again up to 16 inline, then past it through operator[]
+	for ( int index = 0 ; index < 8 ; index++ ){
+		map.insert(ft::make_pair(index * 4 + 1, -index));
+	}
+	LOG("size", map.size());
+	map[100] = 100;
+	map[101] = 101;
+	LOG("size", map.size());
+	LOG_EACH("iterator", map.begin(), map.end());
+	// A range erase through the tree ending inline
+	map.erase(map.lower_bound(5), map.lower_bound(100));
+	LOG("size", map.size());
+	LOG_EACH("iterator", map.begin(), map.end());
+	// Swaps between an inline map and a tree
+	for ( int index = 0 ; index < 40 ; index++ ){
+		other[index * 3] = index;
+	}
+	map.swap(other);
+	LOG("size", map.size());
+	LOG("size", other.size());
+	LOG("find", other.find(101)->second);
+	LOG("find", map.find(117)->second);
+	other = map;
+	LOG("equal", ( other == map ));
+	map.clear();
+	LOG("empty", map.empty());
+	map.swap(other);
+	LOG("size", map.size());
+	LOG("empty", other.empty());
+}
+
+#ifdef FT
+typedef ft::radix_map<unsigned long, int> radix_map;
+#else
+typedef std::map<unsigned long, int> radix_map;
+#endif
+
+std::string list_offsets(radix_map &map, unsigned long base){
+	std::string			list;
+	char				buffer[32];
+	radix_map::iterator	it = map.lower_bound(base);
+
+	for ( ; it != map.end() && it->first - base < 0x10000 ; ++it ){
+		sprintf(buffer, "%lu ", it->first - base);
+		list += buffer;
+	}
+	return list;
+}
+
+void test_radix_map(){
+	radix_map			map;
+	const unsigned long	base = 0x0123456789ab0000ul;
+	unsigned long		byte;
+
+	LOG("empty", map.empty());
+	LOG("find", ( map.find(0) == map.end() ));
+	LOG("lower_bound", ( map.lower_bound(0) == map.end() ));
+	// Keys telling apart on their last byte only, so that a single node grows
+	// past 4, 16, 48 then to 256 children, inserted out of order
+	for ( unsigned long count = 1 ; count <= 256 ; count++ ){
+		byte = ( count * 167 ) % 256;
+		map.insert(ft::make_pair(base + byte, (int)count));
+		if ( count == 4 || count == 5 || count == 16 || count == 17 || count == 48 || count == 49 ){
+			LOG("size", map.size());
+			LOG("find", map.find(base + byte)->second);
+			LOG("find", map.find(base + 167)->second);
+			LOG("lower_bound", map.lower_bound(base + 100)->first - base);
+			LOG("upper_bound", ( map.upper_bound(base + 255) == map.end() ));
+		}
+	}
+	LOG("insert", map.insert(ft::make_pair(base + 128, 0)).second);
+	LOG("size", map.size());
+	LOG("begin", map.begin()->first - base);
+	LOG("rbegin", map.rbegin()->first - base);
+	LOG("find", ( map.find(base + 256) == map.end() ));
+	// Then erased back down through 37, 12, 3 children and a single one
+	for ( unsigned long count = 256 ; count > 1 ; count-- ){
+		map.erase(base + ( count * 167 ) % 256);
+		if ( count == 38 || count == 37 || count == 13 || count == 12 || count == 4 || count == 3 ){
+			LOG("size", map.size());
+			LOG("prefix", list_offsets(map, base));
+			LOG("lower_bound", map.lower_bound(base + 100)->first - base);
+			LOG("upper_bound", ( map.upper_bound(base + 167) == map.end() ));
+		}
+	}
+	LOG("size", map.size());
+	LOG("find", map.find(base + 167)->second);
+	// A key leaving the prefix on each byte splits it there, then joins it back
+	for ( unsigned long shift = 8 ; shift < 64 ; shift += 8 ){
+		map[base ^ ( 1ul << shift )] = (int)shift;
+		LOG("find", map.find(base + 167)->second);
+		LOG_EACH("iterator", map.begin(), map.end());
+		map.erase(base ^ ( 1ul << shift ));
+	}
+	map[base + 0x100] = 1;
+	map[base + 0x1ff] = 2;
+	map[0] = 3;
+	map[~0ul] = 4;
+	LOG("prefix", list_offsets(map, base));
+	LOG_EACH("iterator", map.begin(), map.end());
+	LOG_EACH("reverse iterator", map.rbegin(), map.rend());
+	map.erase(map.lower_bound(base), map.lower_bound(base + 0x1ff));
+	LOG("size", map.size());
+	LOG_EACH("iterator", map.begin(), map.end());
+	map.clear();
+	LOG("empty", map.empty());
+}
+
+#ifdef FT
+typedef ft::trie_map<int> trie_map;
+#else
+typedef std::map<std::string, int> trie_map;
+#endif
+
+std::string list_prefixed(trie_map &map, const std::string &prefix){
+	std::string									list;
+	ft::pair<trie_map::iterator, trie_map::iterator>	range;
+
+#ifdef FT
+	range = map.prefix_range(prefix);
+#else
+	range.first = map.lower_bound(prefix);
+	range.second = range.first;
+	while ( range.second != map.end() && range.second->first.compare(0, prefix.size(), prefix) == 0 )
+		++range.second;
+#endif
+	for ( ; range.first != range.second ; ++range.first ){
+		list += range.first->first + " ";
+	}
+	return list;
+}
+
+void test_trie_map(){
+	trie_map	map;
+	char		buffer[32];
+
+	LOG("empty", map.empty());
+	LOG("find", ( map.find("") == map.end() ));
+	LOG("prefix", list_prefixed(map, "tenant"));
+	// Over BURST_SIZE keys under each tenant, so that the root bursts on the tenant,
+	// then every tenant past the "/key" all its keys share
+	for ( int index = 0 ; index < 6000 ; index++ ){
+		sprintf(buffer, "tenant%d/key%d", index % 5, ( index * 37 ) % 6000);
+		map.insert(ft::make_pair(std::string(buffer), index));
+	}
+	map[""] = -1;
+	map["tenant"] = -2;
+	map["tenant1"] = -3;
+	map[std::string("tenant1\0", 8)] = -4;
+	map["tenant1\xff"] = -5;
+	// Keys leaving what the keys of tenant2 share, inside it and at its end
+	map["tenant2/kez"] = -6;
+	map["tenant2/k"] = -7;
+	LOG("insert", map.insert(ft::make_pair(std::string("tenant"), 0)).second);
+	LOG("size", map.size());
+	LOG("find", map.find("tenant3/key1")->second);
+	LOG("find", ( map.find("tenant3/key") == map.end() ));
+	LOG("find", map.find("")->second);
+	LOG("count", map.count("tenant1"));
+	LOG("lower_bound", map.lower_bound("tenant2/key4")->first);
+	LOG("upper_bound", map.upper_bound("tenant3/key99")->first);
+	LOG("upper_bound", ( map.upper_bound("tenant4/key999") == map.end() ));
+	LOG("lower_bound", map.lower_bound("tenant3/a")->first);
+	LOG("lower_bound", map.lower_bound("tenant3/z")->first);
+	LOG("lower_bound", map.lower_bound("tenant2/key:")->first);
+	LOG("lower_bound", map.lower_bound("tenant3/key:")->first);
+	LOG("find", map.find("tenant2/k")->second);
+	LOG("find", ( map.find("tenant2/ke") == map.end() ));
+	LOG("prefix", list_prefixed(map, "tenant1/key12"));
+	LOG("prefix", list_prefixed(map, "tenant4/key39"));
+	LOG("prefix", list_prefixed(map, "tenant9"));
+	for ( int index = 0 ; index < 6000 ; index += 3 ){
+		sprintf(buffer, "tenant%d/key%d", index % 5, ( index * 37 ) % 6000);
+		map.erase(buffer);
+	}
+	map.erase(map.lower_bound("tenant0"), map.lower_bound("tenant3"));
+	map.erase(map.begin());
+	LOG("size", map.size());
+	LOG("prefix", list_prefixed(map, "tenant1"));
+	LOG("prefix", list_prefixed(map, "tenant4/key13"));
+	map.erase(map.lower_bound("tenant3"), map.lower_bound("tenant4/key5"));
+	LOG("size", map.size());
+	LOG_EACH("reverse iterator", map.rbegin(), map.rend());
+
+	// A single bucket of keys all sharing "shared/", up to BURST_SIZE then one past it
+	trie_map	burst;
+
+	for ( int index = 0 ; index <= 1024 ; index++ ){
+		sprintf(buffer, "shared/%04d", ( index * 7 ) % 1025);
+		burst[buffer] = index;
+		if ( index == 1023 || index == 1024 ){
+			LOG("size", burst.size());
+			LOG("find", burst.find("shared/0007")->second);
+			LOG("lower_bound", burst.lower_bound("shared/")->first);
+			LOG("lower_bound", burst.lower_bound("shared/05")->first);
+			LOG("upper_bound", ( burst.upper_bound("shared/1024") == burst.end() ));
+			LOG("prefix", list_prefixed(burst, "shared/102"));
+		}
+	}
+	// Queries ending inside, or leaving, the skipped "shared/"
+	LOG("find", ( burst.find("shared") == burst.end() ));
+	LOG("lower_bound", burst.lower_bound("shar")->first);
+	LOG("lower_bound", burst.lower_bound("shared.")->first);
+	LOG("lower_bound", ( burst.lower_bound("shared0") == burst.end() ));
+	LOG("prefix", list_prefixed(burst, "shared/1").size());
+	// Keys leaving it split the skip, keys ending inside it land in the node above
+	burst["shared"] = -1;
+	burst["share+"] = -2;
+	burst["shared/"] = -3;
+	LOG("size", burst.size());
+	LOG("find", burst.find("shared")->second);
+	LOG("find", burst.find("shared/0014")->second);
+	LOG("lower_bound", burst.lower_bound("share")->first);
+	LOG("upper_bound", burst.upper_bound("shared")->first);
+	LOG("upper_bound", burst.upper_bound("shared/")->first);
+	LOG("begin", burst.begin()->first);
+	LOG("rbegin", burst.rbegin()->first);
+	// Swapped with an empty map, both stay usable
+	map.clear();
+	map.swap(burst);
+	LOG("size", map.size());
+	LOG("empty", burst.empty());
+	burst["x"] = 1;
+	LOG_EACH("iterator", burst.begin(), burst.end());
+	map.clear();
+	LOG("empty", map.empty());
+	LOG_EACH("iterator", map.begin(), map.end());
+}
+
+#ifdef FT
+typedef ft::bitmap_set<unsigned int> bitmap_set;
+#else
+typedef std::set<unsigned int> bitmap_set;
+#endif
+
+void test_bitmap_set(){
+	bitmap_set	set;
+
+	LOG("empty", set.empty());
+	LOG("find", ( set.find(0) == set.end() ));
+	LOG("lower_bound", ( set.lower_bound(0) == set.end() ));
+	LOG("upper_bound", ( set.upper_bound(~0u) == set.end() ));
+	// Both ends of the first word, then the next word grows the universe
+	set.insert(63);
+	set.insert(0);
+	LOG("rbegin", *set.rbegin());
+	LOG("upper_bound", ( set.upper_bound(63) == set.end() ));
+	LOG("lower_bound", ( set.lower_bound(64) == set.end() ));
+	set.insert(64);
+	set.insert(127);
+	LOG("upper_bound", *set.upper_bound(63));
+	LOG("lower_bound", *set.lower_bound(65));
+	LOG_EACH("iterator", set.begin(), set.end());
+	// Past 4096 and 262144 keys, a level is added above the others
+	set.insert(4095);
+	set.insert(4096);
+	set.insert(262143);
+	set.insert(262144);
+	LOG("size", set.size());
+	LOG("upper_bound", *set.upper_bound(4095));
+	LOG("upper_bound", *set.upper_bound(128));
+	LOG("lower_bound", *set.lower_bound(4097));
+	LOG("lower_bound", *set.lower_bound(262144));
+	LOG("upper_bound", ( set.upper_bound(262144) == set.end() ));
+	LOG("find", ( set.find(262145) == set.end() ));
+	LOG("find", ( set.find(~0u) == set.end() ));
+	LOG("count", set.count(4096));
+	LOG_EACH("reverse iterator", set.rbegin(), set.rend());
+	// Erasing the last key of a word empties its summary bits on every level
+	set.erase(4095);
+	set.erase(4096);
+	LOG("upper_bound", *set.upper_bound(127));
+	LOG("lower_bound", *set.lower_bound(128));
+	set.erase(262143);
+	set.erase(262144);
+	LOG("upper_bound", ( set.upper_bound(127) == set.end() ));
+	LOG("rbegin", *set.rbegin());
+	set.erase(set.find(64));
+	set.erase(127);
+	LOG("erase", set.erase(127));
+	LOG("size", set.size());
+	LOG_EACH("iterator", set.begin(), set.end());
+	// Sparse keys far apart, the searches crossing empty words and summary words
+	for ( unsigned int index = 0 ; index < 8 ; index++ ){
+		set.insert(index * 1000003u);
+	}
+	LOG("lower_bound", *set.lower_bound(64));
+	LOG("lower_bound", *set.lower_bound(3000010));
+	LOG("upper_bound", *set.upper_bound(5000015));
+	LOG_EACH("reverse iterator", set.rbegin(), set.rend());
+	set.erase(set.lower_bound(1), set.lower_bound(7000021));
+	LOG_EACH("iterator", set.begin(), set.end());
+	set.clear();
+	LOG("empty", set.empty());
+	LOG("lower_bound", ( set.lower_bound(0) == set.end() ));
+	LOG_EACH("iterator", set.begin(), set.end());
+}
+
+#ifdef FT
+typedef ft::roaring_set<> roaring_set;
+#else
+typedef std::set<unsigned int> roaring_set;
+#endif
+
+void roaring_union(roaring_set &set, const roaring_set &other){
+#ifdef FT
+	set.set_union(other);
+#else
+	roaring_set result;
+
+	std::set_union(set.begin(), set.end(), other.begin(), other.end(), std::inserter(result, result.end()));
+	set.swap(result);
+#endif
+}
+
+void roaring_intersection(roaring_set &set, const roaring_set &other){
+#ifdef FT
+	set.set_intersection(other);
+#else
+	roaring_set result;
+
+	std::set_intersection(set.begin(), set.end(), other.begin(), other.end(), std::inserter(result, result.end()));
+	set.swap(result);
+#endif
+}
+
+void roaring_difference(roaring_set &set, const roaring_set &other){
+#ifdef FT
+	set.set_difference(other);
+#else
+	roaring_set result;
+
+	std::set_difference(set.begin(), set.end(), other.begin(), other.end(), std::inserter(result, result.end()));
+	set.swap(result);
+#endif
+}
+
+void test_roaring_set(){
+	roaring_set	set;
+	roaring_set	other;
+
+	LOG("empty", set.empty());
+	LOG("find", ( set.find(0) == set.end() ));
+	// The last value of a chunk and the first of the next one
+	set.insert(65535);
+	set.insert(65536);
+	set.insert(131071);
+	LOG("upper_bound", *set.upper_bound(65535));
+	LOG("lower_bound", *set.lower_bound(65537));
+	LOG("rbegin", *++set.rbegin());
+	set.erase(65536);
+	LOG("upper_bound", *set.upper_bound(65535));
+	LOG("lower_bound", *set.lower_bound(0));
+	// A chunk of even values is an array up to 4096 of them, the 4097th makes it a bitmap
+	for ( unsigned int index = 0 ; index < 4096 ; index++ ){
+		set.insert(2 * 65536 + 2 * index);
+	}
+	LOG("size", set.size());
+	LOG("insert", set.insert(2 * 65536 + 8190).second);
+	LOG("lower_bound", ( set.lower_bound(2 * 65536 + 8191) == set.end() ));
+	LOG("insert", set.insert(2 * 65536 + 8191).second);
+	LOG("size", set.size());
+	LOG("count", set.count(2 * 65536 + 8191));
+	LOG("count", set.count(2 * 65536 + 8189));
+	LOG("lower_bound", *set.lower_bound(2 * 65536 + 8189));
+	LOG("upper_bound", ( set.upper_bound(2 * 65536 + 8191) == set.end() ));
+	// Then back to an array when it falls to 4096
+	set.erase(2 * 65536);
+	LOG("size", set.size());
+	LOG("lower_bound", *set.lower_bound(2 * 65536));
+	LOG("lower_bound", *set.lower_bound(2 * 65536 + 8189));
+	LOG("erase", set.erase(2 * 65536));
+	LOG_EACH("iterator", set.lower_bound(2 * 65536 + 8180), set.lower_bound(3 * 65536));
+	// A range becomes a single run once optimized, edited inside and at its ends
+	for ( unsigned int index = 1000 ; index < 4000 ; index++ ){
+		set.insert(3 * 65536 + index);
+	}
+#ifdef FT
+	set.optimize();
+#endif
+	set.erase(3 * 65536 + 2000);
+	set.erase(3 * 65536 + 1000);
+	set.erase(3 * 65536 + 3999);
+	set.insert(3 * 65536 + 999);
+	set.insert(3 * 65536 + 4001);
+	LOG("size", set.size());
+	LOG("find", ( set.find(3 * 65536 + 2000) == set.end() ));
+	LOG("upper_bound", *set.upper_bound(3 * 65536 + 1999));
+	LOG("lower_bound", *set.lower_bound(3 * 65536 + 3999));
+	LOG_EACH("iterator", set.lower_bound(3 * 65536 + 995), set.lower_bound(3 * 65536 + 1003));
+	LOG_EACH("iterator", set.lower_bound(3 * 65536 + 1997), set.lower_bound(3 * 65536 + 2003));
+	// Filling the gaps merges the runs back, emptying one removes it
+	set.insert(3 * 65536 + 2000);
+	set.insert(3 * 65536 + 1000);
+	set.insert(3 * 65536 + 3999);
+	set.insert(3 * 65536 + 4000);
+	set.erase(3 * 65536 + 4001);
+	LOG("size", set.size());
+	LOG("lower_bound", *set.lower_bound(3 * 65536 + 4000));
+	LOG_EACH("iterator", set.lower_bound(3 * 65536 + 3997), set.lower_bound(4 * 65536));
+	// 2047 runs of 3 values: splitting them goes past 2048 runs into a bitmap
+	for ( unsigned int index = 0 ; index < 2047 * 4 ; index += 4 ){
+		set.insert(4 * 65536 + index);
+		set.insert(4 * 65536 + index + 1);
+		set.insert(4 * 65536 + index + 2);
+	}
+#ifdef FT
+	set.optimize();
+#endif
+	set.erase(4 * 65536 + 1);
+	LOG("count", set.count(4 * 65536 + 2));
+	set.erase(4 * 65536 + 5);
+	LOG("size", set.size());
+	LOG("upper_bound", *set.upper_bound(4 * 65536));
+	LOG("lower_bound", *set.lower_bound(4 * 65536 + 5));
+	LOG("rbegin", *set.rbegin());
+	LOG_EACH("iterator", set.lower_bound(4 * 65536), set.lower_bound(4 * 65536 + 12));
+
+	// Set operations between an array, a bitmap and runs
+	for ( unsigned int index = 0 ; index < 5000 ; index++ ){
+		other.insert(2 * 65536 + index);
+		other.insert(3 * 65536 + index);
+	}
+	roaring_set copy(set);
+
+	roaring_intersection(copy, other);
+	LOG("intersection", copy.size());
+	LOG_EACH("iterator", copy.lower_bound(3 * 65536 + 3995), copy.end());
+	copy = set;
+	roaring_union(copy, other);
+	LOG("union", copy.size());
+	LOG("count", copy.count(2 * 65536 + 4999));
+	copy = set;
+	roaring_difference(copy, other);
+	LOG("difference", copy.size());
+	LOG_EACH("iterator", copy.lower_bound(2 * 65536), copy.lower_bound(2 * 65536 + 5010));
+	LOG("lower_bound", *copy.lower_bound(3 * 65536));
+	set.clear();
+	LOG("empty", set.empty());
+	LOG_EACH("iterator", set.begin(), set.end());
+}
+
+// Orders pairs on their first member only
+struct PairFirstLess {
+	bool operator()(const ft::pair<int, int> &x, const ft::pair<int, int> &y) const { return x.first < y.first; }
+};
+
+#ifdef FT
+typedef ft::lazy_sorted_vector<int> lazy_sorted_vector;
+typedef ft::lazy_sorted_vector<ft::pair<int, int>, PairFirstLess> lazy_sorted_pairs;
+#else
+typedef std::multiset<int> lazy_sorted_vector;
+typedef std::multiset<std::pair<int, int>, PairFirstLess> lazy_sorted_pairs;
+#endif
+
+template<class Set>
+void lazy_append(Set &set, const typename Set::value_type &val){
+#ifdef FT
+	set.push_back(val);
+#else
+	set.insert(val);
+#endif
+}
+
+void test_lazy_sorted_vector(){
+	lazy_sorted_vector	set;
+	lazy_sorted_pairs	pairs;
+
+	LOG("empty", set.empty());
+	LOG("find", ( set.find(0) == set.end() ));
+	// 16 values are sorted in place by insertion, the first lookup sorting them
+	for ( int index = 16 ; index > 0 ; index-- ){
+		lazy_append(set, index * 10);
+	}
+	LOG("size", set.size());
+	LOG("begin", *set.begin());
+	LOG("lower_bound", *set.lower_bound(55));
+	// 17 go through a merge sort, then interleave with the sorted prefix
+	for ( int index = 0 ; index < 17 ; index++ ){
+		lazy_append(set, ( index * 7 ) % 17 * 10 + 5);
+	}
+	LOG("size", set.size());
+	LOG("lower_bound", *set.lower_bound(0));
+	LOG("upper_bound", *set.upper_bound(160));
+	LOG("rbegin", *set.rbegin());
+	LOG_EACH("iterator", set.begin(), set.end());
+	// A tail wholly before the prefix moves all of it, one wholly after moves nothing
+	for ( int index = 0 ; index < 20 ; index++ ){
+		lazy_append(set, -index);
+	}
+	LOG("begin", *set.begin());
+	LOG("find", *set.find(-19));
+	for ( int index = 0 ; index < 3 ; index++ ){
+		lazy_append(set, 1000 + index);
+	}
+	LOG("upper_bound", *set.upper_bound(165));
+	LOG("rbegin", *set.rbegin());
+	// Equal values both in the prefix and in the tail
+	lazy_append(set, 50);
+	lazy_append(set, 50);
+	lazy_append(set, 0);
+	LOG("count", set.count(50));
+	LOG("count", set.count(0));
+	LOG("equal_range", std::distance(set.equal_range(50).first, set.equal_range(50).second));
+	LOG("upper_bound", *set.upper_bound(50));
+	LOG("erase", set.erase(50));
+	set.erase(set.find(1000));
+	set.erase(set.lower_bound(-15), set.lower_bound(100));
+	LOG("size", set.size());
+	LOG_EACH("iterator", set.begin(), set.end());
+	LOG_EACH("reverse iterator", set.rbegin(), set.rend());
+	set.clear();
+	LOG("empty", set.empty());
+	LOG_EACH("iterator", set.begin(), set.end());
+
+	// Equivalent values keep the order they were appended in
+	for ( int index = 0 ; index < 60 ; index++ ){
+		lazy_append(pairs, ft::make_pair(index % 3, index));
+	}
+	LOG("find", pairs.find(ft::make_pair(1, 0))->second);
+	for ( int index = 60 ; index < 90 ; index++ ){
+		lazy_append(pairs, ft::make_pair(2 - index % 3, index));
+	}
+	for ( lazy_sorted_pairs::const_iterator it = pairs.lower_bound(ft::make_pair(1, 0)) ;
+			it != pairs.upper_bound(ft::make_pair(1, 0)) ; ++it ){
+		std::cout << it->second << " ";
+	}
+	std::cout << std::endl;
+
+	// Erasing through an iterator taken before an append leaves the append pending
+	set.clear();
+#ifdef FT
+	set.reserve(8);
+#endif
+	for ( int index = 0 ; index < 5 ; index++ ){
+		lazy_append(set, index * 10);
+	}
+	lazy_sorted_vector::iterator it = set.find(20);
+
+	lazy_append(set, 5);
+	set.erase(it);
+	LOG("count", set.count(5));
+	LOG("find", *set.find(5));
+	LOG_EACH("iterator", set.begin(), set.end());
+}
+
+#ifdef FT
+typedef ft::buffered_map<int, int> buffered_map;
+#else
+typedef std::map<int, int> buffered_map;
+#endif
+
+void buffered_assign(buffered_map &map, int k, int v){
+#ifdef FT
+	map.insert_or_assign(k, v);
+#else
+	map[k] = v;
+#endif
+}
+
+int buffered_at(const buffered_map &map, int k){
+#ifdef FT
+	return map.at(k);
+#else
+	return map.find(k)->second;
+#endif
+}
+
+void test_buffered_map(){
+	buffered_map	map;
+	std::size_t		buffer_size;
+
+#ifdef FT
+	buffer_size = map.buffer_size();
+#else
+	buffer_size = 65536;
+#endif
+	LOG("buffer_size", buffer_size);
+	LOG("count", map.count(1));
+	// 255 writes stay in the tail, the 256th moves it to the log, the 257th starts a new one
+	for ( int index = 0 ; index < 257 ; index++ ){
+		map.insert(ft::make_pair(( index * 7 ) % 257, index));
+		if ( index == 254 || index == 255 || index == 256 ){
+			LOG("count", map.count(( index * 7 ) % 257));
+			LOG("at", buffered_at(map, ( index * 7 ) % 257));
+			LOG("at", buffered_at(map, 7));
+			LOG("count", map.count(257));
+		}
+	}
+	// Writes to a key in the log, then in the tail
+	map.erase(0);
+	LOG("count", map.count(0));
+	map.insert(ft::make_pair(0, -1));
+	LOG("at", buffered_at(map, 0));
+	buffered_assign(map, 14, 1400);
+	map.insert(ft::make_pair(14, -2));
+	LOG("at", buffered_at(map, 14));
+	map.erase(300);
+	map.insert(ft::make_pair(300, 1));
+	map.insert(ft::make_pair(300, 2));
+	LOG("at", buffered_at(map, 300));
+	// Shrinking the buffer under what is pending applies it to the tree
+#ifdef FT
+	map.buffer_size(1000);
+	map.buffer_size(100);
+#endif
+	map.insert(ft::make_pair(14, -3));
+	LOG("at", buffered_at(map, 14));
+	map.erase(21);
+	map.erase(21);
+	LOG("count", map.count(21));
+	buffered_assign(map, 21, 2100);
+	LOG("at", buffered_at(map, 21));
+	LOG("size", map.size());
+	LOG("find", map.find(300)->second);
+	LOG("lower_bound", map.lower_bound(256)->first);
+	LOG("upper_bound", map.upper_bound(256)->first);
+	map[8] = 800;
+	LOG("operator[]", map[8]);
+	LOG_EACH("iterator", map.begin(), map.lower_bound(30));
+	LOG("rbegin", map.rbegin()->first);
+	map.clear();
+	LOG("empty", map.empty());
+	LOG("count", map.count(8));
 }
 
 void test_map_clear(){
@@ -2315,9 +3776,24 @@ void test_map(){
 	test_map_insert();
 	test_map_insert_hint();
 	test_map_insert_range();
+	test_map_insert_check();
 	test_map_erase_it();
 	test_map_erase_key();
 	test_map_erase_range();
+	test_map_extract();
+	test_map_erase_if();
+	test_map_split_join();
+	test_map_set_operations();
+	test_map_bulk_load();
+	test_map_insert_sorted_batch();
+	test_map_find_batch();
+	test_map_cursor();
+	test_map_reserve();
+	test_map_compact();
+	test_map_parallel();
+	test_map_aggregate();
+	test_map_avl();
+	test_map_prefix();
 	test_map_clear();
 	test_map_swap();
 	test_map_find();
@@ -2340,5 +3816,14 @@ int     main(){
     test_vector();
     test_stack();
     test_map();
+    test_interval_map();
+    test_splay_map();
+    test_adaptive_map();
+    test_radix_map();
+    test_trie_map();
+    test_bitmap_set();
+    test_roaring_set();
+    test_lazy_sorted_vector();
+    test_buffered_map();
 	test_containers_time();
 }
@@ -2,10 +2,22 @@
 #define MAP_HPP
 
 # include <functional>
+# include <cstdlib>
 # include <memory>
+# include <new>
+# include <string>
+# include <stdint.h>
 # include "utility/pair.hpp"
 # include "traits/iterator.hpp"
 # include "algorithm/algorithm.hpp"
+# include "vector.hpp"
+# include "utility/thread.hpp"
+
+# if defined(__GNUC__)
+#  define FT_PREFETCH(addr) __builtin_prefetch(addr)
+# else
+#  define FT_PREFETCH(addr) ((void)(addr))
+# endif
 
 namespace ft
 {
@@ -25,6 +37,17 @@ namespace ft
 	template<class T>
 	struct rb_const_reverse_iterator;
 
+	template<class Node>
+	class rb_node_pool;
+
+	template<class Point, class T, class Compare, class Alloc>
+	class interval_map;
+
+	template<class Key, class T, class Compare, class Alloc>
+	class buffered_map;
+
+
+	struct rb_no_prefix { };
 
 	enum rb_color { RB_COLOR_BLACK = 1, RB_COLOR_RED, RB_COLOR_SENTINEL, RB_COLOR_NULL };
 	/**
@@ -43,11 +66,13 @@ namespace ft
 		typedef typename node_allocator_type::const_pointer		const_pointer;
 		typedef typename std::size_t							size_type;
 
-		value_type	data;
-		pointer		parent;
-		pointer		left;
-		pointer		right;
-		int			color;
+		value_type			data;
+		pointer				parent;
+		pointer				left;
+		pointer				right;
+		int					color;
+		unsigned short		pooled;		// Slot in its rb_node_pool block, 0 when not pooled
+		unsigned char		height;
 
 		/**
 		 * Default constructor
@@ -60,7 +85,7 @@ namespace ft
 		 * 
 		 */
 		rb_node() 
-			: data( value_type() ), parent( NULL ), left( NULL ), right( NULL ), color( RB_COLOR_RED ) { }
+			: data( value_type() ), parent( NULL ), left( NULL ), right( NULL ), color( RB_COLOR_RED ), pooled( 0 ), height( 1 ) { }
 
 		/**
 		 * Data constructor
@@ -72,7 +97,7 @@ namespace ft
 		 * 
 		 */
 		rb_node( const value_type &__data )
-			: data( __data ), parent( NULL ), left( NULL ), right( NULL ), color( RB_COLOR_RED ) { }
+			: data( __data ), parent( NULL ), left( NULL ), right( NULL ), color( RB_COLOR_RED ), pooled( 0 ), height( 1 ) { }
 
 		/**
 		 * Data-Parent constructor
@@ -85,7 +110,7 @@ namespace ft
 		 * 
 		 */
 		rb_node( const value_type &__data, pointer __parent )
-			: data( __data ), parent( __parent ), left( NULL ), right( NULL ), color( RB_COLOR_RED ) { }
+			: data( __data ), parent( __parent ), left( NULL ), right( NULL ), color( RB_COLOR_RED ), pooled( 0 ), height( 1 ) { }
 
 		/**
 		 * Get the grand parent
@@ -181,6 +206,25 @@ namespace ft
 			return node_allocator_type().max_size();
 		}
 
+		/**
+		 * Subtree summary
+		 * 
+		 * Plain nodes carry no summary, so there is nothing to recompute when their
+		 * children change. See rb_augmented_node.
+		 * 
+		 */
+		const static bool augmented = false;
+
+		static void pull( pointer ) { }
+
+		/**
+		 * Key prefix
+		 * 
+		 * Plain nodes cache no prefix of their key. See rb_prefixed_node.
+		 * 
+		 */
+		static rb_no_prefix prefix_of( pointer ) { return rb_no_prefix(); }
+
 		class Compare {
 			private:
 				pointer m_node;
@@ -210,14 +254,24 @@ namespace ft
 		static pointer create_node( const value_type &data, node_allocator_type alloc = node_allocator_type() ){
 			pointer node = alloc.allocate( 1 );
 
-			alloc.construct( node, data );
+			try {
+				alloc.construct( node, data );
+			} catch ( ... ){
+				alloc.deallocate( node, 1 );
+				throw ;
+			}
 			return node;
 		}
 
 		static pointer create_node( const value_type &data, pointer parent, node_allocator_type alloc = node_allocator_type() ){
 			pointer node = alloc.allocate( 1 );
 
-			alloc.construct( node, rb_node( data, parent ) );
+			try {
+				alloc.construct( node, rb_node( data, parent ) );
+			} catch ( ... ){
+				alloc.deallocate( node, 1 );
+				throw ;
+			}
 			return node;
 		}
 
@@ -248,17 +302,506 @@ namespace ft
 		/**
 		 * Destroy node
 		 * 
-		 * Call the delete operator of the node and deallocate memory.
+		 * Call the delete operator of the node and deallocate memory, or give the memory
+		 * back to the pool the node was taken from.
 		 */
 		static void destroy_node( pointer node, node_allocator_type alloc = node_allocator_type() ){
 			if ( node != NULL ){
+				unsigned short pooled = node->pooled;
+
 				alloc.destroy( node );
-				alloc.deallocate( node, 1 );
+				if ( pooled )
+					rb_node_pool<node_type>::give( node, pooled );
+				else
+					alloc.deallocate( node, 1 );
 				node = NULL;
 			}
 		}
 	};
 
+	/**
+	 * Default augment of a map, storing nothing in its nodes.
+	 */
+	struct rb_no_augment {
+		typedef rb_no_augment summary_type;
+	};
+
+	/**
+	 * Augmented node
+	 * 
+	 * A node that also holds the summary of its subtree, as defined by the Augment
+	 * policy: a monoid over summary_type with an identity() element, an associative
+	 * combine(a, b), and lift(value) giving the summary of a single element. The
+	 * summary of a node is
+	 * 
+	 * combine(combine(summary(left), lift(data)), summary(right))
+	 * 
+	 * and pull recomputes it from the children, which must be up to date. Missing
+	 * children and sentinels count as identity(). Augment is default constructed
+	 * whenever it is needed, so it must not hold any state.
+	 * 
+	 */
+	template<class T, class Augment>
+	struct rb_augmented_node : public rb_node<T> {
+		typedef rb_node<T>										base_type;
+		typedef T												value_type;
+		typedef typename base_type::pointer						pointer;
+		typedef typename base_type::size_type					size_type;
+		typedef typename Augment::summary_type					summary_type;
+		typedef typename std::allocator<rb_augmented_node>		node_allocator_type;
+
+		summary_type		summary;
+
+		rb_augmented_node()
+			: base_type(), summary( Augment().identity() ) { }
+
+		rb_augmented_node( const value_type &__data )
+			: base_type( __data ), summary( Augment().lift( __data ) ) { }
+
+		size_type max_size() const {
+			return node_allocator_type().max_size();
+		}
+
+		const static bool augmented = true;
+
+		static summary_type summary_of( pointer node ){
+			if ( node == NULL || node->is_sentinel() )
+				return Augment().identity();
+			return static_cast<rb_augmented_node *>( node )->summary;
+		}
+
+		static void pull( pointer node ){
+			Augment augment;
+
+			static_cast<rb_augmented_node *>( node )->summary = augment.combine(
+				augment.combine( summary_of( node->left ), augment.lift( node->data ) ),
+				summary_of( node->right ) );
+		}
+
+		static pointer create_node( const value_type &data, node_allocator_type alloc = node_allocator_type() ){
+			rb_augmented_node *node = alloc.allocate( 1 );
+
+			try {
+				alloc.construct( node, rb_augmented_node( data ) );
+			} catch ( ... ){
+				alloc.deallocate( node, 1 );
+				throw ;
+			}
+			return node;
+		}
+
+		static pointer create_sentinel_node( node_allocator_type alloc = node_allocator_type() ){
+			rb_augmented_node *node = alloc.allocate( 1 );
+
+			alloc.construct( node, rb_augmented_node() );
+			node->color = RB_COLOR_SENTINEL;
+			return node;
+		}
+
+		static void destroy_node( pointer node, node_allocator_type alloc = node_allocator_type() ){
+			if ( node != NULL ){
+				rb_augmented_node	*self = static_cast<rb_augmented_node *>( node );
+				unsigned short		pooled = self->pooled;
+
+				alloc.destroy( self );
+				if ( pooled )
+					rb_node_pool<rb_augmented_node>::give( self, pooled );
+				else
+					alloc.deallocate( self, 1 );
+			}
+		}
+	};
+
+	/**
+	 * Node type of a map, augmented unless Augment is rb_no_augment.
+	 */
+	template<class T, class Augment>
+	struct rb_node_select {
+		typedef rb_augmented_node<T, Augment>	type;
+	};
+
+	template<class T>
+	struct rb_node_select<T, rb_no_augment> {
+		typedef rb_node<T>						type;
+	};
+
+	/**
+	 * Key prefix policies
+	 * 
+	 * A map whose rb_key_prefix<Key, Compare> is cached stores, in every node, a
+	 * prefix_type computed from its key by of(), such that a prefix going before
+	 * another one means the key does too. less() then orders two keys by their prefixes
+	 * first, and only calls Compare when they are equal. By default nothing is cached
+	 * and less() is Compare.
+	 * 
+	 */
+	template<class Key, class Compare>
+	struct rb_key_prefix {
+		typedef rb_no_prefix prefix_type;
+
+		const static bool cached = false;
+
+		static prefix_type of( const Key & ){ return prefix_type(); }
+
+		static bool less( const Compare &comp, const Key &a, const prefix_type &, const Key &b, const prefix_type & ){
+			return comp(a, b);
+		}
+	};
+
+	/**
+	 * String order caching prefixes
+	 * 
+	 * Orders strings as std::less<std::string> does. A map of string keys with this
+	 * order caches in every node the first 8 bytes of its key, most significant first
+	 * and padded with zeros, which order as std::string::compare does until they are
+	 * equal. Most comparisons are thus decided by one integer compare, without going
+	 * through the buffer of the key, which is only read on prefix ties. Nodes are 8
+	 * bytes bigger, hence it is not the default order.
+	 * 
+	 */
+	template<class Key>
+	struct prefix_less : std::less<Key> { };
+
+	template<>
+	struct rb_key_prefix<std::string, prefix_less<std::string> > {
+		typedef uint64_t prefix_type;
+
+		const static bool cached = true;
+
+		static prefix_type of( const std::string &k ){
+			std::string::size_type	size = k.size();
+			prefix_type				prefix = 0;
+
+			for ( std::string::size_type i = 0 ; i < 8 ; i++ ){
+				prefix <<= 8;
+				if ( i < size )
+					prefix |= static_cast<unsigned char>( k[i] );
+			}
+			return prefix;
+		}
+
+		static bool less( const prefix_less<std::string> &comp, const std::string &a, prefix_type pa,
+			const std::string &b, prefix_type pb ){
+			if ( pa != pb )
+				return pa < pb;
+			return comp(a, b);
+		}
+	};
+
+	/**
+	 * Prefixed node
+	 * 
+	 * A node of type Base also caching the prefix of its key, as defined by the
+	 * KeyPrefix policy.
+	 * 
+	 */
+	template<class Base, class KeyPrefix>
+	struct rb_prefixed_node : public Base {
+		typedef Base											base_type;
+		typedef typename base_type::value_type					value_type;
+		typedef typename base_type::pointer						pointer;
+		typedef typename base_type::size_type					size_type;
+		typedef typename KeyPrefix::prefix_type					prefix_type;
+		typedef typename std::allocator<rb_prefixed_node>		node_allocator_type;
+
+		prefix_type			prefix;
+
+		rb_prefixed_node()
+			: base_type(), prefix() { }
+
+		rb_prefixed_node( const value_type &__data )
+			: base_type( __data ), prefix( KeyPrefix::of( __data.first ) ) { }
+
+		size_type max_size() const {
+			return node_allocator_type().max_size();
+		}
+
+		static prefix_type prefix_of( pointer node ){
+			return static_cast<rb_prefixed_node *>( node )->prefix;
+		}
+
+		static pointer create_node( const value_type &data, node_allocator_type alloc = node_allocator_type() ){
+			rb_prefixed_node *node = alloc.allocate( 1 );
+
+			try {
+				alloc.construct( node, rb_prefixed_node( data ) );
+			} catch ( ... ){
+				alloc.deallocate( node, 1 );
+				throw ;
+			}
+			return node;
+		}
+
+		static pointer create_sentinel_node( node_allocator_type alloc = node_allocator_type() ){
+			rb_prefixed_node *node = alloc.allocate( 1 );
+
+			alloc.construct( node, rb_prefixed_node() );
+			node->color = RB_COLOR_SENTINEL;
+			return node;
+		}
+
+		static void destroy_node( pointer node, node_allocator_type alloc = node_allocator_type() ){
+			if ( node != NULL ){
+				rb_prefixed_node	*self = static_cast<rb_prefixed_node *>( node );
+				unsigned short		pooled = self->pooled;
+
+				alloc.destroy( self );
+				if ( pooled )
+					rb_node_pool<rb_prefixed_node>::give( self, pooled );
+				else
+					alloc.deallocate( self, 1 );
+			}
+		}
+	};
+
+	/**
+	 * Node type of a map, prefixed when its key prefix policy is cached.
+	 */
+	template<class Node, class KeyPrefix, bool Cached = KeyPrefix::cached>
+	struct rb_prefix_select {
+		typedef Node									type;
+	};
+
+	template<class Node, class KeyPrefix>
+	struct rb_prefix_select<Node, KeyPrefix, true> {
+		typedef rb_prefixed_node<Node, KeyPrefix>		type;
+	};
+
+	/**
+	 * Balancing policies
+	 * 
+	 * red_black_balance keeps the tree red black, with at most 2 log(n) levels and
+	 * O(1) rotations per update. avl_balance keeps the heights of the two subtrees of
+	 * every node within one of each other, which bounds the tree to 1.44 log(n) levels
+	 * for shallower lookups, at the price of more rotations and of a walk up to the
+	 * first node whose height is unchanged on every update. An AVL node stores its
+	 * height in rb_node::height, and its color is left meaningless.
+	 * 
+	 */
+	struct red_black_balance {
+		const static bool avl = false;
+	};
+
+	struct avl_balance {
+		const static bool avl = true;
+	};
+
+	/**
+	 * Node pool
+	 * 
+	 * Storage reserved for the nodes of a map, made of blocks handed out one node at a
+	 * time. A block holds as many nodes as asked for, or at least twice as many as the
+	 * last one, and no more than BLOCK_SIZE bytes. Each block starts with a pointer to
+	 * its pool, and a pooled node records its slot in the block in the padding after its
+	 * color, so it finds its pool without growing. The memory of a node goes back to its
+	 * pool when it is destroyed, even if it has been moved to another map in between,
+	 * and the pool lives until its map and every node taken from it are gone.
+	 * 
+	 * Only the map owning the pool takes nodes, from its own thread. Nodes may be given
+	 * back from any thread: they are pushed on a lock-free list that the owner empties
+	 * all at once when it runs out of nodes.
+	 * 
+	 */
+	template<class Node>
+	class rb_node_pool {
+		public:
+			typedef Node								node_type;
+			typedef node_type							*pointer;
+			typedef std::allocator<node_type>			node_allocator_type;
+			typedef std::size_t							size_type;
+
+			const static size_type						BLOCK_SIZE = 2 * 1024 * 1024;
+
+		private:
+			struct block_ {
+				rb_node_pool	*pool;
+				block_			*next;
+			};
+
+			// What a free node holds until it is taken again
+			struct free_ {
+				pointer			next;
+				unsigned short	slot;
+			};
+
+			typedef std::allocator<rb_node_pool>		pool_allocator_type;
+
+			const static size_type						HEADER_SIZE = ( ( sizeof(block_) + sizeof(node_type) - 1 ) / sizeof(node_type) ) * sizeof(node_type);
+			const static size_type						FIT_NODES = ( BLOCK_SIZE - HEADER_SIZE ) / sizeof(node_type);
+			// Slots are numbered from 1 in an unsigned short
+			const static size_type						BLOCK_NODES = ( FIT_NODES < 65535 ) ? FIT_NODES : 65535;
+
+			block_				*m_blocks;
+			pointer				m_free;
+			size_type			m_free_count;
+			pointer volatile	m_given;
+			pointer				m_first;
+			pointer				m_next;
+			pointer				m_end;
+			size_type			m_block_nodes;
+			volatile long		m_refs;
+
+			rb_node_pool()
+				: m_blocks( NULL ), m_free( NULL ), m_free_count( 0 ), m_given( NULL ), m_first( NULL ),
+				m_next( NULL ), m_end( NULL ), m_block_nodes( 0 ), m_refs( 1 ) { }
+
+			static free_ &free_of_(pointer node){
+				return *reinterpret_cast<free_ *>( static_cast<void *>( node ) );
+			}
+
+			static block_ *block_of_(pointer node, unsigned short slot){
+				return reinterpret_cast<block_ *>( reinterpret_cast<char *>( node - ( slot - 1 ) ) - HEADER_SIZE );
+			}
+
+			void push_free_(pointer node, unsigned short slot){
+				free_of_(node).next = m_free;
+				free_of_(node).slot = slot;
+				m_free = node;
+				m_free_count++;
+			}
+
+			/**
+			 * Moves the nodes given back since the last call to the free list.
+			 */
+			void collect_(){
+				pointer given = ft::atomic_exchange<node_type>(m_given, NULL);
+
+				while ( given != NULL ){
+					pointer next = free_of_(given).next;
+
+					this->push_free_(given, free_of_(given).slot);
+					given = next;
+				}
+			}
+
+			void unref_(){
+				block_ *next;
+
+				if ( ft::atomic_add(m_refs, -1) != 0 )
+					return ;
+				for ( ; m_blocks != NULL ; m_blocks = next ){
+					next = m_blocks->next;
+					std::free(m_blocks);
+				}
+				pool_allocator_type().deallocate(this, 1);
+			}
+
+		public:
+			/**
+			 * A new empty pool, owned by the caller until it calls release.
+			 */
+			static rb_node_pool *create(){
+				rb_node_pool *pool = pool_allocator_type().allocate(1);
+
+				return new ( pool ) rb_node_pool();
+			}
+
+			/**
+			 * Gives up ownership, the pool goes away with the last of its nodes.
+			 */
+			void release(){
+				this->unref_();
+			}
+
+			/**
+			 * Number of nodes that can still be taken without growing.
+			 */
+			size_type available(){
+				this->collect_();
+				return static_cast<size_type>( m_end - m_next ) + m_free_count;
+			}
+
+			/**
+			 * Adds blocks for at least count more nodes, the first one at least twice as
+			 * large as the previous block, and none larger than BLOCK_NODES. The last one
+			 * only holds what is left of count. Nothing is added when a node is too large
+			 * for a block.
+			 */
+			void grow(size_type count){
+				size_type least = 2 * m_block_nodes;
+
+				while ( BLOCK_NODES > 0 && count > 0 ){
+					size_type	nodes = ( count > least ) ? count : least;
+					void		*memory;
+
+					if ( nodes > BLOCK_NODES )
+						nodes = BLOCK_NODES;
+					// Full blocks stay aligned, for the kernel to back them with a huge page
+					if ( nodes == BLOCK_NODES ){
+						if ( posix_memalign(&memory, BLOCK_SIZE, BLOCK_SIZE) != 0 )
+							memory = NULL;
+					} else {
+						memory = std::malloc(HEADER_SIZE + nodes * sizeof(node_type));
+					}
+					if ( memory == NULL )
+						throw std::bad_alloc();
+					// What is left of the current block goes to the free list first
+					for ( ; m_next != m_end ; m_next++ ){
+						this->push_free_(m_next, static_cast<unsigned short>( m_next - m_first + 1 ));
+					}
+					block_ *block = static_cast<block_ *>( memory );
+
+					block->pool = this;
+					block->next = m_blocks;
+					m_blocks = block;
+					m_first = reinterpret_cast<pointer>( static_cast<char *>( memory ) + HEADER_SIZE );
+					m_next = m_first;
+					m_end = m_first + nodes;
+					m_block_nodes = nodes;
+					count -= ( count < nodes ) ? count : nodes;
+					least = 0;
+				}
+			}
+
+			/**
+			 * A node holding a copy of data, or NULL when the pool is exhausted.
+			 */
+			pointer take(const typename node_type::value_type &data){
+				pointer			node;
+				unsigned short	slot;
+
+				if ( m_free == NULL )
+					this->collect_();
+				if ( m_free != NULL ){
+					node = m_free;
+					slot = free_of_(node).slot;
+					m_free = free_of_(node).next;
+					m_free_count--;
+				} else if ( m_next != m_end ){
+					node = m_next++;
+					slot = static_cast<unsigned short>( node - m_first + 1 );
+				} else {
+					return NULL;
+				}
+				try {
+					node_allocator_type().construct(node, data);
+				} catch ( ... ){
+					this->push_free_(node, slot);
+					throw ;
+				}
+				node->pooled = slot;
+				ft::atomic_add(m_refs, 1);
+				return node;
+			}
+
+			/**
+			 * Takes back the memory of a destroyed pooled node, for its own pool. slot is
+			 * the value of its pooled member before it was destroyed.
+			 */
+			static void give(pointer node, unsigned short slot){
+				rb_node_pool	*pool = block_of_(node, slot)->pool;
+				pointer			head = NULL;
+				pointer			former;
+
+				free_of_(node).next = head;
+				free_of_(node).slot = slot;
+				while ( ( former = ft::atomic_compare_exchange<node_type>(pool->m_given, head, node) ) != head ){
+					head = former;
+					free_of_(node).next = head;
+				}
+				pool->unref_();
+			}
+	};
 
 	/**
 	 * 
@@ -290,9 +833,16 @@ namespace ft
 		class Key,												// map::key_type
 		class T,												// map::mapped_type
 		class Compare = std::less<Key>,							// map::key_compare
-		class Alloc = std::allocator<ft::pair<const Key, T> >	// map::allocator_type
+		class Alloc = std::allocator<ft::pair<const Key, T> >,	// map::allocator_type
+		class Augment = rb_no_augment,							// map::augment_type
+		class Balance = red_black_balance						// map::balance_type
 	>
 	class map {
+		template<class Point, class _T, class _Compare, class _Alloc>
+		friend class interval_map;
+		template<class _Key, class _T, class _Compare, class _Alloc>
+		friend class buffered_map;
+
 		public:
 			typedef Key																		key_type;
 			typedef T																		mapped_type;
@@ -309,6 +859,9 @@ namespace ft
 			typedef rb_const_iterator<value_type>											const_iterator;
 			typedef ft::reverse_iterator<iterator>											reverse_iterator;
 			typedef ft::reverse_iterator<const_iterator>									const_reverse_iterator;
+			typedef Augment																	augment_type;
+			typedef Balance																	balance_type;
+			typedef typename augment_type::summary_type										summary_type;
 
 			class value_compare : std::binary_function<value_type, value_type, bool> {
 				friend class map;
@@ -325,8 +878,266 @@ namespace ft
 			};
 		
 		private:
-			typedef rb_node<value_type>			node_type;
-			typedef typename node_type::pointer	node_pointer;
+			typedef rb_key_prefix<key_type, key_compare>				key_prefix;
+			typedef typename key_prefix::prefix_type					prefix_type;
+			typedef typename rb_prefix_select<
+				typename rb_node_select<value_type, Augment>::type, key_prefix>::type	node_type;
+			typedef typename node_type::pointer							node_pointer;
+
+			/**
+			 * Descent result
+			 * 
+			 * Everything a single root-to-leaf descent on a key can tell: the lower and
+			 * upper bounds of the key, and the node under which it would be linked.
+			 * A NULL bound stands for end().
+			 */
+			struct rb_descent_ {
+				node_pointer	lower;
+				node_pointer	upper;
+				node_pointer	parent;
+				bool			left;
+				bool			found;
+			};
+
+		public:
+			/**
+			 * Insert handle
+			 * 
+			 * Result of map::insert_check. It either refers to the element already holding
+			 * the key, or remembers where a new element with that key has to be linked by
+			 * map::insert_commit.
+			 * 
+			 * A handle is only valid until the next modification of the map. A default
+			 * constructed handle records no position, and map::insert_commit then inserts
+			 * as map::insert does.
+			 */
+			class insert_handle {
+				friend class map;
+				private:
+					node_pointer	m_node;
+					bool			m_left;
+					bool			m_found;
+				public:
+					insert_handle() : m_node( NULL ), m_left( false ), m_found( false ) { }
+
+					bool found() const {
+						return m_found;
+					}
+
+					iterator position() const {
+						return iterator( m_node );
+					}
+			};
+
+			/**
+			 * Node handle
+			 * 
+			 * Owns a node extracted from a map with map::extract, and destroys it if it is
+			 * never inserted back with map::insert.
+			 * 
+			 * As there is no move semantic, ownership is transferred on copy and assignment:
+			 * the source handle is left empty, like with std::auto_ptr.
+			 */
+			class node_handle {
+				friend class map;
+				private:
+					mutable node_pointer	m_node;
+
+					node_pointer release_() const {
+						node_pointer node = m_node;
+
+						m_node = NULL;
+						return node;
+					}
+
+				public:
+					node_handle() : m_node( NULL ) { }
+
+					node_handle(const node_handle &x) : m_node( x.release_() ) { }
+
+					node_handle &operator=(const node_handle &x){
+						if ( this != &x ){
+							node_type::destroy_node( m_node );
+							m_node = x.release_();
+						}
+						return *this;
+					}
+
+					~node_handle() {
+						node_type::destroy_node( m_node );
+					}
+
+					bool empty() const {
+						return m_node == NULL;
+					}
+
+					const key_type &key() const {
+						return m_node->data.first;
+					}
+
+					mapped_type &mapped() const {
+						return m_node->data.second;
+					}
+
+					value_type &value() const {
+						return m_node->data;
+					}
+
+					void swap(node_handle &x){
+						node_pointer tmp = x.m_node;
+
+						x.m_node = m_node;
+						m_node = tmp;
+					}
+			};
+
+			/**
+			 * Insert node result
+			 * 
+			 * Returned by map::insert(node_handle). When inserted is false, position refers to
+			 * the element that prevented the insertion (or end() for an empty handle) and node
+			 * keeps ownership of the rejected node.
+			 */
+			struct insert_return_type {
+				iterator	position;
+				bool		inserted;
+				node_handle	node;
+			};
+
+			/**
+			 * Cursor
+			 * 
+			 * Position in the container keeping the whole path from the root down to its node,
+			 * with the key range each node of the path bounds. A seek only climbs back to the
+			 * first node whose subtree can hold the key before going down again, so seeking
+			 * to a key d elements away costs O(log d) rather than O(log n), and moving to the
+			 * next element is amortized O(1) without following parent pointers.
+			 * 
+			 * A cursor starts at the first element. It is invalidated by any insertion or
+			 * erasure in the container, seek must then be called before anything else.
+			 */
+			class cursor {
+				friend class map;
+
+				private:
+					struct step_ {
+						node_pointer	node;
+						node_pointer	low;
+						node_pointer	high;
+					};
+
+					map					*m_map;
+					ft::vector<step_>	m_path;
+
+					static bool is_node_(node_pointer x){
+						return x != NULL && !x->is_sentinel();
+					}
+
+					void push_(node_pointer node, node_pointer low, node_pointer high){
+						step_ step;
+
+						step.node = node;
+						step.low = low;
+						step.high = high;
+						m_path.push_back(step);
+					}
+
+					void push_left_spine_(node_pointer node, node_pointer low, node_pointer high){
+						for ( ; is_node_(node) ; node = node->left ){
+							this->push_(node, low, high);
+							high = node;
+						}
+					}
+
+				public:
+					cursor() : m_map( NULL ), m_path() { }
+
+					explicit cursor(map &m) : m_map( &m ), m_path() {
+						this->push_left_spine_(m.m_root, NULL, NULL);
+					}
+
+					/**
+					 * Moves to the first element whose key does not go before k, or to the
+					 * end, and returns an iterator to it.
+					 */
+					iterator seek(const key_type &k){
+						const key_compare	&comp = m_map->m_comp;
+						node_pointer		result;
+						node_pointer		x;
+						node_pointer		child;
+
+						// Climb while the subtree of the top cannot hold the lower bound of k
+						while ( !m_path.empty() ){
+							const step_ &top = m_path.back();
+
+							if ( ( top.low == NULL || comp(top.low->data.first, k) )
+								&& ( top.high == NULL || !comp(top.high->data.first, k) ) )
+								break ;
+							m_path.pop_back();
+						}
+						if ( m_path.empty() ){
+							if ( !is_node_(m_map->m_root) )
+								return m_map->end();
+							this->push_(m_map->m_root, NULL, NULL);
+						}
+						result = m_path.back().high;
+						while ( true ){
+							step_ top = m_path.back();
+
+							x = top.node;
+							if ( comp(x->data.first, k) ){
+								child = x->right;
+								if ( !is_node_(child) )
+									break ;
+								this->push_(child, x, top.high);
+							} else {
+								result = x;
+								if ( !comp(k, x->data.first) )
+									break ;
+								child = x->left;
+								if ( !is_node_(child) )
+									break ;
+								this->push_(child, top.low, x);
+							}
+						}
+						// The lower bound is the last node left towards, or the bound above
+						while ( !m_path.empty() && m_path.back().node != result ){
+							m_path.pop_back();
+						}
+						return this->position();
+					}
+
+					iterator position() const {
+						return ( m_path.empty() ) ? m_map->end() : iterator( m_path.back().node );
+					}
+
+					bool at_end() const {
+						return m_path.empty();
+					}
+
+					reference operator*() const {
+						return m_path.back().node->data;
+					}
+
+					pointer operator->() const {
+						return &m_path.back().node->data;
+					}
+
+					cursor &operator++(){
+						step_ top = m_path.back();
+
+						if ( is_node_(top.node->right) ){
+							this->push_left_spine_(top.node->right, top.node, top.high);
+						} else {
+							while ( !m_path.empty() && m_path.back().node != top.high ){
+								m_path.pop_back();
+							}
+						}
+						return *this;
+					}
+			};
+
+			friend class cursor;
 
 		/**
 		 * Member variables
@@ -338,8 +1149,136 @@ namespace ft
 			allocator_type						m_alloc;
 			node_pointer						m_right_sentinel;
 			node_pointer						m_left_sentinel;
-			node_pointer						m_null;
-			typename node_type::Compare         m_is_null_node;
+			rb_node_pool<node_type>			*m_pool;
+
+			const static size_type				RANGE_ERASE_THRESHOLD = 32;
+			const static size_type				REBUILD_RATIO = 4;
+			const static int					PARALLEL_MIN_HEIGHT = 8;
+
+			enum rb_set_op_ { RB_SET_UNION, RB_SET_INTERSECTION, RB_SET_DIFFERENCE };
+
+			/**
+			 * One branch of a set operation, run by rb_set_ on its own thread.
+			 */
+			struct rb_set_task_ {
+				map				*self;
+				rb_set_op_		op;
+				node_pointer	t1;
+				int				bh1;
+				node_pointer	t2;
+				int				bh2;
+				size_type		threads;
+				node_pointer	result;
+				int				bh;
+				size_type		removed;
+
+				void operator()(){
+					result = self->rb_set_(op, t1, bh1, t2, bh2, threads, bh, removed);
+				}
+			};
+
+			friend struct rb_set_task_;
+
+			/**
+			 * Halves of a merge sort or of a balanced build, run on their own thread.
+			 */
+			struct rb_sort_task_ {
+				node_pointer		*nodes;
+				node_pointer		*buffer;
+				size_type			count;
+				const key_compare	*comp;
+				size_type			threads;
+
+				void operator()(){
+					rb_sort_nodes_(nodes, buffer, count, *comp, threads);
+				}
+			};
+
+			struct rb_build_task_ {
+				node_pointer const	*nodes;
+				size_type			count;
+				size_type			depth;
+				size_type			red_depth;
+				size_type			threads;
+				node_pointer		result;
+
+				void operator()(){
+					result = rb_build_parallel_(nodes, count, depth, red_depth, threads);
+				}
+			};
+
+			friend struct rb_sort_task_;
+			friend struct rb_build_task_;
+
+			const static size_type				INSERTION_SORT_MAX = 16;
+			const static size_type				PARALLEL_UNITS = 8;
+
+			/**
+			 * Part of a parallel traversal, a whole subtree or a lone node.
+			 */
+			struct rb_unit_ {
+				node_pointer	node;
+				bool			subtree;
+			};
+
+			template<class Function>
+			struct rb_each_task_ {
+				const ft::vector<rb_unit_>	*units;
+				volatile long				*next;
+				Function					f;
+
+				void operator()(){
+					long index;
+
+					while ( ( index = ft::atomic_add(*next, 1) - 1 ) < static_cast<long>( units->size() ) ){
+						const rb_unit_ &unit = (*units)[index];
+
+						if ( unit.subtree )
+							rb_visit_(unit.node, f);
+						else
+							f(unit.node->data);
+					}
+				}
+			};
+
+			template<class U, class Op>
+			struct rb_reduce_task_ {
+				const ft::vector<rb_unit_>	*units;
+				volatile long				*next;
+				ft::vector<U>				*partials;
+				Op							op;
+
+				void operator()(){
+					long index;
+
+					while ( ( index = ft::atomic_add(*next, 1) - 1 ) < static_cast<long>( units->size() ) ){
+						const rb_unit_	&unit = (*units)[index];
+						rb_fold_<U, Op>	fold = { &(*partials)[index], &op };
+
+						if ( unit.subtree )
+							rb_visit_(unit.node, fold);
+						else
+							fold(unit.node->data);
+					}
+				}
+			};
+
+			template<class Function>
+			friend struct rb_each_task_;
+
+			template<class U, class Op>
+			friend struct rb_reduce_task_;
+
+			template<class U, class Op>
+			struct rb_fold_ {
+				U	*value;
+				Op	*op;
+
+				void operator()(const value_type &x){
+					*value = (*op)(*value, x);
+				}
+			};
+			const static size_type				BATCH_LANES = 16;
 
 		/**
 		 * Public member functions.
@@ -360,8 +1299,7 @@ namespace ft
 					m_alloc( alloc ),
 					m_right_sentinel( node_type::create_sentinel_node() ),
 					m_left_sentinel( node_type::create_sentinel_node() ),
-					m_null( node_type::create_null_node() ),
-					m_is_null_node( node_type::create_compare( m_null ) )
+					m_pool( NULL )
 			{
 				
 			}
@@ -382,8 +1320,7 @@ namespace ft
 					m_alloc( alloc ),
 					m_right_sentinel( node_type::create_sentinel_node() ),
 					m_left_sentinel( node_type::create_sentinel_node() ),
-					m_null( node_type::create_null_node() ),
-					m_is_null_node( node_type::create_compare( m_null ) )
+					m_pool( NULL )
 			{
 				for ( ; first != last ; ++first ){
 					insert(*first);
@@ -404,8 +1341,7 @@ namespace ft
 				m_alloc(x.m_alloc),
 				m_right_sentinel(node_type::create_sentinel_node()),
 				m_left_sentinel(node_type::create_sentinel_node()),
-				m_null(node_type::create_null_node()),
-				m_is_null_node(node_type::create_compare(m_null))
+				m_pool(NULL)
 			{
 				// Copy with breath first search, to get rid of rebalancing ?
 				// When x is copied, the traversal will be in order, that will cause
@@ -439,7 +1375,34 @@ namespace ft
 				clear();
 				node_type::destroy_node(m_right_sentinel);
 				node_type::destroy_node(m_left_sentinel);
-				node_type::destroy_node(m_null);
+				if ( m_pool != NULL )
+					m_pool->release();
+			}
+
+			/**
+			 * Reserve nodes
+			 * 
+			 * Makes room for n elements without further allocations: node storage for the
+			 * missing ones is allocated in a block sized to them, split in blocks of at most
+			 * BLOCK_SIZE bytes for large n, and handed out by the following insertions.
+			 * Blocks added by later reserves are at least twice as large as the last one.
+			 * Only nodes taken from the reserve go back to it when their element is erased;
+			 * nodes allocated before the reserve, or once it ran out, are freed as usual.
+			 * 
+			 * Nodes moved to another map keep their storage, which returns to this reserve
+			 * when they are finally destroyed. It is released once the container and all
+			 * of its nodes are gone.
+			 */
+			void reserve(size_type n){
+				size_type available;
+
+				if ( n <= m_size )
+					return ;
+				if ( m_pool == NULL )
+					m_pool = rb_node_pool<node_type>::create();
+				available = m_pool->available();
+				if ( m_size + available < n )
+					m_pool->grow(n - m_size - available);
 			}
 
 			/**
@@ -448,106 +1411,267 @@ namespace ft
 			 * Extends the container by inserting new elements, effectively increasing the container 
 			 * size by the number of elements inserted.
 			 * 
-			 * Because element keys in a map are unique, the insertion operation checks whether each 
-			 * inserted element has a key equivalent to the one of an element already in the container, 
-			 * and if so, the element is not inserted, returning an iterator to this existing element 
-			 * (if the function returns a value).
+			 * Because element keys in a map are unique, the insertion operation checks whether each 
+			 * inserted element has a key equivalent to the one of an element already in the container, 
+			 * and if so, the element is not inserted, returning an iterator to this existing element 
+			 * (if the function returns a value).
+			 * 
+			 * For a similar container allowing for duplicate elements, see multimap.
+			 * 
+			 * An alternative way to insert elements in a map is by using member function map::operator[].
+			 * 
+			 * Internally, map containers keep all their elements sorted by their key following the criterion 
+			 * specified by its comparison object. The elements are always inserted in its respective position 
+			 * following this ordering.
+			 * 
+			 */
+			ft::pair<iterator, bool> insert(const value_type &val){
+				insert_handle handle = this->insert_check( val.first );
+
+				if ( handle.found() ){
+					return ft::pair<iterator, bool>( handle.position(), false );
+				}
+				return ft::pair<iterator, bool>( this->insert_commit( handle, val ), true );
+			}
+
+			template<class InputIterator>
+			void insert(InputIterator first, InputIterator last){
+				for ( ; first != last ; ++first ){
+					this->insert(*first);
+				}
+			}
+
+			/**
+			 * Bulk load
+			 * 
+			 * Replaces the content of the container by the elements in the range [first,last).
+			 * As for insert, only the first of several elements with equivalent keys is kept.
+			 * 
+			 * Instead of inserting one element at a time, the new nodes are merge sorted, each
+			 * of up to threads threads sorting its own chunk before the chunks are merged, and
+			 * the tree is built bottom-up from the sorted nodes, its subtrees being built in
+			 * parallel the same way. This takes O(n log n / threads + n) and a buffer of two
+			 * pointers per element, and is in O(n) when the range is already sorted.
+			 */
+			template<class InputIterator>
+			void bulk_load(InputIterator first, InputIterator last, size_type threads = 1){
+				ft::vector<node_pointer>	nodes;
+				ft::vector<node_pointer>	buffer;
+				size_type					count = 0;
+
+				this->clear();
+				try {
+					for ( ; first != last ; ++first ){
+						node_pointer node = this->create_node_(*first);
+
+						try {
+							nodes.push_back(node);
+						} catch ( ... ){
+							node_type::destroy_node(node);
+							throw ;
+						}
+					}
+				} catch ( ... ){
+					for ( size_type index = 0 ; index < nodes.size() ; index++ ){
+						node_type::destroy_node(nodes[index]);
+					}
+					throw ;
+				}
+				if ( nodes.empty() )
+					return ;
+				buffer.resize(nodes.size());
+				rb_sort_nodes_(&nodes[0], &buffer[0], nodes.size(), m_comp, threads);
+				for ( size_type index = 0 ; index < nodes.size() ; index++ ){
+					if ( count > 0 && !m_comp(nodes[count - 1]->data.first, nodes[index]->data.first) )
+						node_type::destroy_node(nodes[index]);
+					else
+						nodes[count++] = nodes[index];
+				}
+				m_size = count;
+				m_root = rb_build_parallel_(&nodes[0], count, 0, rb_red_depth_(count), threads);
+				this->rb_attach_sentinels_();
+			}
+
+			iterator insert(iterator position, const value_type &val){
+				// A hint on a sentinel, end() or --begin(), holds no key to search from
+				if ( m_size == 0 || position.m_ptr == NULL || position.m_ptr->is_sentinel() ){
+					return this->insert(val).first;
+				}
+				return this->insert_commit( this->rb_finger_check_(position.m_ptr, val.first), val );
+			}
+
+			/**
+			 * Insert sorted batch
+			 * 
+			 * Inserts the elements in the range [first,last), as insert does, taking advantage
+			 * of a range sorted by key. The search for each key starts from the element inserted
+			 * or found for the previous one, and only climbs as far as the subtree bounding both
+			 * keys before going down again. For k keys into n elements this is O(k log(n / k)).
+			 * 
+			 * Rebalancing is left to the fix-up of each link, amortized O(1), the leftmost and
+			 * rightmost sentinels only moving when an inserted node takes their place. Unsorted
+			 * ranges are still inserted correctly, only with longer searches.
+			 */
+			template<class InputIterator>
+			void insert_sorted_batch(InputIterator first, InputIterator last){
+				node_pointer	finger = NULL;
+				insert_handle	handle;
+
+				for ( ; first != last ; ++first ){
+					if ( finger == NULL )
+						handle = this->insert_check( first->first );
+					else
+						handle = this->rb_finger_check_( finger, first->first );
+					finger = this->insert_commit( handle, *first ).m_ptr;
+				}
+			}
+
+			/**
+			 * Access element
+			 * 
+			 * If k matches the key of an element in the container, the function returns a reference to its mapped value.
+			 * If k does not match the key of any element in the container, the function inserts a new element with that
+			 * key and returns a reference to its mapped value. Notice that this always increases the container size by
+			 * one, even if no mapped value is assigned to the element (the element is constructed using its default constructor).
+			 * A similar member function, map::at, has the same behavior when an element with the key exists, 
+			 * but throws an exception when it does not.
+			 * 
+			 */
+			mapped_type& operator[](const key_type& k) {
+				insert_handle handle = this->insert_check( k );
+
+				if ( handle.found() ){
+					return handle.m_node->data.second;
+				}
+				return this->insert_commit( handle, value_type( k, mapped_type() ) )->second;
+			}
+
+			/**
+			 * Check insertion
+			 * 
+			 * First half of a two-phase insertion. Searches the container for an element with
+			 * a key equivalent to k in a single descent and returns a handle describing the result.
 			 * 
-			 * For a similar container allowing for duplicate elements, see multimap.
+			 * If the key is present, insert_handle::found returns true and insert_handle::position
+			 * points to the element. Otherwise the handle records the insertion point, and the
+			 * element can be added with map::insert_commit without searching the tree again.
 			 * 
-			 * An alternative way to insert elements in a map is by using member function map::operator[].
+			 * This lets callers build an expensive mapped value only when the key is missing.
+			 */
+			insert_handle insert_check(const key_type &k){
+				rb_descent_		descent = this->rb_descend_( k );
+				insert_handle	handle;
+
+				handle.m_found = descent.found;
+				handle.m_left = descent.left;
+				handle.m_node = ( descent.found ) ? descent.lower : descent.parent;
+				return handle;
+			}
+
+			/**
+			 * Commit insertion
 			 * 
-			 * Internally, map containers keep all their elements sorted by their key following the criterion 
-			 * specified by its comparison object. The elements are always inserted in its respective position 
-			 * following this ordering.
+			 * Second half of a two-phase insertion. Links a new element constructed from val at
+			 * the position recorded by map::insert_check and returns an iterator to it.
 			 * 
+			 * The key of val must be equivalent to the one given to insert_check, and the map must
+			 * not have been modified in between. If the handle refers to an existing element,
+			 * nothing is inserted and an iterator to that element is returned. A default
+			 * constructed handle falls back to map::insert.
 			 */
-			ft::pair<iterator, bool> insert(const value_type &val){
-				ft::pair<iterator, bool> ret;
-
-				if ( m_root == NULL ){
-					m_size++;
-					m_root = node_type::create_node( val );
-					m_root->set_right(m_right_sentinel);
-					m_root->set_left(m_left_sentinel);
-					return ft::pair<iterator, bool>( iterator( m_root ), true );
+			iterator insert_commit(const insert_handle &handle, const value_type &val){
+				if ( handle.m_found ){
+					return iterator( handle.m_node );
 				}
-				ret = insert_recursive_(m_root, val);
-				if ( ret.second ){
-					m_size++;
-					this->rb_insert_fix_tree_(ret.first.m_ptr);
+				// Only the handle of an empty map has no parent to link to
+				if ( handle.m_node == NULL && m_root != NULL ){
+					return this->insert(val).first;
 				}
-				return ret;
+				return this->rb_link_node_( handle, this->create_node_( val ) );
 			}
 
-			template<class InputIterator>
-			void insert(InputIterator first, InputIterator last){
-				for ( ; first != last ; ++first ){
-					this->insert(*first);
+			/**
+			 * Insert node
+			 * 
+			 * Links the node owned by nh into the container, without allocating or copying
+			 * its value. On success nh is left empty; if an element with an equivalent key
+			 * is already present, the node stays owned by the node field of the result.
+			 * 
+			 * As there is no move semantic, nh is taken by const reference and stolen from.
+			 */
+			insert_return_type insert(const node_handle &nh){
+				insert_return_type	ret;
+				insert_handle		handle;
+
+				if ( nh.empty() ){
+					ret.position = this->end();
+					ret.inserted = false;
+					return ret;
 				}
+				handle = this->insert_check( nh.key() );
+				if ( handle.found() ){
+					ret.position = handle.position();
+					ret.inserted = false;
+					ret.node = nh;
+					return ret;
+				}
+				ret.position = this->rb_link_node_( handle, nh.release_() );
+				ret.inserted = true;
+				return ret;
 			}
 
-			iterator insert(iterator position, const value_type &val){
-				iterator					curr = position;
-				iterator					next = position;
-				ft::pair<iterator, bool>	result;
+			/**
+			 * Extract node
+			 * 
+			 * Unlinks the element pointed by position from the container and returns a node
+			 * handle owning it. The element is neither copied nor deallocated, so it can be
+			 * inserted in another map with the same node type.
+			 * 
+			 * Only iterators to the extracted element are invalidated.
+			 */
+			node_handle extract(iterator position){
+				node_handle nh;
 
-				// If the position point to the end, insert normally
-				if ( size() == 0 || position == this->end() || position == (--this->begin()) ){
-					return this->insert(val).first;
-				}
-				// Otherwise, try another strategy, check that the val is within the range (position, position + 1)
-				// until a valid range is found, where node will be inserted.
-				// Check if greater or lower to determine the direction
-				if ( is_equal_val_(*position, val) ){
-					return position;
-				}
-				if ( this->value_comp()(*position, val) ){
-					// Go to right
-					while ( next != this->end() ) {
-						curr = next++;
-						
-						// Not found, insert at the end
-						if ( next == this->end() )
-							break;
-						if ( is_equal_val_(*curr, val) )
-							return curr;
-						if ( this->value_comp()(*curr, val) && this->value_comp()(val, *next) )
-							break;
-					}
-				} else {
-					// Go to left
-					while ( next != this->begin() ){
-						curr = next--;
-						
-						// Not found, insert at the end
-						if ( next == this->begin() )
-							break;
-						if ( is_equal_val_(*curr, val) )
-							return curr;
-						if ( this->value_comp()(val, *curr) && this->value_comp()(*next, val) )
-							break;
-					}
+				if ( position != this->end() ){
+					this->rb_unlink_node_( position.m_ptr );
+					nh.m_node = position.m_ptr;
 				}
-				result = insert_recursive_(curr.m_ptr, val);
-				if ( result.second )
-					m_size++;
-				return result.first;
+				return nh;
 			}
 
 			/**
-			 * Access element
+			 * Extract node
 			 * 
-			 * If k matches the key of an element in the container, the function returns a reference to its mapped value.
-			 * If k does not match the key of any element in the container, the function inserts a new element with that
-			 * key and returns a reference to its mapped value. Notice that this always increases the container size by
-			 * one, even if no mapped value is assigned to the element (the element is constructed using its default constructor).
-			 * A similar member function, map::at, has the same behavior when an element with the key exists, 
-			 * but throws an exception when it does not.
+			 * Unlinks the element with a key equivalent to k, if any, and returns a node handle
+			 * owning it. The returned handle is empty when no such element exists.
+			 */
+			node_handle extract(const key_type &k){
+				return this->extract( this->find( k ) );
+			}
+
+			/**
+			 * Splice nodes
 			 * 
+			 * Moves every element of source whose key is not already present in the container.
+			 * Nodes are relinked from one tree to the other, no element is copied or allocated.
+			 * Elements with a key already present stay in source.
 			 */
-			mapped_type& operator[](const key_type& k) {
-				return (*((this->insert(ft::make_pair(k,mapped_type()))).first)).second;
+			void merge(map &source){
+				iterator		it;
+				iterator		next;
+				insert_handle	handle;
+
+				if ( &source == this )
+					return ;
+				for ( it = source.begin() ; it != source.end() ; it = next ){
+					next = it;
+					++next;
+					handle = this->insert_check( it->first );
+					if ( !handle.found() ){
+						source.rb_unlink_node_( it.m_ptr );
+						this->rb_link_node_( handle, it.m_ptr );
+					}
+				}
 			}
 
 			/**
@@ -605,52 +1729,9 @@ namespace ft
 			void erase(iterator position){
 				if ( position != this->end() ){
 					node_pointer target = position.m_ptr;
-					node_pointer successor;
-					int         prev_color = target->color;
-					bool        is_root = target == m_root;
-
-					if ( target->left != NULL && target->right != NULL ){
-						// Case 3, node has children
-						// Go to the right subtree, then find the min (go to leftmost)
-						if ( target->left->is_sentinel() && target->right->is_sentinel() ){
-							m_root = NULL;
-							successor = NULL;
-						} else {
-							ft::pair<node_pointer, int> ret = detach_node_(target);
 
-							prev_color = ret.second;
-							successor = (!is_root) ? ret.first : m_root;
-						}
-					}
-					else if ( target->left != NULL || target->right != NULL){
-						// Case 2, target has one child
-						successor = (target->right != NULL) ? target->right : target->left;
-
-						if ( target->is_left() ){
-							target->parent->set_left(successor);
-						} else {
-							target->parent->set_right(successor);
-						}
-						if ( successor->is_sentinel() )
-							successor = target->parent;
-					}
-					else {
-						// Case 1, target has no children
-						m_null->parent = target->parent;
-						successor = m_null;
-						if ( target->is_left() ){
-							target->parent->left = m_null;
-						} else {
-							target->parent->right = m_null;
-						}
-					}
+					this->rb_unlink_node_( target );
 					node_type::destroy_node( target );
-					m_size--;
-					if ( m_root != NULL && !m_root->left->is_sentinel() && !m_root->right->is_sentinel() &&
-						prev_color == RB_COLOR_BLACK ){
-							this->rb_erase_fix_(successor);
-					}
-                    m_null->detach();
 				}
 			}
 
@@ -678,9 +1759,314 @@ namespace ft
 			 * This effectively reduces the container size by the number of elements removed, which are destroyed.
 			 */
 			void erase(iterator first, iterator last){
-				while ( first != last ){
-					this->erase((*first++).first);
+				iterator	it = first;
+				size_type	count = 0;
+
+				if ( first == this->begin() && last == this->end() ){
+					this->clear();
+					return ;
+				}
+				// Short ranges are cheaper to unlink one node at a time
+				while ( it != last && count < RANGE_ERASE_THRESHOLD ){
+					++it;
+					++count;
+				}
+				if ( it == last ){
+					while ( first != last ){
+						this->erase(first++);
+					}
+					return ;
+				}
+				this->rb_erase_range_(first.m_ptr, last.m_ptr);
+			}
+
+			/**
+			 * Erase elements satisfying a predicate
+			 * 
+			 * Removes every element for which pred returns true, and returns the number of
+			 * elements removed. pred is called once per element, in key order.
+			 * 
+			 * When at most a quarter of the elements go, they are unlinked one by one.
+			 * Otherwise the surviving nodes are relinked into a balanced tree in O(n),
+			 * without being copied or reallocated. Nodes are only freed once the walk is
+			 * over, so if pred throws the map is left unchanged.
+			 * 
+			 * Iterators to the surviving elements stay valid.
+			 */
+			template<class Predicate>
+			size_type erase_if(Predicate pred){
+				size_type					threshold = m_size / REBUILD_RATIO;
+				size_type					count = 0;
+				ft::vector<node_pointer>	kept;
+				ft::vector<node_pointer>	removed;
+				ft::vector<node_pointer>	stack;
+				node_pointer				x = m_root;
+				node_pointer				next;
+
+				if ( m_root == NULL )
+					return 0;
+				kept.reserve(m_size);
+				removed.reserve(threshold);
+				while ( true ){
+					for ( ; x != NULL && !x->is_sentinel() ; x = x->left ){
+						stack.push_back(x);
+					}
+					if ( stack.empty() )
+						break ;
+					x = stack.back();
+					stack.pop_back();
+					next = x->right;
+					if ( !pred(x->data) ){
+						kept.push_back(x);
+					} else {
+						removed.push_back(x);
+						count++;
+					}
+					x = next;
+				}
+				if ( count <= threshold ){
+					for ( size_type index = 0 ; index < count ; index++ ){
+						this->rb_unlink_node_(removed[index]);
+						node_type::destroy_node(removed[index]);
+					}
+				} else {
+					for ( size_type index = 0 ; index < removed.size() ; index++ ){
+						node_type::destroy_node(removed[index]);
+					}
+					m_size = kept.size();
+					m_root = ( m_size == 0 ) ? NULL : rb_build_(&kept[0], m_size, 0, rb_red_depth_(m_size));
+					this->rb_attach_sentinels_();
+				}
+				return count;
+			}
+
+			/**
+			 * Compact
+			 * 
+			 * Moves every element to a new node, the new nodes lying contiguously in memory
+			 * in key order, so that scans and the last levels of lookups touch consecutive
+			 * cache lines. The tree keeps its shape and colors. Values are all copied before
+			 * the former nodes are destroyed, so if a copy throws the map is left unchanged.
+			 * 
+			 * The storage of the new nodes is sized to the map, in blocks of at most
+			 * 2 MiB, and replaces any reserve made by map::reserve. All
+			 * iterators, references and cursors are invalidated.
+			 */
+			void compact(){
+				rb_node_pool<node_type>	*former = m_pool;
+				rb_node_pool<node_type>	*pool;
+				node_pointer			root;
+
+				if ( m_root == NULL )
+					return ;
+				pool = rb_node_pool<node_type>::create();
+				this->rb_detach_sentinels_();
+				m_pool = pool;
+				try {
+					pool->grow(m_size);
+					root = this->rb_compact_(m_root);
+				} catch ( ... ){
+					m_pool = former;
+					pool->release();
+					this->rb_attach_sentinels_();
+					throw ;
+				}
+				this->clear_recursive_(m_root);
+				if ( former != NULL )
+					former->release();
+				m_root = root;
+				m_root->parent = NULL;
+				this->rb_attach_sentinels_();
+			}
+
+			/**
+			 * Parallel traversals
+			 * 
+			 * parallel_for_each calls f on every element, and parallel_reduce folds the
+			 * elements with op, both on up to threads threads. The tree is cut a few levels
+			 * below the root into about PARALLEL_UNITS units per thread, each being a whole
+			 * subtree or a lone node above the cut, in key order. Threads take the next unit
+			 * until none is left, which balances uneven subtrees.
+			 * 
+			 * Each thread calls its own copy of f, on the elements of a unit in key order,
+			 * while units run concurrently. For parallel_reduce, op must both fold a value_type
+			 * into a T and combine two T. Every unit is folded starting from init, which must
+			 * thus be neutral for op, and the results of the units are combined in key order,
+			 * so op only needs to be associative.
+			 */
+			template<class Function>
+			void parallel_for_each(Function f, size_type threads = ft::hardware_concurrency()){
+				ft::vector<rb_unit_>	units;
+				volatile long			next = 0;
+
+				this->rb_collect_units_(m_root, 0, rb_unit_depth_(threads), units);
+
+				rb_each_task_<Function>	task = { &units, &next, f };
+
+				ft::parallel_repeat(task, ( threads < units.size() ) ? threads : units.size());
+			}
+
+			template<class U, class Op>
+			U parallel_reduce(U init, Op op, size_type threads = ft::hardware_concurrency()) const {
+				ft::vector<rb_unit_>	units;
+				volatile long			next = 0;
+				U						result = init;
+
+				this->rb_collect_units_(m_root, 0, rb_unit_depth_(threads), units);
+
+				ft::vector<U>			partials(units.size(), init);
+				rb_reduce_task_<U, Op>	task = { &units, &next, &partials, op };
+
+				ft::parallel_repeat(task, ( threads < units.size() ) ? threads : units.size());
+				for ( size_type index = 0 ; index < partials.size() ; index++ ){
+					result = op(result, partials[index]);
+				}
+				return result;
+			}
+
+			/**
+			 * Range aggregation
+			 * 
+			 * With an Augment policy (see rb_augmented_node), every node keeps the summary
+			 * of its subtree up to date through insertions, erasures, rotations, splits,
+			 * joins and rebuilds. aggregate(lo, hi) combines, in key order, the elements
+			 * whose key lies in [lo, hi), and aggregate() all of them. Both take O(log n):
+			 * below the highest node of the range, each step on the way to lo adds a node
+			 * and its right subtree whole, and each step on the way to hi a node and its
+			 * left subtree.
+			 * 
+			 * Summaries follow the elements, not their mapped values: after changing a mapped
+			 * value in place, through operator[] or an iterator, the summaries above it are
+			 * stale until refresh is called on its position.
+			 */
+			summary_type aggregate(const key_type &lo, const key_type &hi) const {
+				augment_type	augment;
+				summary_type	left = augment.identity();
+				summary_type	right = augment.identity();
+				node_pointer	x = m_root;
+				node_pointer	y;
+
+				while ( x != NULL && !x->is_sentinel() ){
+					if ( m_comp(x->data.first, lo) )
+						x = x->right;
+					else if ( !m_comp(x->data.first, hi) )
+						x = x->left;
+					else
+						break ;
+				}
+				if ( x == NULL || x->is_sentinel() )
+					return left;
+				for ( y = x->left ; y != NULL && !y->is_sentinel() ; ){
+					if ( m_comp(y->data.first, lo) ){
+						y = y->right;
+					} else {
+						left = augment.combine(augment.combine(augment.lift(y->data), node_type::summary_of(y->right)), left);
+						y = y->left;
+					}
 				}
+				for ( y = x->right ; y != NULL && !y->is_sentinel() ; ){
+					if ( m_comp(y->data.first, hi) ){
+						right = augment.combine(right, augment.combine(node_type::summary_of(y->left), augment.lift(y->data)));
+						y = y->right;
+					} else {
+						y = y->left;
+					}
+				}
+				return augment.combine(augment.combine(left, augment.lift(x->data)), right);
+			}
+
+			summary_type aggregate() const {
+				return node_type::summary_of(m_root);
+			}
+
+			void refresh(iterator position){
+				if ( position != this->end() )
+					this->rb_pull_path_(position.m_ptr);
+			}
+
+			/**
+			 * Split container
+			 * 
+			 * Moves the elements with a key going before k into left, and the other ones into
+			 * right, replacing their former content. The container is left empty, unless it is
+			 * one of left or right.
+			 * 
+			 * Nodes are relinked, not copied: the tree is cut in O(log n) along the path of k,
+			 * and both sides are rebalanced by joins using their black heights. Finding the
+			 * size of both sides walks the smaller one, in O(min(left.size(), right.size())).
+			 */
+			void split(const key_type &k, map &left, map &right){
+				key_type		key( k );
+				size_type		size = m_size;
+				size_type		left_size;
+				node_pointer	root = m_root;
+				node_pointer	l;
+				node_pointer	mid;
+				node_pointer	r;
+				int				lbh;
+				int				rbh;
+
+				this->rb_detach_sentinels_();
+				m_root = NULL;
+				m_size = 0;
+				left.clear();
+				right.clear();
+				rb_split_(root, rb_rank_(root), key, m_comp, l, lbh, mid, r, rbh);
+				if ( mid != NULL )
+					r = rb_join_(NULL, 0, mid, r, rbh, rbh);
+				left_size = rb_count_first_(l, r, size);
+				left.m_comp = m_comp;
+				left.rb_adopt_(l, left_size);
+				right.m_comp = m_comp;
+				right.rb_adopt_(r, size - left_size);
+			}
+
+			/**
+			 * Join containers
+			 * 
+			 * Replaces the content of the container by the elements of left followed by the
+			 * elements of right, leaving both empty. Every key of left must go before every
+			 * key of right.
+			 * 
+			 * Nodes are relinked, not copied: the shorter tree is hung on the spine of the
+			 * taller one at the same black height, in O(log n).
+			 */
+			void join(map &left, map &right){
+				node_pointer	l = left.rb_release_();
+				node_pointer	r = right.rb_release_();
+				size_type		size = left.m_size + right.m_size;
+				int				bh;
+
+				left.m_size = 0;
+				right.m_size = 0;
+				this->clear();
+				l = rb_join2_(l, rb_rank_(l), r, rb_rank_(r), m_comp, bh);
+				this->rb_adopt_(l, size);
+			}
+
+			/**
+			 * Set operations
+			 * 
+			 * Replace the content of the container by its union, intersection or difference
+			 * with other, leaving other empty. Between elements with equivalent keys, the one
+			 * of the container is kept and the one of other is destroyed.
+			 * 
+			 * Nodes are relinked, not copied: the root of other splits the container, both
+			 * halves are combined recursively with the subtrees of other and joined back, in
+			 * O(m log(n / m + 1)) for m the size of the smaller side. Up to threads threads
+			 * share the work, the two halves of a split running on separate threads until
+			 * the budget is spent.
+			 */
+			void set_union(map &other, size_type threads = 1){
+				this->rb_set_operation_(other, RB_SET_UNION, threads);
+			}
+
+			void set_intersection(map &other, size_type threads = 1){
+				this->rb_set_operation_(other, RB_SET_INTERSECTION, threads);
+			}
+
+			void set_difference(map &other, size_type threads = 1){
+				this->rb_set_operation_(other, RB_SET_DIFFERENCE, threads);
 			}
 
 			/**
@@ -704,7 +2090,7 @@ namespace ft
 				allocator_type				tmp_alloc = x.m_alloc;
 				node_pointer				tmp_right_sentinel = x.m_right_sentinel;
 				node_pointer				tmp_left_sentinel = x.m_left_sentinel;
-				typename node_type::Compare tmp_is_null_node = x.m_is_null_node;
+				rb_node_pool<node_type>	*tmp_pool = x.m_pool;
 
 				x.m_root = this->m_root;
 				x.m_size = this->m_size;
@@ -712,7 +2098,7 @@ namespace ft
 				x.m_alloc = this->m_alloc;
 				x.m_right_sentinel = this->m_right_sentinel;
 				x.m_left_sentinel = this->m_left_sentinel;
-				x.m_is_null_node = this->m_is_null_node;
+				x.m_pool = this->m_pool;
 				
 				this->m_root = tmp_root;
 				this->m_size = tmp_size;
@@ -720,7 +2106,7 @@ namespace ft
 				this->m_alloc = tmp_alloc;
 				this->m_right_sentinel = tmp_right_sentinel;
 				this->m_left_sentinel = tmp_left_sentinel;
-				this->m_is_null_node = tmp_is_null_node;
+				this->m_pool = tmp_pool;
 			}
 
 			/**
@@ -899,9 +2285,10 @@ namespace ft
 			iterator upper_bound(const key_type &k){
 				node_pointer y = NULL;
 				node_pointer x = m_root;
+				prefix_type kp = key_prefix::of(k);
 
 				while ( x != NULL && !x->is_sentinel() ){
-					if ( m_comp(k, x->data.first) ){
+					if ( this->rb_key_less_(k, kp, x) ){
 						y = x;
 						x = x->left;
 					} else {
@@ -914,9 +2301,10 @@ namespace ft
 			const_iterator upper_bound(const key_type &k) const {
 				node_pointer y = NULL;
 				node_pointer x = m_root;
+				prefix_type kp = key_prefix::of(k);
 
 				while ( x != NULL && !x->is_sentinel() ){
-					if ( m_comp(k, x->data.first) ){
+					if ( this->rb_key_less_(k, kp, x) ){
 						y = x;
 						x = x->left;
 					} else {
@@ -940,9 +2328,10 @@ namespace ft
 			iterator lower_bound(const key_type &k){
 				node_pointer y = NULL;
 				node_pointer x = m_root;
+				prefix_type kp = key_prefix::of(k);
 
 				while ( x != NULL && !x->is_sentinel() ){
-					if ( !m_comp(x->data.first, k) ){
+					if ( !this->rb_key_less_(x, k, kp) ){
 						y = x;
 						x = x->left;
 					} else {
@@ -955,9 +2344,10 @@ namespace ft
 			const_iterator lower_bound(const key_type &k) const {
 				node_pointer y = NULL;
 				node_pointer x = m_root;
+				prefix_type kp = key_prefix::of(k);
 
 				while ( x != NULL && !x->is_sentinel() ){
-					if ( !m_comp(x->data.first, k) ){
+					if ( !this->rb_key_less_(x, k, kp) ){
 						y = x;
 						x = x->left;
 					} else {
@@ -967,6 +2357,36 @@ namespace ft
 				return (y == NULL) ? this->end() : const_iterator(y);
 			}
 
+			/**
+			 * Batched lookups
+			 * 
+			 * Write to out, for each key of the range [first,last) in order, the result of
+			 * map::find or map::lower_bound for that key, and return out past the last one.
+			 * 
+			 * Up to BATCH_LANES descents run interleaved, each going down one level per round
+			 * and prefetching its next node, so that the cache misses of different keys
+			 * overlap instead of following each other. Pays off on trees larger than the cache.
+			 */
+			template<class ForwardIterator, class OutputIterator>
+			OutputIterator find_batch(ForwardIterator first, ForwardIterator last, OutputIterator out){
+				return this->rb_batch_<iterator>(first, last, out, true);
+			}
+
+			template<class ForwardIterator, class OutputIterator>
+			OutputIterator find_batch(ForwardIterator first, ForwardIterator last, OutputIterator out) const {
+				return this->rb_batch_<const_iterator>(first, last, out, true);
+			}
+
+			template<class ForwardIterator, class OutputIterator>
+			OutputIterator lower_bound_batch(ForwardIterator first, ForwardIterator last, OutputIterator out){
+				return this->rb_batch_<iterator>(first, last, out, false);
+			}
+
+			template<class ForwardIterator, class OutputIterator>
+			OutputIterator lower_bound_batch(ForwardIterator first, ForwardIterator last, OutputIterator out) const {
+				return this->rb_batch_<const_iterator>(first, last, out, false);
+			}
+
 			/**
 			 * Get range of equal elements
 			 * 
@@ -981,11 +2401,21 @@ namespace ft
 			 * (i.e., no matter the order in which the keys are passed as arguments).
 			 */
 			ft::pair<iterator, iterator> equal_range(const key_type& k) {
-				return ft::pair<iterator, iterator>( this->lower_bound(k), this->upper_bound(k) );
+				rb_descent_ descent = this->rb_descend_( k );
+
+				return ft::pair<iterator, iterator>(
+					( descent.lower == NULL ) ? this->end() : iterator( descent.lower ),
+					( descent.upper == NULL ) ? this->end() : iterator( descent.upper )
+				);
 			}
 
 			ft::pair<const_iterator, const_iterator> equal_range(const key_type& k) const {
-				return ft::pair<const_iterator, const_iterator>( this->lower_bound(k), this->upper_bound(k) );
+				rb_descent_ descent = this->rb_descend_( k );
+
+				return ft::pair<const_iterator, const_iterator>(
+					( descent.lower == NULL ) ? this->end() : const_iterator( descent.lower ),
+					( descent.upper == NULL ) ? this->end() : const_iterator( descent.upper )
+				);
 			}
 
 			/**
@@ -1053,200 +2483,487 @@ namespace ft
 		 */
 		private:
 			/**
+			 * Interleaved descents for up to BATCH_LANES keys at a time, the lower bound of
+			 * each being written to out as an Iterator, or end() when exact and the bound
+			 * does not match the key.
+			 */
+			template<class Iterator, class ForwardIterator, class OutputIterator>
+			OutputIterator rb_batch_(ForwardIterator first, ForwardIterator last, OutputIterator out, bool exact) const {
+				ForwardIterator	keys[BATCH_LANES];
+				node_pointer	nodes[BATCH_LANES];
+				node_pointer	bounds[BATCH_LANES];
+				node_pointer	x;
+				size_type		count;
+				bool			active;
+
+				while ( first != last ){
+					for ( count = 0 ; count < BATCH_LANES && first != last ; count++, ++first ){
+						keys[count] = first;
+						nodes[count] = m_root;
+						bounds[count] = NULL;
+					}
+					active = m_root != NULL;
+					while ( active ){
+						active = false;
+						for ( size_type lane = 0 ; lane < count ; lane++ ){
+							if ( ( x = nodes[lane] ) == NULL )
+								continue ;
+							if ( m_comp(x->data.first, *keys[lane]) ){
+								x = x->right;
+							} else {
+								bounds[lane] = x;
+								x = x->left;
+							}
+							if ( x != NULL && x->is_sentinel() )
+								x = NULL;
+							if ( x != NULL ){
+								FT_PREFETCH(x);
+								active = true;
+							}
+							nodes[lane] = x;
+						}
+					}
+					for ( size_type lane = 0 ; lane < count ; lane++ ){
+						x = bounds[lane];
+						if ( x == NULL || ( exact && m_comp(*keys[lane], x->data.first) ) )
+							*out++ = Iterator( m_right_sentinel );
+						else
+							*out++ = Iterator( x );
+					}
+				}
+				return out;
+			}
+
+			/**
+			 * Key comparisons of the descents, k with prefix kp against the key of x. They
+			 * are m_comp unless the nodes cache a prefix of their key, see rb_key_prefix.
+			 */
+			bool rb_key_less_(const key_type &k, const prefix_type &kp, node_pointer x) const {
+				return key_prefix::less(m_comp, k, kp, x->data.first, node_type::prefix_of(x));
+			}
+
+			bool rb_key_less_(node_pointer x, const key_type &k, const prefix_type &kp) const {
+				return key_prefix::less(m_comp, x->data.first, node_type::prefix_of(x), k, kp);
+			}
+
+			/**
+			 * Finger search
 			 * 
-			 * Insert recursive
-			 * 
-			 * Insert a node recursively. It returns a pair with an iterator
-			 * pointing to the node newly inserted.
+			 * insert_check for k starting from finger instead of the root. Climbs while the
+			 * subtree of the current node cannot hold k, that is up to the first ancestor
+			 * reached from its left for a key going after finger, or from its right for a key
+			 * going before it, then goes down. Costs O(log d) for d elements between both keys.
 			 * 
 			 */
-			ft::pair<iterator, bool> insert_recursive_(node_pointer current, const value_type &val){
-				if ( this->is_equal_key_(val.first, current->data.first) ){
-					return ft::pair<iterator, bool>( iterator( current ), false );
+			insert_handle rb_finger_check_(node_pointer finger, const key_type &k){
+				node_pointer	x = finger;
+				insert_handle	handle;
+				prefix_type		kp = key_prefix::of(k);
+				bool			after = this->rb_key_less_(x, k, kp);
+
+				if ( !after && !this->rb_key_less_(k, kp, x) ){
+					handle.m_found = true;
+					handle.m_left = false;
+					handle.m_node = x;
+					return handle;
 				}
-				if ( m_comp( val.first, current->data.first ) ){
-					if ( current->left == NULL ){
-						return ft::pair<iterator, bool>( iterator( current->left = node_type::create_node( val, current ) ), true );
-					} 
-					else if ( current->left->is_sentinel() ){
-						node_pointer node = node_type::create_node( val, current );
-
-						current->left = node;
-						node->set_left(m_left_sentinel);
-						return ft::pair<iterator, bool>( iterator( node ), true );
+				for ( ; x->parent != NULL ; x = x->parent ){
+					if ( after && x == x->parent->left && this->rb_key_less_(k, kp, x->parent) )
+						break ;
+					if ( !after && x == x->parent->right && this->rb_key_less_(x->parent, k, kp) )
+						break ;
+				}
+				handle.m_found = false;
+				while ( true ){
+					handle.m_node = x;
+					if ( this->rb_key_less_(k, kp, x) ){
+						handle.m_left = true;
+						x = x->left;
+					} else if ( this->rb_key_less_(x, k, kp) ){
+						handle.m_left = false;
+						x = x->right;
 					} else {
-						return insert_recursive_(current->left, val);
+						handle.m_found = true;
+						return handle;
 					}
-				} else {
-					if ( current->right == NULL ){
-						return ft::pair<iterator, bool>( iterator( current->right = node_type::create_node( val, current ) ), true );
-					} else if ( current->right->is_sentinel() ){
-						node_pointer node = node_type::create_node( val, current );
+					if ( x == NULL || x->is_sentinel() )
+						return handle;
+				}
+			}
 
-						current->right = node;
-						node->set_right(m_right_sentinel);
-						return ft::pair<iterator, bool>( iterator( node ), true );
+			/**
+			 * Fused descent
+			 * 
+			 * Walks once from the root towards k. Every node whose key goes after k is a
+			 * candidate for both bounds; once a node with an equivalent key is met, the
+			 * upper bound is finished by following the left spine of its right subtree.
+			 * 
+			 */
+			rb_descent_ rb_descend_(const key_type &k) const {
+				rb_descent_		ret;
+				node_pointer	x = m_root;
+				prefix_type		kp = key_prefix::of(k);
+
+				ret.lower = NULL;
+				ret.upper = NULL;
+				ret.parent = NULL;
+				ret.left = false;
+				ret.found = false;
+				while ( x != NULL && !x->is_sentinel() ){
+					ret.parent = x;
+					if ( this->rb_key_less_(k, kp, x) ){
+						ret.lower = x;
+						ret.upper = x;
+						ret.left = true;
+						x = x->left;
+					} else if ( this->rb_key_less_(x, k, kp) ){
+						ret.left = false;
+						x = x->right;
 					} else {
-						return insert_recursive_(current->right, val);
+						ret.lower = x;
+						ret.found = true;
+						for ( x = x->right ; x != NULL && !x->is_sentinel() ; x = x->left ){
+							ret.upper = x;
+						}
+						break ;
 					}
 				}
+				return ret;
 			}
 
-			void clear_recursive_(node_pointer current){
-				if ( current != NULL && !current->is_sentinel() && !m_is_null_node(current) ){
-					clear_recursive_(current->left);
-					clear_recursive_(current->right);
-					node_type::destroy_node(current);
+			/**
+			 * Link node
+			 * 
+			 * Hangs a lone node at the position recorded by handle, moving a sentinel under
+			 * it when it becomes the leftmost or rightmost node, then rebalances.
+			 * 
+			 */
+			iterator rb_link_node_(const insert_handle &handle, node_pointer node){
+				node_pointer parent = handle.m_node;
+
+				node->parent = parent;
+				node->height = 1;
+				m_size++;
+				if ( parent == NULL ){
+					m_root = node;
+					m_root->color = RB_COLOR_BLACK;
+					m_root->set_right(m_right_sentinel);
+					m_root->set_left(m_left_sentinel);
+					rb_update_(m_root);
+					return iterator( m_root );
+				}
+				if ( handle.m_left ){
+					if ( parent->left != NULL )
+						node->set_left(m_left_sentinel);
+					parent->left = node;
+				} else {
+					if ( parent->right != NULL )
+						node->set_right(m_right_sentinel);
+					parent->right = node;
+				}
+				this->rb_pull_path_(node);
+				if ( balance_type::avl )
+					this->rb_avl_retrace_(parent);
+				else
+					this->rb_insert_fix_tree_(node);
+				return iterator( node );
+			}
+
+			/**
+			 * Recomputes the summaries of x and of all its ancestors, bottom up. Rotations
+			 * keep the summaries of the nodes they move, so a node linked or unlinked only
+			 * needs its path pulled before the tree is rebalanced.
+			 */
+			void rb_pull_path_(node_pointer x){
+				if ( !node_type::augmented )
+					return ;
+				for ( ; x != NULL ; x = x->parent ){
+					node_type::pull(x);
 				}
 			}
 
-			ft::pair<node_pointer, int> detach_node_(node_pointer target){
-				node_pointer rightmost;
-				node_pointer successor = target->right;
-				ft::pair<node_pointer, int> ret;
+			/**
+			 * New node holding a copy of val, from the reserve when there is one left.
+			 */
+			node_pointer create_node_(const value_type &val){
+				node_pointer node = NULL;
 
-				// If the min node is a sentinel node, then take the left child
-				// and set the sentinel node to the rightmost subtree.
-				if ( successor->is_sentinel() ){
-					successor = target->left;
-					successor->parent = target->parent;
+				if ( m_pool != NULL )
+					node = m_pool->take(val);
+				return ( node != NULL ) ? node : node_type::create_node(val);
+			}
 
-					rightmost = successor;
-					// Go to the right most node and set right sentinel
-					while ( rightmost->right != NULL ){
-						rightmost = rightmost->right;
-					}
-					// Not sure ?
-					ret.first = successor;
-					ret.second = target->color;
-					rightmost->set_right(m_right_sentinel);
+			/**
+			 * Copies the detached subtree old to new nodes taken in key order and returns
+			 * the new root, old being left as is. If a copy throws, the new nodes are
+			 * destroyed.
+			 */
+			node_pointer rb_compact_(node_pointer old){
+				node_pointer left;
+				node_pointer node;
+
+				if ( old == NULL )
+					return NULL;
+				left = this->rb_compact_(old->left);
+				try {
+					node = this->create_node_(old->data);
+				} catch ( ... ){
+					this->clear_recursive_(left);
+					throw ;
+				}
+				node->color = old->color;
+				node->left = left;
+				if ( left != NULL )
+					left->parent = node;
+				try {
+					node->right = this->rb_compact_(old->right);
+				} catch ( ... ){
+					this->clear_recursive_(node);
+					throw ;
+				}
+				if ( node->right != NULL )
+					node->right->parent = node;
+				rb_update_(node);
+				return node;
+			}
+
+			/**
+			 * Calls f on the elements of the subtree x in key order, sentinels excluded.
+			 */
+			template<class Function>
+			static void rb_visit_(node_pointer x, Function &f){
+				while ( x != NULL && !x->is_sentinel() ){
+					rb_visit_(x->left, f);
+					f(x->data);
+					x = x->right;
+				}
+			}
+
+			/**
+			 * Depth of the cut giving about PARALLEL_UNITS subtrees per thread.
+			 */
+			static size_type rb_unit_depth_(size_type threads){
+				size_type depth = 0;
+
+				while ( ( static_cast<size_type>( 1 ) << depth ) < threads * PARALLEL_UNITS ){
+					depth++;
+				}
+				return depth;
+			}
+
+			/**
+			 * Appends to units, in key order, the subtrees at depth cut below x and the
+			 * nodes above them.
+			 */
+			void rb_collect_units_(node_pointer x, size_type depth, size_type cut, ft::vector<rb_unit_> &units) const {
+				rb_unit_ unit;
+
+				if ( x == NULL || x->is_sentinel() )
+					return ;
+				unit.node = x;
+				unit.subtree = ( depth == cut );
+				if ( unit.subtree ){
+					units.push_back(unit);
+					return ;
+				}
+				this->rb_collect_units_(x->left, depth + 1, cut, units);
+				units.push_back(unit);
+				this->rb_collect_units_(x->right, depth + 1, cut, units);
+			}
+
+			size_type clear_recursive_(node_pointer current){
+				size_type count = 0;
+
+				if ( current != NULL && !current->is_sentinel() ){
+					count += clear_recursive_(current->left);
+					count += clear_recursive_(current->right);
+					node_type::destroy_node(current);
+					count++;
+				}
+				return count;
+			}
+
+			/**
+			 * Unlink node
+			 * 
+			 * Removes z from the tree without destroying it, and restores the red black
+			 * properties. The sentinels are taken off the tree while it is rebalanced so
+			 * that every leaf is NULL, then hung back under the new leftmost and rightmost
+			 * nodes. On return z is a lone red node that can be linked again.
+			 * 
+			 */
+			void rb_unlink_node_(node_pointer z){
+				node_pointer leftmost = m_left_sentinel->parent;
+				node_pointer rightmost = m_right_sentinel->parent;
+				node_pointer y = z;
+				node_pointer x;
+				node_pointer x_parent;
+				int color;
+
+				if ( z == leftmost )
+					leftmost = ( z == rightmost ) ? NULL : _rb_tree_increment(z);
+				if ( z == rightmost )
+					rightmost = ( leftmost == NULL ) ? NULL : _rb_tree_decrement(z);
+				m_left_sentinel->parent->left = NULL;
+				m_right_sentinel->parent->right = NULL;
+
+				if ( z->left == NULL ){
+					x = z->right;
+				} else if ( z->right == NULL ){
+					x = z->left;
 				} else {
-					// Find the left most child
-					while ( successor->left != NULL && !successor->left->is_sentinel() ){
-						successor = successor->left;
-					}
-					// HERE ?
-					ret.first = successor->right;
-					ret.second = successor->color;
-					if ( successor->parent == target ){
-						successor->parent = target->parent;
-						successor->set_left(target->left);
-						ret.first = successor;
-					} else {
-						// If successor node has a child, then set the successor parent
-						// set this node as his new left child, otherwise, it is set to NULL.
-						if ( successor->right != NULL ){
-							// Successor has child
-							successor->parent->set_left(successor->right);
-						} else {
-							// Successor is a leaf
-							// Set to m_null ?
-							// successor->parent->left = NULL;
-							successor->parent->left = m_null;
-							m_null->parent = successor->parent;
-							ret.first = m_null;
-						}
-						successor->assign( target );
-					}
-					successor->color = target->color;
+					y = z->right;
+					while ( y->left != NULL )
+						y = y->left;
+					x = y->right;
 				}
-				// Set the parent to point to the new successor, otherwise root is set to NULL.
-				if ( target->parent != NULL ){
-					if ( target->is_left() ){
-						target->parent->set_left(successor);
+				if ( y != z ){
+					// Two children, y is the successor of z and takes its place
+					y->set_left(z->left);
+					if ( y != z->right ){
+						x_parent = y->parent;
+						if ( x != NULL )
+							x->parent = y->parent;
+						y->parent->left = x;
+						y->set_right(z->right);
 					} else {
-						target->parent->set_right(successor);
+						x_parent = y;
 					}
+					this->rb_replace_child_(z, y);
+					color = y->color;
+					y->color = z->color;
+					z->color = color;
+					color = y->height;
+					y->height = z->height;
+					z->height = color;
+				} else {
+					x_parent = z->parent;
+					if ( x != NULL )
+						x->parent = z->parent;
+					this->rb_replace_child_(z, x);
 				}
-				else {
-					m_root = successor;
+				this->rb_pull_path_(x_parent);
+				// z now holds the color of the node that really left the tree
+				if ( balance_type::avl )
+					this->rb_avl_retrace_(x_parent);
+				else if ( z->color != RB_COLOR_RED )
+					this->rb_erase_fix_(x, x_parent);
+
+				if ( m_root != NULL ){
+					leftmost->set_left(m_left_sentinel);
+					rightmost->set_right(m_right_sentinel);
 				}
-				return ret;
+				z->parent = NULL;
+				z->left = NULL;
+				z->right = NULL;
+				z->color = RB_COLOR_RED;
+				z->height = 1;
+				m_size--;
+			}
+
+			/**
+			 * Replace child
+			 * 
+			 * Makes the parent of node point to replacement instead, or makes replacement the
+			 * new root. The parent pointer of replacement is left to the caller.
+			 * 
+			 */
+			void rb_replace_child_(node_pointer node, node_pointer replacement){
+				if ( node->parent == NULL ){
+					m_root = replacement;
+				} else if ( node->is_left() ){
+					node->parent->left = replacement;
+				} else {
+					node->parent->right = replacement;
+				}
+				if ( replacement != NULL )
+					replacement->parent = node->parent;
 			}
 
-			void rb_erase_fix_(node_pointer x){
+			/**
+			 * Erase fix-up
+			 * 
+			 * x carries an extra black after a black node left the tree, it may be NULL
+			 * in which case x_parent tells where it sits. The extra black is pushed up
+			 * until it meets a red node or the root, or is absorbed by rotations.
+			 * 
+			 */
+			void rb_erase_fix_(node_pointer x, node_pointer x_parent){
 				node_pointer s;
 
-				while ( x != m_root && (x->color == RB_COLOR_BLACK || x->color == RB_COLOR_SENTINEL) ){
-					if ( x->is_left() ){
-						s = x->parent->right;
-						if (s->color == RB_COLOR_RED){
+				while ( x != m_root && ( x == NULL || x->color == RB_COLOR_BLACK ) ){
+					if ( x == x_parent->left ){
+						s = x_parent->right;
+						if ( s->color == RB_COLOR_RED ){
 							// Case 3.1
 							s->color = RB_COLOR_BLACK;
-							x->parent->color = RB_COLOR_RED;
-							rb_rotate_left_(x->parent);
-							s = x->parent->right;
+							x_parent->color = RB_COLOR_RED;
+							rb_rotate_left_(x_parent);
+							s = x_parent->right;
 						}
-						if (
-                                ( s->left == NULL || s->left->color == RB_COLOR_BLACK || s->is_sentinel() ) &&
-                                ( s->right == NULL || s->right->color == RB_COLOR_BLACK || s->is_sentinel() ) ){
+						if ( !is_red_(s->left) && !is_red_(s->right) ){
 							// Case 3.2
 							s->color = RB_COLOR_RED;
-							x = x->parent;
-						}
-						else {
-							if ( s->right->color == RB_COLOR_BLACK ){
+							x = x_parent;
+							x_parent = x_parent->parent;
+						} else {
+							if ( !is_red_(s->right) ){
 								// Case 3.3
 								s->left->color = RB_COLOR_BLACK;
 								s->color = RB_COLOR_RED;
 								rb_rotate_right_(s);
-								s = x->parent->right;
+								s = x_parent->right;
 							}
 							// Case 3.4
-							s->color = x->parent->color;
-							x->parent->color = RB_COLOR_BLACK;
-							if ( !s->right->is_sentinel() )
+							s->color = x_parent->color;
+							x_parent->color = RB_COLOR_BLACK;
+							if ( s->right != NULL )
 								s->right->color = RB_COLOR_BLACK;
-							rb_rotate_left_(x->parent);
-							x = m_root;
+							rb_rotate_left_(x_parent);
+							break ;
 						}
 					} else {
-						s = x->parent->left;
-						
-						if (s->color == RB_COLOR_RED){
+						s = x_parent->left;
+						if ( s->color == RB_COLOR_RED ){
 							// Case 3.1
 							s->color = RB_COLOR_BLACK;
-							x->parent->color = RB_COLOR_RED;
-							rb_rotate_right_(x->parent);
-							s = x->parent->left;
+							x_parent->color = RB_COLOR_RED;
+							rb_rotate_right_(x_parent);
+							s = x_parent->left;
 						}
-
-						if ( 
-							( s->left == NULL || s->left->color == RB_COLOR_BLACK || s->left->is_sentinel() ) &&
-							( s->right == NULL || s->right->color == RB_COLOR_BLACK || s->right->is_sentinel() ) ){
+						if ( !is_red_(s->left) && !is_red_(s->right) ){
 							// Case 3.2
 							s->color = RB_COLOR_RED;
-							x = x->parent;
-						}
-						else {
-							if ( s->left->color == RB_COLOR_BLACK ){
+							x = x_parent;
+							x_parent = x_parent->parent;
+						} else {
+							if ( !is_red_(s->left) ){
 								// Case 3.3
 								s->right->color = RB_COLOR_BLACK;
 								s->color = RB_COLOR_RED;
 								rb_rotate_left_(s);
-								s = x->parent->left;
+								s = x_parent->left;
 							}
 							// Case 3.4
-							s->color = x->parent->color;
-							x->parent->color = RB_COLOR_BLACK;
-							if ( !s->left->is_sentinel() )
+							s->color = x_parent->color;
+							x_parent->color = RB_COLOR_BLACK;
+							if ( s->left != NULL )
 								s->left->color = RB_COLOR_BLACK;
-							rb_rotate_right_(x->parent);
-							x = m_root;
+							rb_rotate_right_(x_parent);
+							break ;
 						}
 					}
 				}
-				if ( !x->is_sentinel() ){
+				if ( x != NULL )
 					x->color = RB_COLOR_BLACK;
-				}
 			}
 
-			bool is_equal_key_(const key_type &a, const key_type &b){
-				return !m_comp(a, b) && !m_comp(b, a);
+			static bool is_red_(node_pointer node){
+				return node != NULL && node->color == RB_COLOR_RED;
 			}
 
-			bool is_equal_val_(const value_type &a, const value_type &b){
-				return !m_comp(a.first, b.first) && !m_comp(b.first, a.first);
+			bool is_equal_key_(const key_type &a, const key_type &b){
+				return !m_comp(a, b) && !m_comp(b, a);
 			}
 
 			/**
@@ -1305,35 +3022,6 @@ namespace ft
 				gp->color = RB_COLOR_RED;
 			}
 
-			void rb_replace_sentinels_(){
-				node_pointer leftmost = m_root;
-				node_pointer rightmost = m_root;
-
-				// Leftmost
-				node_pointer lp = m_left_sentinel->parent;
-
-				if ( lp != NULL ){
-					lp->left = NULL;
-				}
-
-				while ( leftmost->left != NULL )
-					leftmost = leftmost->left;
-
-				leftmost->set_left(m_left_sentinel);
-
-				// Rightmost
-				node_pointer rp = m_right_sentinel->parent;
-
-				if ( rp != NULL ){
-					rp->right = NULL;
-				}
-
-				while ( rightmost->right != NULL )
-					rightmost = rightmost->right;
-
-				rightmost->set_right(m_right_sentinel);
-			}
-
 			void rb_insert_fix_tree_(node_pointer node){
 				node_pointer uncle = node->uncle();
 
@@ -1350,7 +3038,6 @@ namespace ft
 					else {
 						rb_insert_case_4_(node);
 					}
-					rb_replace_sentinels_();
 				}
 			}
 
@@ -1372,6 +3059,8 @@ namespace ft
 				}
 				y->left = x;
 				x->parent = y;
+				rb_update_(x);
+				rb_update_(y);
 			}
 
 			void rb_rotate_right_(node_pointer y){
@@ -1392,6 +3081,665 @@ namespace ft
 				}
 				x->right = y;
 				y->parent = x;
+				rb_update_(y);
+				rb_update_(x);
+			}
+
+			/**
+			 * AVL rebalancing
+			 * 
+			 * Walks up from x, the parent of the node linked or unlinked, restoring heights
+			 * and rotating every node whose subtrees differ in height by two. The walk stops
+			 * at the first subtree whose height is unchanged, since nothing above it moved.
+			 * 
+			 */
+			void rb_avl_retrace_(node_pointer x){
+				node_pointer	top;
+				int				former;
+
+				for ( ; x != NULL ; x = top->parent ){
+					former = x->height;
+					top = this->rb_avl_balance_(x);
+					if ( top->height == former )
+						break ;
+				}
+			}
+
+			/**
+			 * Rebalances the subtree x, whose children are AVL trees, and returns its root.
+			 */
+			node_pointer rb_avl_balance_(node_pointer x){
+				int balance = rb_height_(x->left) - rb_height_(x->right);
+
+				if ( balance > 1 ){
+					if ( rb_height_(x->left->left) < rb_height_(x->left->right) )
+						this->rb_rotate_left_(x->left);
+					this->rb_rotate_right_(x);
+					return x->parent;
+				}
+				if ( balance < -1 ){
+					if ( rb_height_(x->right->right) < rb_height_(x->right->left) )
+						this->rb_rotate_right_(x->right);
+					this->rb_rotate_left_(x);
+					return x->parent;
+				}
+				rb_update_height_(x);
+				return x;
+			}
+
+			/**
+			 * Node bookkeeping
+			 * 
+			 * rb_update_ recomputes what a node keeps about its subtree, its height under
+			 * avl_balance and its summary under an Augment, once its children are final.
+			 * Sentinels and NULL leaves have height 0.
+			 * 
+			 */
+			static int rb_height_(node_pointer x){
+				return ( x == NULL || x->is_sentinel() ) ? 0 : x->height;
+			}
+
+			static void rb_update_height_(node_pointer x){
+				int left = rb_height_(x->left);
+				int right = rb_height_(x->right);
+
+				x->height = static_cast<unsigned char>( 1 + ( ( left < right ) ? right : left ) );
+			}
+
+			static void rb_update_(node_pointer x){
+				if ( balance_type::avl )
+					rb_update_height_(x);
+				node_type::pull(x);
+			}
+
+			/**
+			 * Sentinels
+			 * 
+			 * Takes the sentinels off the tree so that every leaf is NULL, and hangs them back
+			 * under the leftmost and rightmost nodes once the tree has been rebuilt.
+			 * 
+			 */
+			void rb_detach_sentinels_(){
+				if ( m_root != NULL ){
+					m_left_sentinel->parent->left = NULL;
+					m_right_sentinel->parent->right = NULL;
+				}
+			}
+
+			void rb_attach_sentinels_(){
+				node_pointer x;
+
+				if ( m_root == NULL )
+					return ;
+				for ( x = m_root ; x->left != NULL ; x = x->left ) ;
+				x->set_left(m_left_sentinel);
+				for ( x = m_root ; x->right != NULL ; x = x->right ) ;
+				x->set_right(m_right_sentinel);
+			}
+
+			/**
+			 * Tree ownership
+			 * 
+			 * rb_release_ hands the tree over as a detached subtree and empties the container,
+			 * except for its size which is left to the caller. rb_adopt_ takes a detached
+			 * subtree of size nodes as the new content of an empty container.
+			 * 
+			 */
+			node_pointer rb_release_(){
+				node_pointer root = m_root;
+
+				this->rb_detach_sentinels_();
+				m_root = NULL;
+				return root;
+			}
+
+			void rb_adopt_(node_pointer root, size_type size){
+				m_root = root;
+				m_size = size;
+				if ( m_root != NULL )
+					m_root->parent = NULL;
+				this->rb_attach_sentinels_();
+			}
+
+			/**
+			 * Size of a, where a and b are detached subtrees holding size nodes together.
+			 * Both are walked in lockstep until one is exhausted, the other size follows.
+			 */
+			static size_type rb_count_first_(node_pointer a, node_pointer b, size_type size){
+				ft::vector<node_pointer>	stack_a;
+				ft::vector<node_pointer>	stack_b;
+				size_type					count_a = 0;
+				size_type					count_b = 0;
+
+				if ( a != NULL )
+					stack_a.push_back(a);
+				if ( b != NULL )
+					stack_b.push_back(b);
+				while ( true ){
+					if ( stack_a.empty() )
+						return count_a;
+					if ( stack_b.empty() )
+						return size - count_b;
+					rb_count_step_(stack_a, count_a);
+					rb_count_step_(stack_b, count_b);
+				}
+			}
+
+			static void rb_count_step_(ft::vector<node_pointer> &stack, size_type &count){
+				node_pointer node = stack.back();
+
+				stack.pop_back();
+				count++;
+				if ( node->left != NULL )
+					stack.push_back(node->left);
+				if ( node->right != NULL )
+					stack.push_back(node->right);
+			}
+
+			void rb_set_operation_(map &other, rb_set_op_ op, size_type threads){
+				size_type		size = m_size + other.m_size;
+				size_type		removed = 0;
+				node_pointer	t1;
+				node_pointer	t2;
+				int				bh;
+
+				if ( &other == this ){
+					if ( op == RB_SET_DIFFERENCE )
+						this->clear();
+					return ;
+				}
+				t1 = this->rb_release_();
+				t2 = other.rb_release_();
+				m_size = 0;
+				other.m_size = 0;
+				t1 = this->rb_set_(op, t1, rb_rank_(t1), t2, rb_rank_(t2), threads, bh, removed);
+				this->rb_adopt_(t1, size - removed);
+			}
+
+			/**
+			 * Set operation on detached subtrees
+			 * 
+			 * Splits t1 by the root of t2, combines the halves with the subtrees of t2, and
+			 * joins the results around the node kept for the key of the root, if any. Every
+			 * node destroyed is counted in removed, bh receives the black height of the result.
+			 * 
+			 */
+			node_pointer rb_set_(rb_set_op_ op, node_pointer t1, int bh1, node_pointer t2, int bh2,
+				size_type threads, int &bh, size_type &removed){
+				node_pointer	l1;
+				node_pointer	r1;
+				node_pointer	l2;
+				node_pointer	r2;
+				node_pointer	mid;
+				node_pointer	k;
+				int				l1bh;
+				int				r1bh;
+				int				l2bh = bh2 - 1;
+				int				r2bh = bh2 - 1;
+
+				if ( t2 == NULL ){
+					if ( op != RB_SET_INTERSECTION ){
+						bh = bh1;
+						return t1;
+					}
+					removed += clear_recursive_(t1);
+					bh = 0;
+					return NULL;
+				}
+				if ( t1 == NULL ){
+					if ( op == RB_SET_UNION ){
+						bh = bh2;
+						return t2;
+					}
+					removed += clear_recursive_(t2);
+					bh = 0;
+					return NULL;
+				}
+				l2 = rb_detach_root_(t2->left, l2bh);
+				r2 = rb_detach_root_(t2->right, r2bh);
+				rb_split_(t1, bh1, t2->data.first, m_comp, l1, l1bh, mid, r1, r1bh);
+
+				rb_set_task_ left = { this, op, l1, l1bh, l2, l2bh, threads / 2, NULL, 0, 0 };
+				rb_set_task_ right = { this, op, r1, r1bh, r2, r2bh, threads - threads / 2, NULL, 0, 0 };
+
+				if ( threads > 1 && bh2 >= PARALLEL_MIN_HEIGHT ){
+					ft::parallel_invoke(left, right);
+				} else {
+					left.threads = 1;
+					right.threads = 1;
+					left();
+					right();
+				}
+				removed += left.removed + right.removed;
+
+				k = NULL;
+				if ( mid != NULL ){
+					// The key of t2 is in t1 too, the node of t1 is the one kept
+					node_type::destroy_node(t2);
+					removed++;
+					if ( op != RB_SET_DIFFERENCE ){
+						k = mid;
+					} else {
+						node_type::destroy_node(mid);
+						removed++;
+					}
+				} else if ( op == RB_SET_UNION ){
+					k = t2;
+				} else {
+					node_type::destroy_node(t2);
+					removed++;
+				}
+				if ( k != NULL )
+					return rb_join_(left.result, left.bh, k, right.result, right.bh, bh);
+				return rb_join2_(left.result, left.bh, right.result, right.bh, m_comp, bh);
+			}
+
+			/**
+			 * Range erase
+			 * 
+			 * Cuts the tree around [first, last) with two splits, frees the middle subtree
+			 * as a whole and joins both sides back on the node of last, so only O(log n)
+			 * rebalancing is done whatever the size of the range.
+			 * 
+			 */
+			void rb_erase_range_(node_pointer first, node_pointer last){
+				node_pointer	left;
+				node_pointer	middle;
+				node_pointer	right;
+				node_pointer	mid;
+				int				bh;
+				int				lbh;
+				int				mbh;
+				int				rbh;
+
+				this->rb_detach_sentinels_();
+				rb_split_(m_root, rb_rank_(m_root), first->data.first, m_comp, left, lbh, mid, middle, mbh);
+				if ( last != m_right_sentinel ){
+					rb_split_(middle, mbh, last->data.first, m_comp, middle, mbh, mid, right, rbh);
+					m_root = rb_join_(left, lbh, last, right, rbh, bh);
+				} else {
+					m_root = left;
+				}
+				node_type::destroy_node(first);
+				m_size -= 1 + this->clear_recursive_(middle);
+				this->rb_attach_sentinels_();
+			}
+
+			/**
+			 * Join based algorithms
+			 * 
+			 * The functions below work on detached subtrees: NULL leaves, no sentinel, and a
+			 * black root whose black height is handed along so that no spine is walked twice.
+			 * They never touch the members of the map.
+			 * 
+			 * Under avl_balance the rank handed along as bh is the height of the subtree
+			 * instead, and roots keep their color. Only rb_rank_, rb_detach_root_ and rb_join_
+			 * depend on the policy, the algorithms built on them are shared.
+			 * 
+			 */
+			static int rb_rank_(node_pointer t){
+				int bh = 0;
+
+				if ( balance_type::avl )
+					return rb_height_(t);
+
+				for ( ; t != NULL ; t = t->left ){
+					if ( t->color == RB_COLOR_BLACK )
+						bh++;
+				}
+				return bh;
+			}
+
+			/**
+			 * Cuts t, a child subtree of black height bh, from its parent and blackens its root.
+			 */
+			static node_pointer rb_detach_root_(node_pointer t, int &bh){
+				if ( balance_type::avl ){
+					bh = rb_height_(t);
+					if ( t != NULL )
+						t->parent = NULL;
+					return t;
+				}
+				if ( t != NULL ){
+					t->parent = NULL;
+					if ( t->color == RB_COLOR_RED ){
+						t->color = RB_COLOR_BLACK;
+						bh++;
+					}
+				}
+				return t;
+			}
+
+			static node_pointer rb_make_node_(node_pointer left, node_pointer k, node_pointer right, int color){
+				k->parent = NULL;
+				k->left = left;
+				k->right = right;
+				k->color = color;
+				if ( left != NULL )
+					left->parent = k;
+				if ( right != NULL )
+					right->parent = k;
+				rb_update_(k);
+				return k;
+			}
+
+			static node_pointer rb_rotate_left_raw_(node_pointer x){
+				node_pointer y = x->right;
+
+				x->right = y->left;
+				if ( y->left != NULL )
+					y->left->parent = x;
+				y->parent = x->parent;
+				y->left = x;
+				x->parent = y;
+				rb_update_(x);
+				rb_update_(y);
+				return y;
+			}
+
+			static node_pointer rb_rotate_right_raw_(node_pointer y){
+				node_pointer x = y->left;
+
+				y->left = x->right;
+				if ( x->right != NULL )
+					x->right->parent = y;
+				x->parent = y->parent;
+				x->right = y;
+				y->parent = x;
+				rb_update_(y);
+				rb_update_(x);
+				return x;
+			}
+
+			/**
+			 * Walks down the right spine of t until a black node of the black height of r is
+			 * met, hangs k there with r as right child, and fixes red-red links on the way up.
+			 */
+			static node_pointer rb_join_right_(node_pointer t, int bh, node_pointer k, node_pointer r, int rbh){
+				node_pointer child;
+
+				if ( !is_red_(t) && bh == rbh )
+					return rb_make_node_(t, k, r, RB_COLOR_RED);
+				child = rb_join_right_(t->right, bh - ( t->color == RB_COLOR_BLACK ), k, r, rbh);
+				t->set_right(child);
+				rb_update_(t);
+				if ( t->color == RB_COLOR_BLACK && is_red_(child) && is_red_(child->right) ){
+					child->right->color = RB_COLOR_BLACK;
+					return rb_rotate_left_raw_(t);
+				}
+				return t;
+			}
+
+			static node_pointer rb_join_left_(node_pointer t, int bh, node_pointer k, node_pointer l, int lbh){
+				node_pointer child;
+
+				if ( !is_red_(t) && bh == lbh )
+					return rb_make_node_(l, k, t, RB_COLOR_RED);
+				child = rb_join_left_(t->left, bh - ( t->color == RB_COLOR_BLACK ), k, l, lbh);
+				t->set_left(child);
+				rb_update_(t);
+				if ( t->color == RB_COLOR_BLACK && is_red_(child) && is_red_(child->left) ){
+					child->left->color = RB_COLOR_BLACK;
+					return rb_rotate_right_raw_(t);
+				}
+				return t;
+			}
+
+			/**
+			 * AVL join: walks down the right spine of t to the first subtree at most one
+			 * level taller than r, hangs k there with r as right child, and rotates the
+			 * nodes left unbalanced on the way up.
+			 */
+			static node_pointer rb_avl_join_right_(node_pointer t, node_pointer k, node_pointer r){
+				node_pointer child;
+
+				if ( rb_height_(t->right) <= rb_height_(r) + 1 ){
+					child = rb_make_node_(t->right, k, r, RB_COLOR_BLACK);
+					if ( child->height > rb_height_(t->left) + 1 )
+						child = rb_rotate_right_raw_(child);
+				} else {
+					child = rb_avl_join_right_(t->right, k, r);
+				}
+				t->set_right(child);
+				rb_update_(t);
+				if ( child->height > rb_height_(t->left) + 1 )
+					return rb_rotate_left_raw_(t);
+				return t;
+			}
+
+			static node_pointer rb_avl_join_left_(node_pointer t, node_pointer k, node_pointer l){
+				node_pointer child;
+
+				if ( rb_height_(t->left) <= rb_height_(l) + 1 ){
+					child = rb_make_node_(l, k, t->left, RB_COLOR_BLACK);
+					if ( child->height > rb_height_(t->right) + 1 )
+						child = rb_rotate_left_raw_(child);
+				} else {
+					child = rb_avl_join_left_(t->left, k, l);
+				}
+				t->set_left(child);
+				rb_update_(t);
+				if ( child->height > rb_height_(t->right) + 1 )
+					return rb_rotate_right_raw_(t);
+				return t;
+			}
+
+			/**
+			 * Join
+			 * 
+			 * Builds a tree holding l, the lone node k and r, every key of l going before k and
+			 * every key of r after it. Runs in O(|lbh - rbh| + 1), bh receives the black height
+			 * of the result.
+			 * 
+			 */
+			static node_pointer rb_join_(node_pointer l, int lbh, node_pointer k, node_pointer r, int rbh, int &bh){
+				node_pointer t;
+
+				if ( balance_type::avl ){
+					if ( lbh > rbh + 1 )
+						t = rb_avl_join_right_(l, k, r);
+					else if ( rbh > lbh + 1 )
+						t = rb_avl_join_left_(r, k, l);
+					else
+						t = rb_make_node_(l, k, r, RB_COLOR_BLACK);
+					t->parent = NULL;
+					bh = t->height;
+					return t;
+				}
+				if ( lbh > rbh ){
+					t = rb_join_right_(l, lbh, k, r, rbh);
+					bh = lbh;
+				} else if ( rbh > lbh ){
+					t = rb_join_left_(r, rbh, k, l, lbh);
+					bh = rbh;
+				} else {
+					t = rb_make_node_(l, k, r, RB_COLOR_RED);
+					bh = lbh;
+				}
+				t->parent = NULL;
+				if ( t->color == RB_COLOR_RED ){
+					t->color = RB_COLOR_BLACK;
+					bh++;
+				}
+				return t;
+			}
+
+			/**
+			 * Join of l and r without a middle node, taken from the leftmost node of r instead.
+			 */
+			static node_pointer rb_join2_(node_pointer l, int lbh, node_pointer r, int rbh,
+				const key_compare &comp, int &bh){
+				node_pointer	min;
+				node_pointer	mid;
+				node_pointer	empty;
+				int				ebh;
+
+				if ( l == NULL || r == NULL ){
+					bh = ( l == NULL ) ? rbh : lbh;
+					return ( l == NULL ) ? r : l;
+				}
+				for ( min = r ; min->left != NULL ; min = min->left ) ;
+				rb_split_(r, rbh, min->data.first, comp, empty, ebh, mid, r, rbh);
+				return rb_join_(l, lbh, mid, r, rbh, bh);
+			}
+
+			/**
+			 * Balanced build
+			 * 
+			 * Links the count nodes of the sorted array nodes into a tree of minimal height,
+			 * splitting on the middle. Every level but the last one is full, so coloring the
+			 * nodes of the last level red, when it is incomplete, and every other one black
+			 * gives a valid red black tree. The returned root has no parent.
+			 * 
+			 */
+			static node_pointer rb_build_(node_pointer const *nodes, size_type count, size_type depth, size_type red_depth){
+				size_type		mid = count / 2;
+				node_pointer	root;
+
+				if ( count == 0 )
+					return NULL;
+				root = nodes[mid];
+				root->parent = NULL;
+				root->color = ( depth == red_depth ) ? RB_COLOR_RED : RB_COLOR_BLACK;
+				root->left = rb_build_(nodes, mid, depth + 1, red_depth);
+				root->right = rb_build_(nodes + mid + 1, count - mid - 1, depth + 1, red_depth);
+				if ( root->left != NULL )
+					root->left->parent = root;
+				if ( root->right != NULL )
+					root->right->parent = root;
+				rb_update_(root);
+				return root;
+			}
+
+			/**
+			 * rb_build_ with the two subtrees of a node built on separate threads, until
+			 * the threads budget is spent.
+			 */
+			static node_pointer rb_build_parallel_(node_pointer const *nodes, size_type count, size_type depth,
+				size_type red_depth, size_type threads){
+				size_type		mid = count / 2;
+				node_pointer	root;
+
+				if ( threads <= 1 || count < 2 )
+					return rb_build_(nodes, count, depth, red_depth);
+
+				rb_build_task_	left = { nodes, mid, depth + 1, red_depth, threads / 2, NULL };
+				rb_build_task_	right = { nodes + mid + 1, count - mid - 1, depth + 1, red_depth, threads - threads / 2, NULL };
+
+				ft::parallel_invoke(left, right);
+				root = nodes[mid];
+				root->parent = NULL;
+				root->color = ( depth == red_depth ) ? RB_COLOR_RED : RB_COLOR_BLACK;
+				root->left = left.result;
+				root->right = right.result;
+				if ( root->left != NULL )
+					root->left->parent = root;
+				if ( root->right != NULL )
+					root->right->parent = root;
+				rb_update_(root);
+				return root;
+			}
+
+			/**
+			 * Stable merge sort of count nodes by key, buffer holding as many pointers. Both
+			 * halves are sorted on separate threads until the threads budget is spent, and
+			 * are merged only if they overlap.
+			 */
+			static void rb_sort_nodes_(node_pointer *nodes, node_pointer *buffer, size_type count,
+				const key_compare &comp, size_type threads){
+				size_type		mid = count / 2;
+				node_pointer	*left = nodes;
+				node_pointer	*right = nodes + mid;
+				node_pointer	*out = buffer;
+
+				if ( count <= INSERTION_SORT_MAX ){
+					for ( size_type index = 1 ; index < count ; index++ ){
+						node_pointer	node = nodes[index];
+						size_type		hole = index;
+
+						for ( ; hole > 0 && comp(node->data.first, nodes[hole - 1]->data.first) ; hole-- ){
+							nodes[hole] = nodes[hole - 1];
+						}
+						nodes[hole] = node;
+					}
+					return ;
+				}
+
+				rb_sort_task_	first = { nodes, buffer, mid, &comp, threads / 2 };
+				rb_sort_task_	second = { nodes + mid, buffer + mid, count - mid, &comp, threads - threads / 2 };
+
+				if ( threads > 1 ){
+					ft::parallel_invoke(first, second);
+				} else {
+					first();
+					second();
+				}
+				if ( !comp(nodes[mid]->data.first, nodes[mid - 1]->data.first) )
+					return ;
+				while ( left != nodes + mid && right != nodes + count ){
+					if ( comp((*right)->data.first, (*left)->data.first) )
+						*out++ = *right++;
+					else
+						*out++ = *left++;
+				}
+				while ( left != nodes + mid ){
+					*out++ = *left++;
+				}
+				// What is left of the right half is already in place
+				for ( size_type index = 0 ; buffer + index != out ; index++ ){
+					nodes[index] = buffer[index];
+				}
+			}
+
+			/**
+			 * Depth of the last level of a balanced tree of count nodes, if it is incomplete.
+			 */
+			static size_type rb_red_depth_(size_type count){
+				size_type depth = 0;
+
+				while ( ( count + 1 ) >> ( depth + 1 ) )
+					depth++;
+				return depth;
+			}
+
+			/**
+			 * Split
+			 * 
+			 * Cuts t into l, holding the keys going before k, and r, holding the keys going
+			 * after it. The node with a key equivalent to k, if any, is returned alone in mid.
+			 * Runs in O(log n) as the black heights of the successive joins telescope.
+			 * 
+			 */
+			static void rb_split_(node_pointer t, int bh, const key_type &k, const key_compare &comp,
+				node_pointer &l, int &lbh, node_pointer &mid, node_pointer &r, int &rbh){
+				node_pointer	tl;
+				node_pointer	tr;
+				int				tlbh = bh - 1;
+				int				trbh = bh - 1;
+
+				if ( t == NULL ){
+					l = NULL;
+					r = NULL;
+					mid = NULL;
+					lbh = 0;
+					rbh = 0;
+					return ;
+				}
+				tl = rb_detach_root_(t->left, tlbh);
+				tr = rb_detach_root_(t->right, trbh);
+				if ( comp(k, t->data.first) ){
+					rb_split_(tl, tlbh, k, comp, l, lbh, mid, r, rbh);
+					r = rb_join_(r, rbh, t, tr, trbh, rbh);
+				} else if ( comp(t->data.first, k) ){
+					rb_split_(tr, trbh, k, comp, l, lbh, mid, r, rbh);
+					l = rb_join_(tl, tlbh, t, l, lbh, lbh);
+				} else {
+					l = tl;
+					lbh = tlbh;
+					r = tr;
+					rbh = trbh;
+					mid = rb_make_node_(NULL, t, NULL, RB_COLOR_RED);
+				}
 			}
 	};
 
@@ -1656,38 +4004,81 @@ namespace ft
 		_base_ptr m_ptr;
 	};
 
-	template<class Key, class T, class Compare, class Alloc>
-	void swap(map<Key, T, Compare, Alloc> &x, map<Key, T, Compare, Alloc> &y){
+	template<class Key, class T, class Compare, class Alloc, class Augment, class Balance>
+	void swap(map<Key, T, Compare, Alloc, Augment, Balance> &x, map<Key, T, Compare, Alloc, Augment, Balance> &y){
 		x.swap(y);
 	}
 
-	template <class Key, class T, class Compare, class Alloc>
-	bool operator==( const map<Key,T,Compare,Alloc>& x, const map<Key,T,Compare,Alloc>& y ){
+	template<class Key, class T, class Compare, class Alloc, class Augment, class Balance, class Predicate>
+	typename map<Key, T, Compare, Alloc, Augment, Balance>::size_type erase_if(map<Key, T, Compare, Alloc, Augment, Balance> &c, Predicate pred){
+		return c.erase_if(pred);
+	}
+
+	/**
+	 * Set operations
+	 * 
+	 * Leave in x its union, intersection or difference with y, and y empty. See
+	 * map::set_union, with threads bounding the number of threads used.
+	 * 
+	 */
+	template<class Key, class T, class Compare, class Alloc, class Augment, class Balance>
+	void map_union(map<Key, T, Compare, Alloc, Augment, Balance> &x, map<Key, T, Compare, Alloc, Augment, Balance> &y, std::size_t threads = 1){
+		x.set_union(y, threads);
+	}
+
+	template<class Key, class T, class Compare, class Alloc, class Augment, class Balance>
+	void map_intersection(map<Key, T, Compare, Alloc, Augment, Balance> &x, map<Key, T, Compare, Alloc, Augment, Balance> &y, std::size_t threads = 1){
+		x.set_intersection(y, threads);
+	}
+
+	template<class Key, class T, class Compare, class Alloc, class Augment, class Balance>
+	void map_difference(map<Key, T, Compare, Alloc, Augment, Balance> &x, map<Key, T, Compare, Alloc, Augment, Balance> &y, std::size_t threads = 1){
+		x.set_difference(y, threads);
+	}
+
+	/**
+	 * Parallel traversals
+	 * 
+	 * See map::parallel_for_each and map::parallel_reduce.
+	 * 
+	 */
+	template<class Key, class T, class Compare, class Alloc, class Augment, class Balance, class Function>
+	void parallel_for_each(map<Key, T, Compare, Alloc, Augment, Balance> &c, Function f, std::size_t threads = ft::hardware_concurrency()){
+		c.parallel_for_each(f, threads);
+	}
+
+	template<class Key, class T, class Compare, class Alloc, class Augment, class Balance, class U, class Op>
+	U parallel_reduce(const map<Key, T, Compare, Alloc, Augment, Balance> &c, U init, Op op, std::size_t threads = ft::hardware_concurrency()){
+		return c.parallel_reduce(init, op, threads);
+	}
+
+	template <class Key, class T, class Compare, class Alloc, class Augment, class Balance>
+	bool operator==( const map<Key,T,Compare,Alloc,Augment,Balance>& x, const map<Key,T,Compare,Alloc,Augment,Balance>& y ){
 		return x.size() == y.size() && equal(x.begin(), x.end(), y.begin(), y.end());
 	}
 
-	template <class Key, class T, class Compare, class Alloc>
-	bool operator!=( const map<Key,T,Compare,Alloc>& x, const map<Key,T,Compare,Alloc>& y ){
+	template <class Key, class T, class Compare, class Alloc, class Augment, class Balance>
+	bool operator!=( const map<Key,T,Compare,Alloc,Augment,Balance>& x, const map<Key,T,Compare,Alloc,Augment,Balance>& y ){
 		return !(x == y);
 	}
 
-	template <class Key, class T, class Compare, class Alloc>
-	bool operator< ( const map<Key,T,Compare,Alloc>& x, const map<Key,T,Compare,Alloc>& y ){
+	template <class Key, class T, class Compare, class Alloc, class Augment, class Balance>
+	bool operator< ( const map<Key,T,Compare,Alloc,Augment,Balance>& x, const map<Key,T,Compare,Alloc,Augment,Balance>& y ){
 		return lexicographical_compare(x.begin(), x.end(), y.begin(), y.end());
 	}
 
-	template <class Key, class T, class Compare, class Alloc>
-	bool operator<=( const map<Key,T,Compare,Alloc>& x, const map<Key,T,Compare,Alloc>& y ){
+	template <class Key, class T, class Compare, class Alloc, class Augment, class Balance>
+	bool operator<=( const map<Key,T,Compare,Alloc,Augment,Balance>& x, const map<Key,T,Compare,Alloc,Augment,Balance>& y ){
 		return !( y < x );
 	}
 
-	template <class Key, class T, class Compare, class Alloc>
-	bool operator> ( const map<Key,T,Compare,Alloc>& x, const map<Key,T,Compare,Alloc>& y ){
+	template <class Key, class T, class Compare, class Alloc, class Augment, class Balance>
+	bool operator> ( const map<Key,T,Compare,Alloc,Augment,Balance>& x, const map<Key,T,Compare,Alloc,Augment,Balance>& y ){
 		return y < x;
 	}
 
-	template <class Key, class T, class Compare, class Alloc>
-	bool operator>=( const map<Key,T,Compare,Alloc>& x, const map<Key,T,Compare,Alloc>& y ){
+	template <class Key, class T, class Compare, class Alloc, class Augment, class Balance>
+	bool operator>=( const map<Key,T,Compare,Alloc,Augment,Balance>& x, const map<Key,T,Compare,Alloc,Augment,Balance>& y ){
 		return !( x < y );
 	}
 }
@@ -0,0 +1,1041 @@
+#ifndef RADIX_MAP_HPP
+#define RADIX_MAP_HPP
+
+# include <cstring>
+# include "map.hpp"
+
+# if defined(__SSE2__) && defined(__GNUC__)
+#  include <emmintrin.h>
+#  define FT_RADIX_SSE2
+# endif
+
+namespace ft {
+	enum radix_node_type {
+		RADIX_LEAF,
+		RADIX_NODE4,
+		RADIX_NODE16,
+		RADIX_NODE48,
+		RADIX_NODE256
+	};
+
+	struct radix_node {
+		unsigned char type;
+
+		radix_node(unsigned char __type) : type( __type ) { }
+	};
+
+	/**
+	 * Inner nodes of a radix_map
+	 *
+	 * Every inner node holds the bytes all keys below it share from its depth on (path
+	 * compression), then branches on the next byte. The four kinds only differ by how
+	 * many children they fit and how they find them: sorted bytes for 4 and 16 of them,
+	 * a 256 byte index into 48 slots, or one slot per byte.
+	 *
+	 */
+	struct radix_inner : radix_node {
+		unsigned char	prefix_len;
+		unsigned short	count;
+		unsigned char	prefix[8];
+
+		radix_inner(unsigned char __type) : radix_node( __type ), prefix_len( 0 ), count( 0 ) { }
+	};
+
+	struct radix_node4 : radix_inner {
+		unsigned char	keys[4];
+		radix_node		*children[4];
+
+		radix_node4() : radix_inner( RADIX_NODE4 ){
+			for ( int i = 0 ; i < 4 ; i++ ){
+				keys[i] = 0;
+				children[i] = NULL;
+			}
+		}
+	};
+
+	struct radix_node16 : radix_inner {
+		unsigned char	keys[16];
+		radix_node		*children[16];
+
+		radix_node16() : radix_inner( RADIX_NODE16 ){
+			for ( int i = 0 ; i < 16 ; i++ ){
+				keys[i] = 0;
+				children[i] = NULL;
+			}
+		}
+	};
+
+	struct radix_node48 : radix_inner {
+		unsigned char	index[256];
+		radix_node		*children[48];
+
+		radix_node48() : radix_inner( RADIX_NODE48 ){
+			for ( int i = 0 ; i < 256 ; i++ ){
+				index[i] = 0;
+			}
+			for ( int i = 0 ; i < 48 ; i++ ){
+				children[i] = NULL;
+			}
+		}
+	};
+
+	struct radix_node256 : radix_inner {
+		radix_node *children[256];
+
+		radix_node256() : radix_inner( RADIX_NODE256 ){
+			for ( int i = 0 ; i < 256 ; i++ ){
+				children[i] = NULL;
+			}
+		}
+	};
+
+	/**
+	 * Leaves of a radix_map
+	 *
+	 * Hold a whole element, and are chained in key order so that iterators step from
+	 * one to the next without walking the tree. The map itself holds the head of the
+	 * chain, which is the end.
+	 *
+	 */
+	struct radix_link {
+		radix_link *prev;
+		radix_link *next;
+	};
+
+	template<class T>
+	struct radix_leaf : radix_node, radix_link {
+		T data;
+
+		radix_leaf(const T &__data) : radix_node( RADIX_LEAF ), data( __data ) { }
+	};
+
+	template<class T>
+	struct radix_iterator {
+		typedef T								value_type;
+		typedef T&								reference;
+		typedef T*								pointer;
+		typedef std::bidirectional_iterator_tag	iterator_category;
+		typedef std::ptrdiff_t					difference_type;
+		typedef radix_iterator<T>				_self;
+
+		radix_iterator() : m_ptr( NULL ) { }
+		radix_iterator(radix_link *ptr) : m_ptr( ptr ) { }
+
+		reference operator*() const { return static_cast<radix_leaf<T> *>( m_ptr )->data; }
+		pointer operator->() const { return &**this; }
+
+		_self &operator++(){ m_ptr = m_ptr->next; return *this; }
+		_self operator++(int){ _self tmp = *this; m_ptr = m_ptr->next; return tmp; }
+		_self &operator--(){ m_ptr = m_ptr->prev; return *this; }
+		_self operator--(int){ _self tmp = *this; m_ptr = m_ptr->prev; return tmp; }
+
+		bool operator==(const _self &it) const { return m_ptr == it.m_ptr; }
+		bool operator!=(const _self &it) const { return m_ptr != it.m_ptr; }
+
+		radix_link *m_ptr;
+	};
+
+	template<class T>
+	struct radix_const_iterator {
+		typedef T								value_type;
+		typedef const T&						reference;
+		typedef const T*						pointer;
+		typedef std::bidirectional_iterator_tag	iterator_category;
+		typedef std::ptrdiff_t					difference_type;
+		typedef radix_const_iterator<T>			_self;
+
+		radix_const_iterator() : m_ptr( NULL ) { }
+		radix_const_iterator(const radix_link *ptr) : m_ptr( ptr ) { }
+		radix_const_iterator(const radix_iterator<T> &it) : m_ptr( it.m_ptr ) { }
+
+		reference operator*() const { return static_cast<const radix_leaf<T> *>( m_ptr )->data; }
+		pointer operator->() const { return &**this; }
+
+		_self &operator++(){ m_ptr = m_ptr->next; return *this; }
+		_self operator++(int){ _self tmp = *this; m_ptr = m_ptr->next; return tmp; }
+		_self &operator--(){ m_ptr = m_ptr->prev; return *this; }
+		_self operator--(int){ _self tmp = *this; m_ptr = m_ptr->prev; return tmp; }
+
+		bool operator==(const _self &it) const { return m_ptr == it.m_ptr; }
+		bool operator!=(const _self &it) const { return m_ptr != it.m_ptr; }
+
+		const radix_link *m_ptr;
+	};
+
+	/**
+	 * Radix map
+	 *
+	 * Associative container with the interface of ft::map for unsigned integer keys of
+	 * up to 8 bytes, ordered by value. It is an adaptive radix tree: keys are split in
+	 * bytes, most significant first, and every level branches on one byte instead of
+	 * comparing whole keys. A lookup thus goes down at most sizeof(Key) inner nodes
+	 * whatever the size of the map, and fewer where keys are sparse since chains of
+	 * single children are folded into the prefix of the node below, and a leaf hangs
+	 * as high as the first byte telling its key apart.
+	 *
+	 * Nodes grow from 4 to 16, 48 then 256 children as they fill, and shrink back at
+	 * 3, 12 and 37 children. Insertions and erasures do not invalidate iterators to
+	 * other elements.
+	 *
+	 * Leaves and inner nodes are allocated with std::allocator, as the nodes of
+	 * ft::map are: Alloc is only kept for get_allocator.
+	 *
+	 */
+	template<
+		class Key,
+		class T,
+		class Alloc = std::allocator<ft::pair<const Key, T> >
+	>
+	class radix_map {
+		public:
+			typedef Key												key_type;
+			typedef T												mapped_type;
+			typedef ft::pair<const key_type, mapped_type>			value_type;
+			typedef std::less<Key>									key_compare;
+			typedef Alloc											allocator_type;
+			typedef typename allocator_type::reference				reference;
+			typedef typename allocator_type::const_reference		const_reference;
+			typedef typename allocator_type::pointer				pointer;
+			typedef typename allocator_type::const_pointer			const_pointer;
+			typedef std::ptrdiff_t									difference_type;
+			typedef std::size_t										size_type;
+			typedef radix_iterator<value_type>						iterator;
+			typedef radix_const_iterator<value_type>				const_iterator;
+			typedef ft::reverse_iterator<iterator>					reverse_iterator;
+			typedef ft::reverse_iterator<const_iterator>			const_reverse_iterator;
+
+			class value_compare : std::binary_function<value_type, value_type, bool> {
+				friend class radix_map;
+				protected:
+					key_compare m_comp;
+					value_compare(key_compare comp) : m_comp(comp) {}
+				public:
+					typedef bool result_type;
+					typedef value_type first_argument_type;
+					typedef value_type second_argument_type;
+					bool operator()(const value_type &x, const value_type &y) const {
+						return m_comp(x.first, y.first);
+					}
+			};
+
+		private:
+			typedef radix_leaf<value_type>							leaf_type;
+			typedef std::allocator<leaf_type>						leaf_allocator_type;
+
+			// Prefixes hold up to 8 bytes
+			typedef char key_size_check_[ ( sizeof(Key) <= 8 ) ? 1 : -1 ];
+
+			radix_node		*m_root;
+			radix_link		m_head;
+			size_type		m_size;
+			allocator_type	m_alloc;
+
+		public:
+			explicit radix_map( const key_compare &comp = key_compare(), const allocator_type &alloc = allocator_type() )
+				: m_root( NULL ), m_size( 0 ), m_alloc( alloc )
+			{
+				(void)comp;
+				m_head.prev = &m_head;
+				m_head.next = &m_head;
+			}
+
+			template<class InputIterator>
+			radix_map( InputIterator first, InputIterator last, const key_compare &comp = key_compare(),
+				const allocator_type &alloc = allocator_type() )
+				: m_root( NULL ), m_size( 0 ), m_alloc( alloc )
+			{
+				(void)comp;
+				m_head.prev = &m_head;
+				m_head.next = &m_head;
+				this->insert(first, last);
+			}
+
+			radix_map( const radix_map &x ) : m_root( NULL ), m_size( 0 ), m_alloc( x.m_alloc ){
+				m_head.prev = &m_head;
+				m_head.next = &m_head;
+				this->insert(x.begin(), x.end());
+			}
+
+			radix_map &operator=( const radix_map &x ){
+				if ( this == &x )
+					return *this;
+				this->clear();
+				this->insert(x.begin(), x.end());
+				return *this;
+			}
+
+			~radix_map(){
+				this->clear();
+			}
+
+			/**
+			 * Iterators
+			 */
+			iterator begin(){ return iterator( m_head.next ); }
+			const_iterator begin() const { return const_iterator( m_head.next ); }
+			iterator end(){ return iterator( &m_head ); }
+			const_iterator end() const { return const_iterator( &m_head ); }
+			reverse_iterator rbegin(){ return reverse_iterator( end() ); }
+			const_reverse_iterator rbegin() const { return const_reverse_iterator( end() ); }
+			reverse_iterator rend(){ return reverse_iterator( begin() ); }
+			const_reverse_iterator rend() const { return const_reverse_iterator( begin() ); }
+
+			/**
+			 * Capacity
+			 */
+			bool empty() const { return m_size == 0; }
+			size_type size() const { return m_size; }
+			size_type max_size() const { return leaf_allocator_type().max_size(); }
+
+			/**
+			 * Element access
+			 */
+			mapped_type &operator[]( const key_type &k ){
+				iterator it = this->find(k);
+
+				if ( it == this->end() )
+					it = this->insert( value_type( k, mapped_type() ) ).first;
+				return it->second;
+			}
+
+			/**
+			 * Modifiers
+			 *
+			 * The lower bound of the key tells whether it is already there, and which
+			 * leaf the new one goes before in the chain.
+			 */
+			ft::pair<iterator, bool> insert( const value_type &val ){
+				radix_node	*next = this->lower_(m_root, val.first, 0);
+				radix_link	*link = &m_head;
+				leaf_type	*leaf;
+				bool		constructed = false;
+
+				if ( next != NULL ){
+					link = static_cast<leaf_type *>( next );
+					if ( !( val.first < key_of_(next) ) )
+						return ft::make_pair(iterator( link ), false);
+				}
+				leaf = leaf_allocator_type().allocate(1);
+				try {
+					leaf_allocator_type().construct(leaf, leaf_type( val ));
+					constructed = true;
+					this->insert_(&m_root, leaf, 0);
+				} catch ( ... ){
+					if ( constructed )
+						leaf_allocator_type().destroy(leaf);
+					leaf_allocator_type().deallocate(leaf, 1);
+					throw ;
+				}
+				leaf->next = link;
+				leaf->prev = link->prev;
+				link->prev->next = leaf;
+				link->prev = leaf;
+				m_size++;
+				return ft::make_pair(iterator( leaf ), true);
+			}
+
+			iterator insert( iterator position, const value_type &val ){
+				(void)position;
+				return this->insert(val).first;
+			}
+
+			template<class InputIterator>
+			void insert( InputIterator first, InputIterator last ){
+				for ( ; first != last ; ++first ){
+					this->insert(*first);
+				}
+			}
+
+			void erase( iterator position ){
+				leaf_type *leaf = static_cast<leaf_type *>( position.m_ptr );
+
+				this->erase_(&m_root, leaf->data.first, 0);
+				leaf->prev->next = leaf->next;
+				leaf->next->prev = leaf->prev;
+				leaf_allocator_type().destroy(leaf);
+				leaf_allocator_type().deallocate(leaf, 1);
+				m_size--;
+			}
+
+			size_type erase( const key_type &k ){
+				iterator it = this->find(k);
+
+				if ( it == this->end() )
+					return 0;
+				this->erase(it);
+				return 1;
+			}
+
+			void erase( iterator first, iterator last ){
+				while ( first != last ){
+					this->erase(first++);
+				}
+			}
+
+			void swap( radix_map &x ){
+				radix_node		*root = m_root;
+				radix_link		head = m_head;
+				size_type		size = m_size;
+				allocator_type	alloc = m_alloc;
+
+				m_root = x.m_root;
+				m_head = x.m_head;
+				m_size = x.m_size;
+				m_alloc = x.m_alloc;
+				x.m_root = root;
+				x.m_head = head;
+				x.m_size = size;
+				x.m_alloc = alloc;
+				relink_(m_head, x.m_head);
+				relink_(x.m_head, m_head);
+			}
+
+			void clear(){
+				this->destroy_(m_root);
+				m_root = NULL;
+				m_head.prev = &m_head;
+				m_head.next = &m_head;
+				m_size = 0;
+			}
+
+			/**
+			 * Observers
+			 */
+			key_compare key_comp() const { return key_compare(); }
+			value_compare value_comp() const { return value_compare( key_compare() ); }
+			allocator_type get_allocator() const { return m_alloc; }
+
+			/**
+			 * Operations
+			 */
+			iterator find( const key_type &k ){
+				radix_node *leaf = this->find_(k);
+
+				return ( leaf == NULL ) ? this->end() : iterator( static_cast<leaf_type *>( leaf ) );
+			}
+
+			const_iterator find( const key_type &k ) const {
+				radix_node *leaf = this->find_(k);
+
+				return ( leaf == NULL ) ? this->end() : const_iterator( static_cast<leaf_type *>( leaf ) );
+			}
+
+			size_type count( const key_type &k ) const {
+				return ( this->find_(k) == NULL ) ? 0 : 1;
+			}
+
+			iterator lower_bound( const key_type &k ){
+				radix_node *leaf = this->lower_(m_root, k, 0);
+
+				return ( leaf == NULL ) ? this->end() : iterator( static_cast<leaf_type *>( leaf ) );
+			}
+
+			const_iterator lower_bound( const key_type &k ) const {
+				radix_node *leaf = this->lower_(m_root, k, 0);
+
+				return ( leaf == NULL ) ? this->end() : const_iterator( static_cast<leaf_type *>( leaf ) );
+			}
+
+			iterator upper_bound( const key_type &k ){
+				iterator it = this->lower_bound(k);
+
+				if ( it != this->end() && !( k < it->first ) )
+					++it;
+				return it;
+			}
+
+			const_iterator upper_bound( const key_type &k ) const {
+				const_iterator it = this->lower_bound(k);
+
+				if ( it != this->end() && !( k < it->first ) )
+					++it;
+				return it;
+			}
+
+			ft::pair<iterator, iterator> equal_range( const key_type &k ){
+				return ft::make_pair(this->lower_bound(k), this->upper_bound(k));
+			}
+
+			ft::pair<const_iterator, const_iterator> equal_range( const key_type &k ) const {
+				return ft::make_pair(this->lower_bound(k), this->upper_bound(k));
+			}
+
+		private:
+			/**
+			 * Byte of k at depth, the most significant one at depth 0.
+			 */
+			static unsigned char byte_( const key_type &k, size_type depth ){
+				return static_cast<unsigned char>( k >> ( 8 * ( sizeof(Key) - 1 - depth ) ) );
+			}
+
+			static const key_type &key_of_( const radix_node *leaf ){
+				return static_cast<const leaf_type *>( leaf )->data.first;
+			}
+
+			/**
+			 * After a swap, points the chain of head back at it, head still pointing to
+			 * the head of the other map when its chain is empty.
+			 */
+			static void relink_( radix_link &head, radix_link &other ){
+				if ( head.next == &other ){
+					head.prev = &head;
+					head.next = &head;
+				} else {
+					head.next->prev = &head;
+					head.prev->next = &head;
+				}
+			}
+
+			template<class Node>
+			static Node *create_(){
+				Node *node = std::allocator<Node>().allocate(1);
+
+				std::allocator<Node>().construct(node, Node());
+				return node;
+			}
+
+			template<class Node>
+			static void release_( Node *node ){
+				std::allocator<Node>().destroy(node);
+				std::allocator<Node>().deallocate(node, 1);
+			}
+
+			static void copy_header_( radix_inner *to, const radix_inner *from ){
+				to->prefix_len = from->prefix_len;
+				to->count = from->count;
+				std::memcpy(to->prefix, from->prefix, sizeof(to->prefix));
+			}
+
+			/**
+			 * Slot of the child of node for byte b, NULL if there is none. Node16 compares
+			 * b to its 16 bytes at once when SSE2 is available.
+			 */
+			static radix_node **find_child_( radix_inner *node, unsigned char b ){
+				switch ( node->type ){
+					case RADIX_NODE4: {
+						radix_node4 *n = static_cast<radix_node4 *>( node );
+
+						for ( unsigned short i = 0 ; i < n->count ; i++ ){
+							if ( n->keys[i] == b )
+								return &n->children[i];
+						}
+						return NULL;
+					}
+					case RADIX_NODE16: {
+						radix_node16 *n = static_cast<radix_node16 *>( node );
+# if defined(FT_RADIX_SSE2)
+						__m128i	keys = _mm_loadu_si128(reinterpret_cast<const __m128i *>( n->keys ));
+						int		mask = _mm_movemask_epi8(_mm_cmpeq_epi8(keys, _mm_set1_epi8( static_cast<char>( b ) )));
+
+						mask &= ( 1 << n->count ) - 1;
+						return ( mask != 0 ) ? &n->children[__builtin_ctz(mask)] : NULL;
+# else
+						for ( unsigned short i = 0 ; i < n->count ; i++ ){
+							if ( n->keys[i] == b )
+								return &n->children[i];
+						}
+						return NULL;
+# endif
+					}
+					case RADIX_NODE48: {
+						radix_node48 *n = static_cast<radix_node48 *>( node );
+
+						return ( n->index[b] != 0 ) ? &n->children[n->index[b] - 1] : NULL;
+					}
+					default: {
+						radix_node256 *n = static_cast<radix_node256 *>( node );
+
+						return ( n->children[b] != NULL ) ? &n->children[b] : NULL;
+					}
+				}
+			}
+
+			/**
+			 * Child of node for the least byte above b, NULL if there is none.
+			 */
+			static radix_node *next_child_( radix_inner *node, unsigned char b ){
+				switch ( node->type ){
+					case RADIX_NODE4: {
+						radix_node4 *n = static_cast<radix_node4 *>( node );
+
+						for ( unsigned short i = 0 ; i < n->count ; i++ ){
+							if ( n->keys[i] > b )
+								return n->children[i];
+						}
+						return NULL;
+					}
+					case RADIX_NODE16: {
+						radix_node16 *n = static_cast<radix_node16 *>( node );
+# if defined(FT_RADIX_SSE2)
+						// Signed compare of bytes flipped by 0x80 is the unsigned compare
+						const __m128i	flip = _mm_set1_epi8( static_cast<char>( 0x80 ) );
+						__m128i			keys = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i *>( n->keys )), flip);
+						__m128i			key = _mm_xor_si128(_mm_set1_epi8( static_cast<char>( b ) ), flip);
+						int				mask = _mm_movemask_epi8(_mm_cmpgt_epi8(keys, key));
+
+						mask &= ( 1 << n->count ) - 1;
+						return ( mask != 0 ) ? n->children[__builtin_ctz(mask)] : NULL;
+# else
+						for ( unsigned short i = 0 ; i < n->count ; i++ ){
+							if ( n->keys[i] > b )
+								return n->children[i];
+						}
+						return NULL;
+# endif
+					}
+					case RADIX_NODE48: {
+						radix_node48 *n = static_cast<radix_node48 *>( node );
+
+						for ( int i = b + 1 ; i < 256 ; i++ ){
+							if ( n->index[i] != 0 )
+								return n->children[n->index[i] - 1];
+						}
+						return NULL;
+					}
+					default: {
+						radix_node256 *n = static_cast<radix_node256 *>( node );
+
+						for ( int i = b + 1 ; i < 256 ; i++ ){
+							if ( n->children[i] != NULL )
+								return n->children[i];
+						}
+						return NULL;
+					}
+				}
+			}
+
+			static radix_node *min_leaf_( radix_node *node ){
+				while ( node->type != RADIX_LEAF ){
+					radix_inner *inner = static_cast<radix_inner *>( node );
+
+					if ( inner->type == RADIX_NODE4 )
+						node = static_cast<radix_node4 *>( inner )->children[0];
+					else if ( inner->type == RADIX_NODE16 )
+						node = static_cast<radix_node16 *>( inner )->children[0];
+					else if ( inner->type == RADIX_NODE48 ){
+						radix_node48 *n = static_cast<radix_node48 *>( inner );
+						int i = 0;
+
+						while ( n->index[i] == 0 )
+							i++;
+						node = n->children[n->index[i] - 1];
+					} else {
+						radix_node256 *n = static_cast<radix_node256 *>( inner );
+						int i = 0;
+
+						while ( n->children[i] == NULL )
+							i++;
+						node = n->children[i];
+					}
+				}
+				return node;
+			}
+
+			/**
+			 * Leaf of k, NULL if there is none. The prefixes are skipped rather than
+			 * compared on the way down: the leaf holds the whole key, which is compared
+			 * once at the end.
+			 */
+			radix_node *find_( const key_type &k ) const {
+				radix_node	*node = m_root;
+				size_type	depth = 0;
+
+				while ( node != NULL && node->type != RADIX_LEAF ){
+					radix_inner *inner = static_cast<radix_inner *>( node );
+					radix_node	**child;
+
+					depth += inner->prefix_len;
+					child = find_child_(inner, byte_(k, depth++));
+					if ( child == NULL )
+						return NULL;
+					node = *child;
+				}
+				if ( node == NULL || key_of_(node) != k )
+					return NULL;
+				return node;
+			}
+
+			/**
+			 * First leaf of the subtree node whose key does not go before k, NULL if
+			 * there is none.
+			 */
+			radix_node *lower_( radix_node *node, const key_type &k, size_type depth ) const {
+				radix_inner		*inner;
+				radix_node		**child;
+				radix_node		*next;
+				unsigned char	b;
+
+				if ( node == NULL )
+					return NULL;
+				if ( node->type == RADIX_LEAF )
+					return ( key_of_(node) < k ) ? NULL : node;
+				inner = static_cast<radix_inner *>( node );
+				for ( size_type i = 0 ; i < inner->prefix_len ; i++ ){
+					b = byte_(k, depth + i);
+					if ( inner->prefix[i] < b )
+						return NULL;
+					if ( inner->prefix[i] > b )
+						return min_leaf_(inner);
+				}
+				depth += inner->prefix_len;
+				b = byte_(k, depth);
+				child = find_child_(inner, b);
+				if ( child != NULL && ( next = this->lower_(*child, k, depth + 1) ) != NULL )
+					return next;
+				next = next_child_(inner, b);
+				return ( next == NULL ) ? NULL : min_leaf_(next);
+			}
+
+			/**
+			 * Adds the child of byte b to the sorted bytes of a Node4 or Node16.
+			 */
+			static void add_sorted_( unsigned char *keys, radix_node **children, unsigned short &count,
+				unsigned char b, radix_node *child )
+			{
+				unsigned short pos = count;
+
+				while ( pos > 0 && keys[pos - 1] > b ){
+					keys[pos] = keys[pos - 1];
+					children[pos] = children[pos - 1];
+					pos--;
+				}
+				keys[pos] = b;
+				children[pos] = child;
+				count++;
+			}
+
+			/**
+			 * Adds the child of byte b to node, in place of which ref gets a bigger node
+			 * when node is full.
+			 */
+			static void add_child_( radix_node **ref, radix_inner *node, unsigned char b, radix_node *child ){
+				switch ( node->type ){
+					case RADIX_NODE4: {
+						radix_node4		*n = static_cast<radix_node4 *>( node );
+						radix_node16	*grown;
+
+						if ( n->count < 4 ){
+							add_sorted_(n->keys, n->children, n->count, b, child);
+							return ;
+						}
+						grown = create_<radix_node16>();
+						copy_header_(grown, n);
+						std::memcpy(grown->keys, n->keys, sizeof(n->keys));
+						std::memcpy(grown->children, n->children, sizeof(n->children));
+						add_sorted_(grown->keys, grown->children, grown->count, b, child);
+						*ref = grown;
+						release_(n);
+						return ;
+					}
+					case RADIX_NODE16: {
+						radix_node16	*n = static_cast<radix_node16 *>( node );
+						radix_node48	*grown;
+
+						if ( n->count < 16 ){
+							add_sorted_(n->keys, n->children, n->count, b, child);
+							return ;
+						}
+						grown = create_<radix_node48>();
+						copy_header_(grown, n);
+						for ( unsigned short i = 0 ; i < 16 ; i++ ){
+							grown->index[n->keys[i]] = static_cast<unsigned char>( i + 1 );
+							grown->children[i] = n->children[i];
+						}
+						grown->index[b] = 17;
+						grown->children[16] = child;
+						grown->count++;
+						*ref = grown;
+						release_(n);
+						return ;
+					}
+					case RADIX_NODE48: {
+						radix_node48	*n = static_cast<radix_node48 *>( node );
+						radix_node256	*grown;
+						unsigned char	slot = 0;
+
+						if ( n->count < 48 ){
+							while ( n->children[slot] != NULL )
+								slot++;
+							n->index[b] = static_cast<unsigned char>( slot + 1 );
+							n->children[slot] = child;
+							n->count++;
+							return ;
+						}
+						grown = create_<radix_node256>();
+						copy_header_(grown, n);
+						for ( int i = 0 ; i < 256 ; i++ ){
+							if ( n->index[i] != 0 )
+								grown->children[i] = n->children[n->index[i] - 1];
+						}
+						grown->children[b] = child;
+						grown->count++;
+						*ref = grown;
+						release_(n);
+						return ;
+					}
+					default: {
+						radix_node256 *n = static_cast<radix_node256 *>( node );
+
+						n->children[b] = child;
+						n->count++;
+						return ;
+					}
+				}
+			}
+
+			/**
+			 * Removes the child in slot from node. Below its threshold node is replaced in
+			 * ref by a smaller one, and a Node4 left with a single child by that child,
+			 * the prefix of node and the byte of the child going in front of its own.
+			 */
+			static void remove_child_( radix_node **ref, radix_inner *node, unsigned char b, radix_node **slot ){
+				switch ( node->type ){
+					case RADIX_NODE4: {
+						radix_node4		*n = static_cast<radix_node4 *>( node );
+						unsigned short	pos = slot - n->children;
+						radix_node		*only;
+
+						for ( n->count-- ; pos < n->count ; pos++ ){
+							n->keys[pos] = n->keys[pos + 1];
+							n->children[pos] = n->children[pos + 1];
+						}
+						if ( n->count > 1 )
+							return ;
+						only = n->children[0];
+						if ( only->type != RADIX_LEAF ){
+							radix_inner		*child = static_cast<radix_inner *>( only );
+							unsigned char	shift = n->prefix_len + 1;
+
+							std::memmove(child->prefix + shift, child->prefix, child->prefix_len);
+							std::memcpy(child->prefix, n->prefix, n->prefix_len);
+							child->prefix[n->prefix_len] = n->keys[0];
+							child->prefix_len += shift;
+						}
+						*ref = only;
+						release_(n);
+						return ;
+					}
+					case RADIX_NODE16: {
+						radix_node16	*n = static_cast<radix_node16 *>( node );
+						unsigned short	pos = slot - n->children;
+						radix_node4		*shrunk;
+
+						for ( n->count-- ; pos < n->count ; pos++ ){
+							n->keys[pos] = n->keys[pos + 1];
+							n->children[pos] = n->children[pos + 1];
+						}
+						if ( n->count > 3 )
+							return ;
+						shrunk = create_<radix_node4>();
+						copy_header_(shrunk, n);
+						std::memcpy(shrunk->keys, n->keys, 3);
+						std::memcpy(shrunk->children, n->children, 3 * sizeof(radix_node *));
+						*ref = shrunk;
+						release_(n);
+						return ;
+					}
+					case RADIX_NODE48: {
+						radix_node48	*n = static_cast<radix_node48 *>( node );
+						radix_node16	*shrunk;
+
+						*slot = NULL;
+						n->index[b] = 0;
+						if ( --n->count > 12 )
+							return ;
+						shrunk = create_<radix_node16>();
+						copy_header_(shrunk, n);
+						shrunk->count = 0;
+						for ( int i = 0 ; i < 256 ; i++ ){
+							if ( n->index[i] != 0 ){
+								shrunk->keys[shrunk->count] = static_cast<unsigned char>( i );
+								shrunk->children[shrunk->count++] = n->children[n->index[i] - 1];
+							}
+						}
+						*ref = shrunk;
+						release_(n);
+						return ;
+					}
+					default: {
+						radix_node256	*n = static_cast<radix_node256 *>( node );
+						radix_node48	*shrunk;
+
+						*slot = NULL;
+						if ( --n->count > 37 )
+							return ;
+						shrunk = create_<radix_node48>();
+						copy_header_(shrunk, n);
+						shrunk->count = 0;
+						for ( int i = 0 ; i < 256 ; i++ ){
+							if ( n->children[i] != NULL ){
+								shrunk->children[shrunk->count] = n->children[i];
+								shrunk->index[i] = static_cast<unsigned char>( ++shrunk->count );
+							}
+						}
+						*ref = shrunk;
+						release_(n);
+						return ;
+					}
+				}
+			}
+
+			/**
+			 * Hangs leaf in the subtree in ref, its key not being there yet. Reaching a
+			 * leaf, or an inner node whose prefix differs, a Node4 takes its place with
+			 * the bytes both keys share as prefix.
+			 */
+			static void insert_( radix_node **ref, leaf_type *leaf, size_type depth ){
+				radix_node		*node = *ref;
+				const key_type	&k = leaf->data.first;
+				radix_inner		*inner;
+				radix_node4		*split;
+				radix_node		**child;
+				size_type		mismatch = 0;
+
+				if ( node == NULL ){
+					*ref = leaf;
+					return ;
+				}
+				if ( node->type == RADIX_LEAF ){
+					const key_type &other = key_of_(node);
+
+					split = create_<radix_node4>();
+					while ( byte_(k, depth + mismatch) == byte_(other, depth + mismatch) ){
+						split->prefix[mismatch] = byte_(k, depth + mismatch);
+						mismatch++;
+					}
+					split->prefix_len = static_cast<unsigned char>( mismatch );
+					add_sorted_(split->keys, split->children, split->count, byte_(other, depth + mismatch), node);
+					add_sorted_(split->keys, split->children, split->count, byte_(k, depth + mismatch), leaf);
+					*ref = split;
+					return ;
+				}
+				inner = static_cast<radix_inner *>( node );
+				while ( mismatch < inner->prefix_len && inner->prefix[mismatch] == byte_(k, depth + mismatch) ){
+					mismatch++;
+				}
+				if ( mismatch < inner->prefix_len ){
+					split = create_<radix_node4>();
+					std::memcpy(split->prefix, inner->prefix, mismatch);
+					split->prefix_len = static_cast<unsigned char>( mismatch );
+					add_sorted_(split->keys, split->children, split->count, inner->prefix[mismatch], inner);
+					add_sorted_(split->keys, split->children, split->count, byte_(k, depth + mismatch), leaf);
+					inner->prefix_len -= mismatch + 1;
+					std::memmove(inner->prefix, inner->prefix + mismatch + 1, inner->prefix_len);
+					*ref = split;
+					return ;
+				}
+				depth += inner->prefix_len;
+				child = find_child_(inner, byte_(k, depth));
+				if ( child != NULL )
+					insert_(child, leaf, depth + 1);
+				else
+					add_child_(ref, inner, byte_(k, depth), leaf);
+			}
+
+			/**
+			 * Unhooks the leaf of k, which is in the subtree in ref.
+			 */
+			static void erase_( radix_node **ref, const key_type &k, size_type depth ){
+				radix_node		*node = *ref;
+				radix_inner		*inner;
+				radix_node		**child;
+				unsigned char	b;
+
+				if ( node->type == RADIX_LEAF ){
+					*ref = NULL;
+					return ;
+				}
+				inner = static_cast<radix_inner *>( node );
+				depth += inner->prefix_len;
+				b = byte_(k, depth);
+				child = find_child_(inner, b);
+				if ( ( *child )->type == RADIX_LEAF )
+					remove_child_(ref, inner, b, child);
+				else
+					erase_(child, k, depth + 1);
+			}
+
+			void destroy_( radix_node *node ){
+				if ( node == NULL )
+					return ;
+				switch ( node->type ){
+					case RADIX_LEAF:
+						release_(static_cast<leaf_type *>( node ));
+						return ;
+					case RADIX_NODE4: {
+						radix_node4 *n = static_cast<radix_node4 *>( node );
+
+						for ( unsigned short i = 0 ; i < n->count ; i++ ){
+							this->destroy_(n->children[i]);
+						}
+						release_(n);
+						return ;
+					}
+					case RADIX_NODE16: {
+						radix_node16 *n = static_cast<radix_node16 *>( node );
+
+						for ( unsigned short i = 0 ; i < n->count ; i++ ){
+							this->destroy_(n->children[i]);
+						}
+						release_(n);
+						return ;
+					}
+					case RADIX_NODE48: {
+						radix_node48 *n = static_cast<radix_node48 *>( node );
+
+						for ( int i = 0 ; i < 48 ; i++ ){
+							this->destroy_(n->children[i]);
+						}
+						release_(n);
+						return ;
+					}
+					default: {
+						radix_node256 *n = static_cast<radix_node256 *>( node );
+
+						for ( int i = 0 ; i < 256 ; i++ ){
+							this->destroy_(n->children[i]);
+						}
+						release_(n);
+						return ;
+					}
+				}
+			}
+	};
+
+	template<class Key, class T, class Alloc>
+	void swap( radix_map<Key, T, Alloc> &x, radix_map<Key, T, Alloc> &y ){
+		x.swap( y );
+	}
+
+	template <class Key, class T, class Alloc>
+	bool operator==( const radix_map<Key,T,Alloc>& x, const radix_map<Key,T,Alloc>& y ){
+		return x.size() == y.size() && equal(x.begin(), x.end(), y.begin(), y.end());
+	}
+
+	template <class Key, class T, class Alloc>
+	bool operator!=( const radix_map<Key,T,Alloc>& x, const radix_map<Key,T,Alloc>& y ){
+		return !(x == y);
+	}
+
+	template <class Key, class T, class Alloc>
+	bool operator< ( const radix_map<Key,T,Alloc>& x, const radix_map<Key,T,Alloc>& y ){
+		return lexicographical_compare(x.begin(), x.end(), y.begin(), y.end());
+	}
+
+	template <class Key, class T, class Alloc>
+	bool operator<=( const radix_map<Key,T,Alloc>& x, const radix_map<Key,T,Alloc>& y ){
+		return !( y < x );
+	}
+
+	template <class Key, class T, class Alloc>
+	bool operator> ( const radix_map<Key,T,Alloc>& x, const radix_map<Key,T,Alloc>& y ){
+		return y < x;
+	}
+
+	template <class Key, class T, class Alloc>
+	bool operator>=( const radix_map<Key,T,Alloc>& x, const radix_map<Key,T,Alloc>& y ){
+		return !( x < y );
+	}
+}
+
+#endif
@@ -0,0 +1,1418 @@
+#ifndef ROARING_SET_HPP
+#define ROARING_SET_HPP
+
+# include <cstring>
+# include <stdint.h>
+# include "vector.hpp"
+# include "bitmap_set.hpp"
+
+# if defined(__SSE2__) && defined(__GNUC__)
+#  include <emmintrin.h>
+#  define FT_ROARING_SSE2
+# endif
+
+namespace ft {
+	enum roaring_type {
+		ROARING_ARRAY,
+		ROARING_BITMAP,
+		ROARING_RUN
+	};
+
+	enum roaring_operation {
+		ROARING_UNION,
+		ROARING_INTERSECTION,
+		ROARING_DIFFERENCE
+	};
+
+	/**
+	 * Chunks of a roaring_set
+	 *
+	 * Hold the elements sharing their 16 high bits, key, as a container of their 16 low
+	 * bits: a sorted array of up to 4096 of them, a bitmap of all 65536, or sorted runs
+	 * of consecutive values, a start and a length minus one each. values holds the array
+	 * or the runs, size counting values or runs, and words the bitmap.
+	 *
+	 */
+	struct roaring_chunk {
+		uint16_t		key;
+		unsigned char	type;
+		uint32_t		cardinality;
+		uint32_t		size;
+		uint32_t		capacity;
+		uint16_t		*values;
+		uint64_t		*words;
+
+		roaring_chunk(uint16_t __key = 0, unsigned char __type = ROARING_ARRAY)
+			: key( __key ), type( __type ), cardinality( 0 ), size( 0 ), capacity( 0 ), values( NULL ), words( NULL ) { }
+	};
+
+	/**
+	 * Number of bits set in word. Without the popcnt instruction the builtin is a call,
+	 * slower than counting in place.
+	 */
+	inline unsigned roaring_popcount_( uint64_t word ){
+# if defined(__GNUC__) && defined(__POPCNT__)
+		return static_cast<unsigned>( __builtin_popcountll(word) );
+# else
+		word = word - ( ( word >> 1 ) & 0x5555555555555555ull );
+		word = ( word & 0x3333333333333333ull ) + ( ( word >> 2 ) & 0x3333333333333333ull );
+		word = ( word + ( word >> 4 ) ) & 0x0f0f0f0f0f0f0f0full;
+		return static_cast<unsigned>( ( word * 0x0101010101010101ull ) >> 56 );
+# endif
+	}
+
+	/**
+	 * Word operations of the set operations on two bitmaps, 128 bits at a time when
+	 * SSE2 is available.
+	 */
+	struct roaring_and {
+		static uint64_t word( uint64_t x, uint64_t y ){ return x & y; }
+# if defined(FT_ROARING_SSE2)
+		static __m128i block( __m128i x, __m128i y ){ return _mm_and_si128(x, y); }
+# endif
+	};
+
+	struct roaring_or {
+		static uint64_t word( uint64_t x, uint64_t y ){ return x | y; }
+# if defined(FT_ROARING_SSE2)
+		static __m128i block( __m128i x, __m128i y ){ return _mm_or_si128(x, y); }
+# endif
+	};
+
+	struct roaring_andnot {
+		static uint64_t word( uint64_t x, uint64_t y ){ return x & ~y; }
+# if defined(FT_ROARING_SSE2)
+		static __m128i block( __m128i x, __m128i y ){ return _mm_andnot_si128(y, x); }
+# endif
+	};
+
+	/**
+	 * Stores Op of the 1024 words of x and y in out, and returns the number of bits set.
+	 */
+	template<class Op>
+	uint32_t roaring_bitmap_apply_( const uint64_t *x, const uint64_t *y, uint64_t *out ){
+		uint32_t cardinality = 0;
+
+		for ( uint32_t i = 0 ; i < 1024 ; i += 2 ){
+# if defined(FT_ROARING_SSE2)
+			_mm_storeu_si128(reinterpret_cast<__m128i *>( out + i ),
+				Op::block(_mm_loadu_si128(reinterpret_cast<const __m128i *>( x + i )),
+					_mm_loadu_si128(reinterpret_cast<const __m128i *>( y + i ))));
+# else
+			out[i] = Op::word(x[i], y[i]);
+			out[i + 1] = Op::word(x[i + 1], y[i + 1]);
+# endif
+			cardinality += roaring_popcount_(out[i]) + roaring_popcount_(out[i + 1]);
+		}
+		return cardinality;
+	}
+
+	/**
+	 * Iterators of a roaring_set
+	 *
+	 * Hold the chunk they are in, their position in its container (index in the array,
+	 * index of the run) and the element itself, returned by value. Any insertion or
+	 * erasure invalidates them, as with a vector.
+	 *
+	 */
+	template<class Set>
+	struct roaring_iterator {
+		typedef typename Set::value_type		value_type;
+		typedef value_type						reference;
+		typedef const value_type*				pointer;
+		typedef std::bidirectional_iterator_tag	iterator_category;
+		typedef std::ptrdiff_t					difference_type;
+		typedef typename Set::size_type			size_type;
+		typedef roaring_iterator<Set>			_self;
+
+		roaring_iterator() : m_set( NULL ), m_chunk( 0 ), m_index( 0 ), m_value( 0 ) { }
+		roaring_iterator(const Set *set, size_type chunk, uint32_t index, uint32_t value)
+			: m_set( set ), m_chunk( chunk ), m_index( index ), m_value( value ) { }
+
+		reference operator*() const { return m_value; }
+
+		_self &operator++(){ m_set->next_(*this); return *this; }
+		_self operator++(int){ _self tmp = *this; m_set->next_(*this); return tmp; }
+		_self &operator--(){ m_set->prev_(*this); return *this; }
+		_self operator--(int){ _self tmp = *this; m_set->prev_(*this); return tmp; }
+
+		bool operator==(const _self &it) const { return m_chunk == it.m_chunk && m_value == it.m_value; }
+		bool operator!=(const _self &it) const { return !( *this == it ); }
+
+		const Set	*m_set;
+		size_type	m_chunk;
+		uint32_t	m_index;
+		uint32_t	m_value;
+	};
+
+	/**
+	 * Roaring set
+	 *
+	 * Ordered set of 32 bit unsigned integers with the interface of a std::set, split in
+	 * chunks of 65536 values sharing their 16 high bits, each stored in the smallest of
+	 * three containers for its density: a sorted array of 16 bit values up to 4096
+	 * elements, a 8KB bitmap above, or runs of consecutive values. Sparse sets cost about
+	 * 2 bytes per element, dense ones 1 bit, and ranges 4 bytes per run.
+	 *
+	 * Arrays turn into bitmaps past 4096 elements and back at 4096. Runs only come from
+	 * optimize(), which gives every chunk its smallest container, and turn into a bitmap
+	 * when insertions or erasures split them past 2048 runs.
+	 *
+	 * set_union, set_intersection and set_difference combine containers pairwise: two
+	 * bitmaps word by word, 128 bits at a time with SSE2, two arrays by merging blocks of
+	 * 8 values compared all against all with SSE2, or by galloping through the larger one
+	 * when sizes differ by more than 64 times, and an array against a bitmap by probing
+	 * bits. Two run containers are combined run by run, runs and an array by walking
+	 * both, and other combinations with runs expand them to a bitmap first.
+	 *
+	 */
+	template<class Alloc = std::allocator<uint32_t> >
+	class roaring_set {
+		public:
+			typedef uint32_t										key_type;
+			typedef uint32_t										value_type;
+			typedef std::less<uint32_t>								key_compare;
+			typedef std::less<uint32_t>								value_compare;
+			typedef Alloc											allocator_type;
+			typedef typename allocator_type::reference				reference;
+			typedef typename allocator_type::const_reference		const_reference;
+			typedef typename allocator_type::pointer				pointer;
+			typedef typename allocator_type::const_pointer			const_pointer;
+			typedef std::ptrdiff_t									difference_type;
+			typedef std::size_t										size_type;
+			typedef roaring_iterator<roaring_set>					iterator;
+			typedef roaring_iterator<roaring_set>					const_iterator;
+			typedef ft::reverse_iterator<iterator>					reverse_iterator;
+			typedef ft::reverse_iterator<const_iterator>			const_reverse_iterator;
+
+		private:
+			friend struct roaring_iterator<roaring_set>;
+
+			typedef typename Alloc::template rebind<uint16_t>::other	value_allocator_type;
+			typedef typename Alloc::template rebind<uint64_t>::other	word_allocator_type;
+			typedef ft::vector<roaring_chunk>							chunk_vector;
+
+			const static uint32_t									ARRAY_MAX = 4096;
+			const static uint32_t									RUN_MAX = 2048;
+			const static uint32_t									WORDS = 1024;
+			// Returned by next_set_ and prev_set_ when there is no such bit
+			const static uint32_t									NONE = 65536;
+
+			chunk_vector	m_chunks;
+			size_type		m_size;
+			allocator_type	m_alloc;
+
+		public:
+			explicit roaring_set( const key_compare &comp = key_compare(), const allocator_type &alloc = allocator_type() )
+				: m_size( 0 ), m_alloc( alloc )
+			{
+				(void)comp;
+			}
+
+			template<class InputIterator>
+			roaring_set( InputIterator first, InputIterator last, const key_compare &comp = key_compare(),
+				const allocator_type &alloc = allocator_type() )
+				: m_size( 0 ), m_alloc( alloc )
+			{
+				(void)comp;
+				this->insert(first, last);
+			}
+
+			roaring_set( const roaring_set &x ) : m_size( 0 ), m_alloc( x.m_alloc ){
+				this->copy_(x);
+			}
+
+			roaring_set &operator=( const roaring_set &x ){
+				if ( this == &x )
+					return *this;
+				this->clear();
+				this->copy_(x);
+				return *this;
+			}
+
+			~roaring_set(){
+				this->clear();
+			}
+
+			/**
+			 * Iterators
+			 */
+			iterator begin() const { return m_chunks.empty() ? this->end() : this->first_of_(0); }
+			iterator end() const { return iterator( this, m_chunks.size(), 0, 0 ); }
+			reverse_iterator rbegin() const { return reverse_iterator( end() ); }
+			reverse_iterator rend() const { return reverse_iterator( begin() ); }
+
+			/**
+			 * Capacity
+			 */
+			bool empty() const { return m_size == 0; }
+			size_type size() const { return m_size; }
+			size_type max_size() const {
+				uint64_t values = uint64_t( 1 ) << 32;
+
+				return ( values > static_cast<size_type>( -1 ) ) ? static_cast<size_type>( -1 ) : static_cast<size_type>( values );
+			}
+
+			/**
+			 * Modifiers
+			 */
+			ft::pair<iterator, bool> insert( const value_type &val ){
+				uint16_t	high = static_cast<uint16_t>( val >> 16 );
+				size_type	chunk = this->chunk_lower_(high);
+				bool		inserted;
+
+				if ( chunk == m_chunks.size() || m_chunks[chunk].key != high )
+					m_chunks.insert(m_chunks.begin() + chunk, roaring_chunk( high ));
+				inserted = this->insert_low_(m_chunks[chunk], static_cast<uint16_t>( val ));
+				if ( inserted )
+					m_size++;
+				return ft::make_pair(this->lower_in_(chunk, static_cast<uint16_t>( val )), inserted);
+			}
+
+			iterator insert( iterator position, const value_type &val ){
+				(void)position;
+				return this->insert(val).first;
+			}
+
+			template<class InputIterator>
+			void insert( InputIterator first, InputIterator last ){
+				for ( ; first != last ; ++first ){
+					this->insert(*first);
+				}
+			}
+
+			void erase( iterator position ){
+				this->erase(*position);
+			}
+
+			size_type erase( const key_type &k ){
+				uint16_t	high = static_cast<uint16_t>( k >> 16 );
+				size_type	chunk = this->chunk_lower_(high);
+
+				if ( chunk == m_chunks.size() || m_chunks[chunk].key != high
+					|| !this->erase_low_(m_chunks[chunk], static_cast<uint16_t>( k )) )
+					return 0;
+				if ( m_chunks[chunk].cardinality == 0 ){
+					this->release_chunk_(m_chunks[chunk]);
+					m_chunks.erase(m_chunks.begin() + chunk);
+				}
+				m_size--;
+				return 1;
+			}
+
+			/**
+			 * Erasing invalidates iterators, so the range is erased by value, from the
+			 * element of first up to that of last.
+			 */
+			void erase( iterator first, iterator last ){
+				bool		to_end = ( last == this->end() );
+				value_type	stop = to_end ? 0 : *last;
+				iterator	it = first;
+
+				while ( it != this->end() && ( to_end || *it < stop ) ){
+					value_type k = *it;
+
+					this->erase(k);
+					it = this->lower_bound(k);
+				}
+			}
+
+			void swap( roaring_set &x ){
+				allocator_type alloc = m_alloc;
+
+				m_chunks.swap(x.m_chunks);
+				std::swap(m_size, x.m_size);
+				m_alloc = x.m_alloc;
+				x.m_alloc = alloc;
+			}
+
+			void clear(){
+				for ( size_type chunk = 0 ; chunk < m_chunks.size() ; chunk++ ){
+					this->release_chunk_(m_chunks[chunk]);
+				}
+				m_chunks.clear();
+				m_size = 0;
+			}
+
+			/**
+			 * Gives every chunk the smallest of the three containers for its elements,
+			 * which is how runs come in, and trims arrays to their size.
+			 */
+			void optimize(){
+				for ( size_type index = 0 ; index < m_chunks.size() ; index++ ){
+					roaring_chunk	&chunk = m_chunks[index];
+					uint32_t		runs = this->count_runs_(chunk);
+					uint32_t		run_bytes = 4 * runs;
+					uint32_t		array_bytes = ( chunk.cardinality <= ARRAY_MAX ) ? 2 * chunk.cardinality : 2 * NONE;
+
+					if ( run_bytes < array_bytes && run_bytes < 2 * WORDS * 4 ){
+						if ( chunk.type != ROARING_RUN || chunk.capacity != 2 * runs )
+							this->to_run_(chunk, runs);
+					} else if ( array_bytes <= 2 * WORDS * 4 ){
+						if ( chunk.type != ROARING_ARRAY || chunk.capacity != chunk.cardinality )
+							this->to_array_(chunk);
+					} else if ( chunk.type != ROARING_BITMAP )
+						this->to_bitmap_(chunk);
+				}
+			}
+
+			/**
+			 * Set operations
+			 *
+			 * Replace the content of the container by its union, intersection or difference
+			 * with other, chunk by chunk. Chunks of other only get copied into the union.
+			 */
+			void set_union( const roaring_set &other ){
+				this->set_operation_(other, ROARING_UNION);
+			}
+
+			void set_intersection( const roaring_set &other ){
+				this->set_operation_(other, ROARING_INTERSECTION);
+			}
+
+			void set_difference( const roaring_set &other ){
+				this->set_operation_(other, ROARING_DIFFERENCE);
+			}
+
+			/**
+			 * Observers
+			 */
+			key_compare key_comp() const { return key_compare(); }
+			value_compare value_comp() const { return value_compare(); }
+			allocator_type get_allocator() const { return m_alloc; }
+
+			/**
+			 * Operations
+			 */
+			iterator find( const key_type &k ) const {
+				iterator it = this->lower_bound(k);
+
+				return ( it != this->end() && *it == k ) ? it : this->end();
+			}
+
+			size_type count( const key_type &k ) const {
+				uint16_t	high = static_cast<uint16_t>( k >> 16 );
+				size_type	chunk = this->chunk_lower_(high);
+
+				if ( chunk == m_chunks.size() || m_chunks[chunk].key != high )
+					return 0;
+				return this->contains_low_(m_chunks[chunk], static_cast<uint16_t>( k )) ? 1 : 0;
+			}
+
+			iterator lower_bound( const key_type &k ) const {
+				uint16_t	high = static_cast<uint16_t>( k >> 16 );
+				size_type	chunk = this->chunk_lower_(high);
+
+				if ( chunk < m_chunks.size() && m_chunks[chunk].key == high )
+					return this->lower_in_(chunk, static_cast<uint16_t>( k ));
+				return ( chunk == m_chunks.size() ) ? this->end() : this->first_of_(chunk);
+			}
+
+			iterator upper_bound( const key_type &k ) const {
+				if ( k == static_cast<key_type>( -1 ) )
+					return this->end();
+				return this->lower_bound(k + 1);
+			}
+
+			ft::pair<iterator, iterator> equal_range( const key_type &k ) const {
+				return ft::make_pair(this->lower_bound(k), this->upper_bound(k));
+			}
+
+		private:
+			/**
+			 * Storage of containers. Arrays and runs grow by doubling, up to the size
+			 * past which they turn into a bitmap.
+			 */
+			uint16_t *allocate_values_( uint32_t capacity ){
+				return value_allocator_type( m_alloc ).allocate(capacity);
+			}
+
+			uint64_t *allocate_words_(){
+				uint64_t *words = word_allocator_type( m_alloc ).allocate(WORDS);
+
+				std::memset(words, 0, WORDS * sizeof(uint64_t));
+				return words;
+			}
+
+			void release_values_( roaring_chunk &chunk ){
+				if ( chunk.values != NULL )
+					value_allocator_type( m_alloc ).deallocate(chunk.values, chunk.capacity);
+				chunk.values = NULL;
+				chunk.capacity = 0;
+			}
+
+			void release_chunk_( roaring_chunk &chunk ){
+				this->release_values_(chunk);
+				if ( chunk.words != NULL )
+					word_allocator_type( m_alloc ).deallocate(chunk.words, WORDS);
+				chunk.words = NULL;
+			}
+
+			static uint32_t used_values_( const roaring_chunk &chunk ){
+				return ( chunk.type == ROARING_RUN ) ? 2 * chunk.size : chunk.size;
+			}
+
+			void reserve_values_( roaring_chunk &chunk, uint32_t capacity ){
+				uint32_t	grown = 2 * chunk.capacity;
+				uint16_t	*values;
+
+				if ( capacity <= chunk.capacity )
+					return ;
+				if ( grown > ARRAY_MAX + 2 )
+					grown = ARRAY_MAX + 2;
+				if ( grown < capacity )
+					grown = capacity;
+				if ( grown < 4 )
+					grown = 4;
+				values = this->allocate_values_(grown);
+				if ( chunk.values != NULL )
+					std::memcpy(values, chunk.values, used_values_(chunk) * sizeof(uint16_t));
+				this->release_values_(chunk);
+				chunk.values = values;
+				chunk.capacity = grown;
+			}
+
+			roaring_chunk copy_chunk_( const roaring_chunk &chunk ){
+				roaring_chunk copy = chunk;
+
+				copy.values = NULL;
+				copy.words = NULL;
+				copy.capacity = 0;
+				if ( chunk.type == ROARING_BITMAP ){
+					copy.words = this->allocate_words_();
+					std::memcpy(copy.words, chunk.words, WORDS * sizeof(uint64_t));
+				} else {
+					copy.capacity = used_values_(chunk);
+					copy.values = this->allocate_values_(copy.capacity);
+					std::memcpy(copy.values, chunk.values, copy.capacity * sizeof(uint16_t));
+				}
+				return copy;
+			}
+
+			void copy_( const roaring_set &x ){
+				m_chunks.reserve(x.m_chunks.size());
+				for ( size_type chunk = 0 ; chunk < x.m_chunks.size() ; chunk++ ){
+					m_chunks.push_back(this->copy_chunk_(x.m_chunks[chunk]));
+				}
+				m_size = x.m_size;
+			}
+
+			/**
+			 * Bits of a bitmap container
+			 */
+			static uint32_t next_set_( const uint64_t *words, uint32_t from ){
+				uint32_t	index = from >> 6;
+				uint64_t	word;
+
+				if ( from >= NONE )
+					return NONE;
+				word = words[index] & ( ~uint64_t( 0 ) << ( from & 63 ) );
+				while ( word == 0 ){
+					if ( ++index == WORDS )
+						return NONE;
+					word = words[index];
+				}
+				return ( index << 6 ) | bitmap_lowest_(word);
+			}
+
+			static uint32_t next_clear_( const uint64_t *words, uint32_t from ){
+				uint32_t	index = from >> 6;
+				uint64_t	word;
+
+				if ( from >= NONE )
+					return NONE;
+				word = ~words[index] & ( ~uint64_t( 0 ) << ( from & 63 ) );
+				while ( word == 0 ){
+					if ( ++index == WORDS )
+						return NONE;
+					word = ~words[index];
+				}
+				return ( index << 6 ) | bitmap_lowest_(word);
+			}
+
+			static uint32_t prev_set_( const uint64_t *words, uint32_t from ){
+				uint32_t	index = from >> 6;
+				uint64_t	word = words[index] & ( ~uint64_t( 0 ) >> ( 63 - ( from & 63 ) ) );
+
+				while ( word == 0 ){
+					if ( index-- == 0 )
+						return NONE;
+					word = words[index];
+				}
+				return ( index << 6 ) | bitmap_highest_(word);
+			}
+
+			/**
+			 * Sets the bits from first to last included.
+			 */
+			static void set_range_( uint64_t *words, uint32_t first, uint32_t last ){
+				uint32_t first_word = first >> 6;
+				uint32_t last_word = last >> 6;
+				uint64_t first_mask = ~uint64_t( 0 ) << ( first & 63 );
+				uint64_t last_mask = ~uint64_t( 0 ) >> ( 63 - ( last & 63 ) );
+
+				if ( first_word == last_word ){
+					words[first_word] |= first_mask & last_mask;
+					return ;
+				}
+				words[first_word] |= first_mask;
+				for ( uint32_t index = first_word + 1 ; index < last_word ; index++ ){
+					words[index] = ~uint64_t( 0 );
+				}
+				words[last_word] |= last_mask;
+			}
+
+			/**
+			 * Searches in containers: first value of an array not below low, first run
+			 * starting above low.
+			 */
+			static uint32_t array_lower_( const roaring_chunk &chunk, uint16_t low ){
+				uint32_t first = 0;
+				uint32_t last = chunk.size;
+
+				while ( first < last ){
+					uint32_t middle = first + ( last - first ) / 2;
+
+					if ( chunk.values[middle] < low )
+						first = middle + 1;
+					else
+						last = middle;
+				}
+				return first;
+			}
+
+			static uint32_t run_upper_( const roaring_chunk &chunk, uint16_t low ){
+				uint32_t first = 0;
+				uint32_t last = chunk.size;
+
+				while ( first < last ){
+					uint32_t middle = first + ( last - first ) / 2;
+
+					if ( chunk.values[2 * middle] <= low )
+						first = middle + 1;
+					else
+						last = middle;
+				}
+				return first;
+			}
+
+			static uint32_t run_end_( const roaring_chunk &chunk, uint32_t run ){
+				return static_cast<uint32_t>( chunk.values[2 * run] ) + chunk.values[2 * run + 1];
+			}
+
+			static bool contains_low_( const roaring_chunk &chunk, uint16_t low ){
+				switch ( chunk.type ){
+					case ROARING_ARRAY: {
+						uint32_t index = array_lower_(chunk, low);
+
+						return index < chunk.size && chunk.values[index] == low;
+					}
+					case ROARING_BITMAP:
+						return ( chunk.words[low >> 6] >> ( low & 63 ) ) & 1;
+					default: {
+						uint32_t run = run_upper_(chunk, low);
+
+						return run > 0 && low <= run_end_(chunk, run - 1);
+					}
+				}
+			}
+
+			size_type chunk_lower_( uint16_t high ) const {
+				size_type first = 0;
+				size_type last = m_chunks.size();
+
+				while ( first < last ){
+					size_type middle = first + ( last - first ) / 2;
+
+					if ( m_chunks[middle].key < high )
+						first = middle + 1;
+					else
+						last = middle;
+				}
+				return first;
+			}
+
+			/**
+			 * Conversions between containers, keeping the key and the cardinality.
+			 */
+			void to_bitmap_( roaring_chunk &chunk ){
+				uint64_t *words = this->allocate_words_();
+
+				if ( chunk.type == ROARING_ARRAY ){
+					for ( uint32_t index = 0 ; index < chunk.size ; index++ ){
+						words[chunk.values[index] >> 6] |= uint64_t( 1 ) << ( chunk.values[index] & 63 );
+					}
+				} else {
+					for ( uint32_t run = 0 ; run < chunk.size ; run++ ){
+						set_range_(words, chunk.values[2 * run], run_end_(chunk, run));
+					}
+				}
+				this->release_values_(chunk);
+				chunk.words = words;
+				chunk.type = ROARING_BITMAP;
+				chunk.size = 0;
+			}
+
+			void to_array_( roaring_chunk &chunk ){
+				uint16_t	*values = this->allocate_values_(chunk.cardinality);
+				uint32_t	size = 0;
+
+				if ( chunk.type == ROARING_ARRAY )
+					std::memcpy(values, chunk.values, chunk.size * sizeof(uint16_t));
+				else if ( chunk.type == ROARING_BITMAP ){
+					for ( uint32_t index = 0 ; index < WORDS ; index++ ){
+						for ( uint64_t word = chunk.words[index] ; word != 0 ; word &= word - 1 ){
+							values[size++] = static_cast<uint16_t>( ( index << 6 ) | bitmap_lowest_(word) );
+						}
+					}
+				} else {
+					for ( uint32_t run = 0 ; run < chunk.size ; run++ ){
+						for ( uint32_t value = chunk.values[2 * run] ; value <= run_end_(chunk, run) ; value++ ){
+							values[size++] = static_cast<uint16_t>( value );
+						}
+					}
+				}
+				this->release_chunk_(chunk);
+				chunk.values = values;
+				chunk.capacity = chunk.cardinality;
+				chunk.size = chunk.cardinality;
+				chunk.type = ROARING_ARRAY;
+			}
+
+			static uint32_t count_runs_( const roaring_chunk &chunk ){
+				uint32_t runs = 0;
+
+				if ( chunk.type == ROARING_RUN )
+					return chunk.size;
+				if ( chunk.type == ROARING_ARRAY ){
+					for ( uint32_t index = 0 ; index < chunk.size ; index++ ){
+						if ( index == 0 || chunk.values[index] != chunk.values[index - 1] + 1 )
+							runs++;
+					}
+					return runs;
+				}
+				// A run starts on every set bit whose lower neighbour is clear
+				for ( uint32_t index = 0 ; index < WORDS ; index++ ){
+					uint64_t carry = ( index == 0 ) ? 0 : chunk.words[index - 1] >> 63;
+
+					runs += roaring_popcount_(chunk.words[index] & ~( ( chunk.words[index] << 1 ) | carry ));
+				}
+				return runs;
+			}
+
+			void to_run_( roaring_chunk &chunk, uint32_t runs ){
+				uint16_t	*values = this->allocate_values_(2 * runs);
+				uint32_t	size = 0;
+
+				if ( chunk.type == ROARING_RUN )
+					std::memcpy(values, chunk.values, 2 * runs * sizeof(uint16_t));
+				else if ( chunk.type == ROARING_ARRAY ){
+					for ( uint32_t index = 0 ; index < chunk.size ; index++ ){
+						if ( size > 0 && chunk.values[index] == values[2 * size - 2] + values[2 * size - 1] + 1 )
+							values[2 * size - 1]++;
+						else {
+							values[2 * size] = chunk.values[index];
+							values[2 * size + 1] = 0;
+							size++;
+						}
+					}
+				} else {
+					for ( uint32_t first = next_set_(chunk.words, 0) ; first != NONE ; ){
+						uint32_t last = next_clear_(chunk.words, first);
+
+						values[2 * size] = static_cast<uint16_t>( first );
+						values[2 * size + 1] = static_cast<uint16_t>( last - first - 1 );
+						size++;
+						first = next_set_(chunk.words, last);
+					}
+				}
+				this->release_chunk_(chunk);
+				chunk.values = values;
+				chunk.capacity = 2 * runs;
+				chunk.size = runs;
+				chunk.type = ROARING_RUN;
+			}
+
+			/**
+			 * Insertion and erasure of low in the container of chunk. Return false when
+			 * low was already there, or was not.
+			 */
+			bool insert_low_( roaring_chunk &chunk, uint16_t low ){
+				if ( chunk.type == ROARING_BITMAP ){
+					uint64_t &word = chunk.words[low >> 6];
+					uint64_t bit = uint64_t( 1 ) << ( low & 63 );
+
+					if ( word & bit )
+						return false;
+					word |= bit;
+					chunk.cardinality++;
+					return true;
+				}
+				if ( chunk.type == ROARING_RUN )
+					return this->run_insert_(chunk, low);
+
+				uint32_t index = array_lower_(chunk, low);
+
+				if ( index < chunk.size && chunk.values[index] == low )
+					return false;
+				if ( chunk.size == ARRAY_MAX ){
+					this->to_bitmap_(chunk);
+					return this->insert_low_(chunk, low);
+				}
+				this->reserve_values_(chunk, chunk.size + 1);
+				std::memmove(chunk.values + index + 1, chunk.values + index, ( chunk.size - index ) * sizeof(uint16_t));
+				chunk.values[index] = low;
+				chunk.size++;
+				chunk.cardinality++;
+				return true;
+			}
+
+			bool erase_low_( roaring_chunk &chunk, uint16_t low ){
+				if ( chunk.type == ROARING_BITMAP ){
+					uint64_t &word = chunk.words[low >> 6];
+					uint64_t bit = uint64_t( 1 ) << ( low & 63 );
+
+					if ( !( word & bit ) )
+						return false;
+					word &= ~bit;
+					if ( --chunk.cardinality <= ARRAY_MAX && chunk.cardinality > 0 )
+						this->to_array_(chunk);
+					return true;
+				}
+				if ( chunk.type == ROARING_RUN )
+					return this->run_erase_(chunk, low);
+
+				uint32_t index = array_lower_(chunk, low);
+
+				if ( index == chunk.size || chunk.values[index] != low )
+					return false;
+				std::memmove(chunk.values + index, chunk.values + index + 1, ( chunk.size - index - 1 ) * sizeof(uint16_t));
+				chunk.size--;
+				chunk.cardinality--;
+				return true;
+			}
+
+			/**
+			 * low extends the run before it, the run after it, both when it fills the gap
+			 * between them, or starts a run of its own.
+			 */
+			bool run_insert_( roaring_chunk &chunk, uint16_t low ){
+				uint32_t	run = run_upper_(chunk, low);
+				bool		left;
+				bool		right;
+
+				if ( run > 0 && low <= run_end_(chunk, run - 1) )
+					return false;
+				left = run > 0 && run_end_(chunk, run - 1) + 1 == low;
+				right = run < chunk.size && chunk.values[2 * run] == low + 1;
+				if ( left && right ){
+					chunk.values[2 * run - 1] = static_cast<uint16_t>( run_end_(chunk, run) - chunk.values[2 * run - 2] );
+					std::memmove(chunk.values + 2 * run, chunk.values + 2 * run + 2, ( chunk.size - run - 1 ) * 2 * sizeof(uint16_t));
+					chunk.size--;
+				} else if ( left )
+					chunk.values[2 * run - 1]++;
+				else if ( right ){
+					chunk.values[2 * run]--;
+					chunk.values[2 * run + 1]++;
+				} else {
+					this->reserve_values_(chunk, 2 * chunk.size + 2);
+					std::memmove(chunk.values + 2 * run + 2, chunk.values + 2 * run, ( chunk.size - run ) * 2 * sizeof(uint16_t));
+					chunk.values[2 * run] = low;
+					chunk.values[2 * run + 1] = 0;
+					chunk.size++;
+				}
+				chunk.cardinality++;
+				if ( chunk.size > RUN_MAX )
+					this->to_bitmap_(chunk);
+				return true;
+			}
+
+			/**
+			 * low shortens its run, or splits it in two.
+			 */
+			bool run_erase_( roaring_chunk &chunk, uint16_t low ){
+				uint32_t run = run_upper_(chunk, low);
+				uint32_t first;
+				uint32_t last;
+
+				if ( run == 0 || low > run_end_(chunk, run - 1) )
+					return false;
+				run--;
+				first = chunk.values[2 * run];
+				last = run_end_(chunk, run);
+				if ( first == last ){
+					std::memmove(chunk.values + 2 * run, chunk.values + 2 * run + 2, ( chunk.size - run - 1 ) * 2 * sizeof(uint16_t));
+					chunk.size--;
+				} else if ( low == first ){
+					chunk.values[2 * run]++;
+					chunk.values[2 * run + 1]--;
+				} else if ( low == last )
+					chunk.values[2 * run + 1]--;
+				else {
+					this->reserve_values_(chunk, 2 * chunk.size + 2);
+					std::memmove(chunk.values + 2 * run + 4, chunk.values + 2 * run + 2, ( chunk.size - run - 1 ) * 2 * sizeof(uint16_t));
+					chunk.values[2 * run + 1] = static_cast<uint16_t>( low - first - 1 );
+					chunk.values[2 * run + 2] = static_cast<uint16_t>( low + 1 );
+					chunk.values[2 * run + 3] = static_cast<uint16_t>( last - low - 1 );
+					chunk.size++;
+				}
+				chunk.cardinality--;
+				if ( chunk.size > RUN_MAX )
+					this->to_bitmap_(chunk);
+				return true;
+			}
+
+			/**
+			 * Iteration. An iterator past the last element of its chunk moves to the first
+			 * one of the next chunk, or to the end.
+			 */
+			iterator lower_in_( size_type index, uint16_t low ) const {
+				const roaring_chunk	&chunk = m_chunks[index];
+				uint32_t			high = static_cast<uint32_t>( chunk.key ) << 16;
+
+				switch ( chunk.type ){
+					case ROARING_ARRAY: {
+						uint32_t position = array_lower_(chunk, low);
+
+						if ( position < chunk.size )
+							return iterator( this, index, position, high | chunk.values[position] );
+						break ;
+					}
+					case ROARING_BITMAP: {
+						uint32_t value = next_set_(chunk.words, low);
+
+						if ( value != NONE )
+							return iterator( this, index, 0, high | value );
+						break ;
+					}
+					default: {
+						uint32_t run = run_upper_(chunk, low);
+
+						if ( run > 0 && low <= run_end_(chunk, run - 1) )
+							return iterator( this, index, run - 1, high | low );
+						if ( run < chunk.size )
+							return iterator( this, index, run, high | chunk.values[2 * run] );
+						break ;
+					}
+				}
+				return ( index + 1 == m_chunks.size() ) ? this->end() : this->first_of_(index + 1);
+			}
+
+			iterator first_of_( size_type index ) const {
+				return this->lower_in_(index, 0);
+			}
+
+			iterator last_of_( size_type index ) const {
+				const roaring_chunk	&chunk = m_chunks[index];
+				uint32_t			high = static_cast<uint32_t>( chunk.key ) << 16;
+
+				if ( chunk.type == ROARING_ARRAY )
+					return iterator( this, index, chunk.size - 1, high | chunk.values[chunk.size - 1] );
+				if ( chunk.type == ROARING_BITMAP )
+					return iterator( this, index, 0, high | prev_set_(chunk.words, NONE - 1) );
+				return iterator( this, index, chunk.size - 1, high | run_end_(chunk, chunk.size - 1) );
+			}
+
+			void next_( iterator &it ) const {
+				const roaring_chunk	&chunk = m_chunks[it.m_chunk];
+				uint32_t			high = it.m_value & 0xffff0000u;
+				uint32_t			low = it.m_value & 0xffff;
+
+				if ( chunk.type == ROARING_ARRAY ){
+					if ( it.m_index + 1 < chunk.size ){
+						it.m_value = high | chunk.values[++it.m_index];
+						return ;
+					}
+				} else if ( chunk.type == ROARING_BITMAP ){
+					uint32_t value = next_set_(chunk.words, low + 1);
+
+					if ( value != NONE ){
+						it.m_value = high | value;
+						return ;
+					}
+				} else {
+					if ( low < run_end_(chunk, it.m_index) ){
+						it.m_value++;
+						return ;
+					}
+					if ( it.m_index + 1 < chunk.size ){
+						it.m_value = high | chunk.values[2 * ++it.m_index];
+						return ;
+					}
+				}
+				it = ( it.m_chunk + 1 == m_chunks.size() ) ? this->end() : this->first_of_(it.m_chunk + 1);
+			}
+
+			void prev_( iterator &it ) const {
+				if ( it.m_chunk == m_chunks.size() ){
+					it = this->last_of_(it.m_chunk - 1);
+					return ;
+				}
+
+				const roaring_chunk	&chunk = m_chunks[it.m_chunk];
+				uint32_t			high = it.m_value & 0xffff0000u;
+				uint32_t			low = it.m_value & 0xffff;
+
+				if ( chunk.type == ROARING_ARRAY ){
+					if ( it.m_index > 0 ){
+						it.m_value = high | chunk.values[--it.m_index];
+						return ;
+					}
+				} else if ( chunk.type == ROARING_BITMAP ){
+					uint32_t value = ( low == 0 ) ? NONE : prev_set_(chunk.words, low - 1);
+
+					if ( value != NONE ){
+						it.m_value = high | value;
+						return ;
+					}
+				} else {
+					if ( low > chunk.values[2 * it.m_index] ){
+						it.m_value--;
+						return ;
+					}
+					if ( it.m_index > 0 ){
+						it.m_index--;
+						it.m_value = high | run_end_(chunk, it.m_index);
+						return ;
+					}
+				}
+				it = this->last_of_(it.m_chunk - 1);
+			}
+
+			/**
+			 * First index from from on of a value of values not below value: steps doubling
+			 * from from, then a binary search in the last step.
+			 */
+			static uint32_t gallop_( const uint16_t *values, uint32_t size, uint32_t from, uint16_t value ){
+				uint32_t low = from;
+				uint32_t step = 1;
+				uint32_t high;
+
+				if ( from >= size || values[from] >= value )
+					return from;
+				while ( low + step < size && values[low + step] < value ){
+					low += step;
+					step *= 2;
+				}
+				high = ( low + step < size ) ? low + step : size;
+				while ( low + 1 < high ){
+					uint32_t middle = low + ( high - low ) / 2;
+
+					if ( values[middle] < value )
+						low = middle;
+					else
+						high = middle;
+				}
+				return high;
+			}
+
+			/**
+			 * Values both in x and y stored in out, returns how many. Blocks of 8 values
+			 * of x are compared to blocks of 8 of y in all 8 rotations, and the block with
+			 * the lower last value moves on.
+			 */
+			static uint32_t intersect_arrays_( const uint16_t *x, uint32_t nx, const uint16_t *y, uint32_t ny, uint16_t *out ){
+				uint32_t i = 0;
+				uint32_t j = 0;
+				uint32_t size = 0;
+
+				if ( static_cast<uint64_t>( nx ) * 64 < ny || static_cast<uint64_t>( ny ) * 64 < nx ){
+					const uint16_t	*small = ( nx < ny ) ? x : y;
+					const uint16_t	*large = ( nx < ny ) ? y : x;
+					uint32_t		nsmall = ( nx < ny ) ? nx : ny;
+					uint32_t		nlarge = ( nx < ny ) ? ny : nx;
+
+					for ( ; i < nsmall ; i++ ){
+						j = gallop_(large, nlarge, j, small[i]);
+						if ( j == nlarge )
+							break ;
+						if ( large[j] == small[i] )
+							out[size++] = small[i];
+					}
+					return size;
+				}
+# if defined(FT_ROARING_SSE2)
+				while ( i + 8 <= nx && j + 8 <= ny ){
+					__m128i	vx = _mm_loadu_si128(reinterpret_cast<const __m128i *>( x + i ));
+					__m128i	vy = _mm_loadu_si128(reinterpret_cast<const __m128i *>( y + j ));
+					__m128i	equal = _mm_cmpeq_epi16(vx, vy);
+					int		mask;
+
+					for ( int rotation = 1 ; rotation < 8 ; rotation++ ){
+						vy = _mm_or_si128(_mm_srli_si128(vy, 2), _mm_slli_si128(vy, 14));
+						equal = _mm_or_si128(equal, _mm_cmpeq_epi16(vx, vy));
+					}
+					// One bit per 16 bit lane
+					for ( mask = _mm_movemask_epi8(equal) & 0x5555 ; mask != 0 ; mask &= mask - 1 ){
+						out[size++] = x[i + __builtin_ctz(mask) / 2];
+					}
+					if ( x[i + 7] <= y[j + 7] )
+						i += 8;
+					else
+						j += 8;
+				}
+# endif
+				while ( i < nx && j < ny ){
+					if ( x[i] < y[j] )
+						i++;
+					else if ( y[j] < x[i] )
+						j++;
+					else {
+						out[size++] = x[i];
+						i++;
+						j++;
+					}
+				}
+				return size;
+			}
+
+			/**
+			 * Values of x and of y, or of x but not of y, stored in out, returns how many.
+			 */
+			static uint32_t merge_arrays_( const uint16_t *x, uint32_t nx, const uint16_t *y, uint32_t ny, uint16_t *out, bool keep_y ){
+				uint32_t i = 0;
+				uint32_t j = 0;
+				uint32_t size = 0;
+
+				while ( i < nx && j < ny ){
+					if ( x[i] < y[j] )
+						out[size++] = x[i++];
+					else if ( y[j] < x[i] ){
+						if ( keep_y )
+							out[size++] = y[j];
+						j++;
+					} else {
+						if ( keep_y )
+							out[size++] = x[i];
+						i++;
+						j++;
+					}
+				}
+				while ( i < nx )
+					out[size++] = x[i++];
+				while ( keep_y && j < ny )
+					out[size++] = y[j++];
+				return size;
+			}
+
+			/**
+			 * Values of array that are, or are not, in bitmap stored in out, returns how
+			 * many.
+			 */
+			static uint32_t filter_array_( const roaring_chunk &array, const uint64_t *words, uint16_t *out, bool in ){
+				uint32_t size = 0;
+
+				for ( uint32_t index = 0 ; index < array.size ; index++ ){
+					uint16_t value = array.values[index];
+
+					if ( ( ( words[value >> 6] >> ( value & 63 ) ) & 1 ) == static_cast<uint64_t>( in ) )
+						out[size++] = value;
+				}
+				return size;
+			}
+
+			/**
+			 * Values of array that are, or are not, in the runs of runs stored in out,
+			 * returns how many.
+			 */
+			static uint32_t filter_runs_( const roaring_chunk &array, const roaring_chunk &runs, uint16_t *out, bool in ){
+				uint32_t run = 0;
+				uint32_t size = 0;
+
+				for ( uint32_t index = 0 ; index < array.size ; index++ ){
+					uint16_t	value = array.values[index];
+					bool		inside;
+
+					while ( run < runs.size && run_end_(runs, run) < value )
+						run++;
+					inside = run < runs.size && runs.values[2 * run] <= value;
+					if ( inside == in )
+						out[size++] = value;
+				}
+				return size;
+			}
+
+			/**
+			 * Appends the run from first to last to out, merging it with the last run of
+			 * out when they touch.
+			 */
+			static void push_run_( roaring_chunk &out, uint32_t first, uint32_t last ){
+				if ( out.size > 0 && first <= run_end_(out, out.size - 1) + 1 ){
+					if ( last > run_end_(out, out.size - 1) )
+						out.values[2 * out.size - 1] = static_cast<uint16_t>( last - out.values[2 * out.size - 2] );
+					return ;
+				}
+				out.values[2 * out.size] = static_cast<uint16_t>( first );
+				out.values[2 * out.size + 1] = static_cast<uint16_t>( last - first );
+				out.size++;
+			}
+
+			/**
+			 * Runs of the union, intersection or difference of the runs of x and y, at most
+			 * as many as both have, stored in out.
+			 */
+			static void merge_runs_( const roaring_chunk &x, const roaring_chunk &y, int op, roaring_chunk &out ){
+				uint32_t i = 0;
+				uint32_t j = 0;
+
+				if ( op == ROARING_UNION ){
+					while ( i < x.size || j < y.size ){
+						if ( j == y.size || ( i < x.size && x.values[2 * i] < y.values[2 * j] ) ){
+							push_run_(out, x.values[2 * i], run_end_(x, i));
+							i++;
+						} else {
+							push_run_(out, y.values[2 * j], run_end_(y, j));
+							j++;
+						}
+					}
+				} else if ( op == ROARING_INTERSECTION ){
+					while ( i < x.size && j < y.size ){
+						uint32_t first = ( x.values[2 * i] > y.values[2 * j] ) ? x.values[2 * i] : y.values[2 * j];
+						uint32_t last = ( run_end_(x, i) < run_end_(y, j) ) ? run_end_(x, i) : run_end_(y, j);
+
+						if ( first <= last )
+							push_run_(out, first, last);
+						if ( run_end_(x, i) < run_end_(y, j) )
+							i++;
+						else
+							j++;
+					}
+				} else {
+					for ( ; i < x.size ; i++ ){
+						uint32_t first = x.values[2 * i];
+						uint32_t last = run_end_(x, i);
+
+						while ( j < y.size && run_end_(y, j) < first )
+							j++;
+						// Every run of y overlapping this one cuts it, the last may reach the next
+						while ( j < y.size && y.values[2 * j] <= last && first <= last ){
+							if ( y.values[2 * j] > first )
+								push_run_(out, first, y.values[2 * j] - 1);
+							first = run_end_(y, j) + 1;
+							if ( run_end_(y, j) > last )
+								break ;
+							j++;
+						}
+						if ( first <= last )
+							push_run_(out, first, last);
+					}
+				}
+				for ( i = 0 ; i < out.size ; i++ ){
+					out.cardinality += out.values[2 * i + 1] + 1;
+				}
+			}
+
+			/**
+			 * Combinations with runs that need no bitmap: two run containers run by run, an
+			 * array filtered by runs, and a few values added to or removed from a copy of
+			 * the runs. Returns false for the others.
+			 */
+			bool combine_runs_( const roaring_chunk &x, const roaring_chunk &y, int op, roaring_chunk &out ){
+				if ( x.type == ROARING_RUN && y.type == ROARING_RUN ){
+					out.type = ROARING_RUN;
+					out.capacity = 2 * ( x.size + y.size );
+					out.values = this->allocate_values_(out.capacity);
+					merge_runs_(x, y, op, out);
+					if ( out.size > RUN_MAX )
+						this->to_bitmap_(out);
+					return true;
+				}
+				if ( x.type == ROARING_BITMAP || y.type == ROARING_BITMAP )
+					return false;
+
+				const roaring_chunk	&runs = ( x.type == ROARING_RUN ) ? x : y;
+				const roaring_chunk	&array = ( x.type == ROARING_RUN ) ? y : x;
+
+				if ( op == ROARING_INTERSECTION || ( op == ROARING_DIFFERENCE && x.type == ROARING_ARRAY ) ){
+					out.capacity = array.size;
+					out.values = this->allocate_values_(out.capacity);
+					out.size = filter_runs_(array, runs, out.values, op == ROARING_INTERSECTION);
+					out.cardinality = out.size;
+					return true;
+				}
+				if ( array.size > 64 )
+					return false;
+				out = this->copy_chunk_(runs);
+				for ( uint32_t index = 0 ; index < array.size ; index++ ){
+					if ( op == ROARING_UNION )
+						this->insert_low_(out, array.values[index]);
+					else
+						this->erase_low_(out, array.values[index]);
+				}
+				return true;
+			}
+
+			/**
+			 * Combines the containers of x and y, chunks of the same key, into out.
+			 */
+			void combine_( const roaring_chunk &a, const roaring_chunk &b, int op, roaring_chunk &out ){
+				roaring_chunk		expanded[2];
+				const roaring_chunk	*x = &a;
+				const roaring_chunk	*y = &b;
+
+				if ( ( a.type == ROARING_RUN || b.type == ROARING_RUN ) && this->combine_runs_(a, b, op, out) ){
+					out.key = a.key;
+					return ;
+				}
+				if ( a.type == ROARING_RUN ){
+					expanded[0] = this->copy_chunk_(a);
+					this->to_bitmap_(expanded[0]);
+					x = &expanded[0];
+				}
+				if ( b.type == ROARING_RUN ){
+					expanded[1] = this->copy_chunk_(b);
+					this->to_bitmap_(expanded[1]);
+					y = &expanded[1];
+				}
+				if ( x->type == ROARING_BITMAP && y->type == ROARING_BITMAP ){
+					out.type = ROARING_BITMAP;
+					out.words = this->allocate_words_();
+					if ( op == ROARING_UNION )
+						out.cardinality = roaring_bitmap_apply_<roaring_or>(x->words, y->words, out.words);
+					else if ( op == ROARING_INTERSECTION )
+						out.cardinality = roaring_bitmap_apply_<roaring_and>(x->words, y->words, out.words);
+					else
+						out.cardinality = roaring_bitmap_apply_<roaring_andnot>(x->words, y->words, out.words);
+				} else if ( x->type == ROARING_ARRAY && y->type == ROARING_ARRAY ){
+					if ( op == ROARING_UNION && x->size + y->size > ARRAY_MAX ){
+						out.type = ROARING_BITMAP;
+						out.words = this->allocate_words_();
+						for ( uint32_t index = 0 ; index < x->size ; index++ ){
+							out.words[x->values[index] >> 6] |= uint64_t( 1 ) << ( x->values[index] & 63 );
+						}
+						for ( uint32_t index = 0 ; index < y->size ; index++ ){
+							out.words[y->values[index] >> 6] |= uint64_t( 1 ) << ( y->values[index] & 63 );
+						}
+						for ( uint32_t index = 0 ; index < WORDS ; index++ ){
+							out.cardinality += roaring_popcount_(out.words[index]);
+						}
+					} else {
+						out.capacity = ( op == ROARING_UNION ) ? x->size + y->size : x->size;
+						out.values = this->allocate_values_(out.capacity);
+						if ( op == ROARING_INTERSECTION )
+							out.size = intersect_arrays_(x->values, x->size, y->values, y->size, out.values);
+						else
+							out.size = merge_arrays_(x->values, x->size, y->values, y->size, out.values, op == ROARING_UNION);
+						out.cardinality = out.size;
+					}
+				} else if ( x->type == ROARING_ARRAY && op != ROARING_UNION ){
+					out.capacity = x->size;
+					out.values = this->allocate_values_(out.capacity);
+					out.size = filter_array_(*x, y->words, out.values, op == ROARING_INTERSECTION);
+					out.cardinality = out.size;
+				} else if ( y->type == ROARING_ARRAY && op == ROARING_INTERSECTION ){
+					out.capacity = y->size;
+					out.values = this->allocate_values_(out.capacity);
+					out.size = filter_array_(*y, x->words, out.values, true);
+					out.cardinality = out.size;
+				} else {
+					// A bitmap with the values of an array added or removed
+					const roaring_chunk	&bitmap = ( x->type == ROARING_BITMAP ) ? *x : *y;
+					const roaring_chunk	&array = ( x->type == ROARING_BITMAP ) ? *y : *x;
+
+					out = this->copy_chunk_(bitmap);
+					for ( uint32_t index = 0 ; index < array.size ; index++ ){
+						uint16_t	value = array.values[index];
+						uint64_t	&word = out.words[value >> 6];
+						uint64_t	bit = uint64_t( 1 ) << ( value & 63 );
+
+						if ( op == ROARING_UNION && !( word & bit ) ){
+							word |= bit;
+							out.cardinality++;
+						} else if ( op == ROARING_DIFFERENCE && ( word & bit ) ){
+							word &= ~bit;
+							out.cardinality--;
+						}
+					}
+				}
+				out.key = a.key;
+				if ( out.type == ROARING_BITMAP && out.cardinality <= ARRAY_MAX && out.cardinality > 0 )
+					this->to_array_(out);
+				this->release_chunk_(expanded[0]);
+				this->release_chunk_(expanded[1]);
+			}
+
+			/**
+			 * Merges the chunks of both sets by key. Chunks of the container only in it
+			 * are kept as they are by the union and the difference.
+			 */
+			void set_operation_( const roaring_set &other, int op ){
+				chunk_vector	result;
+				size_type		i = 0;
+				size_type		j = 0;
+				size_type		size = 0;
+
+				if ( this == &other ){
+					if ( op == ROARING_DIFFERENCE )
+						this->clear();
+					return ;
+				}
+				while ( i < m_chunks.size() || j < other.m_chunks.size() ){
+					if ( j == other.m_chunks.size() || ( i < m_chunks.size() && m_chunks[i].key < other.m_chunks[j].key ) ){
+						if ( op == ROARING_INTERSECTION )
+							this->release_chunk_(m_chunks[i]);
+						else
+							result.push_back(m_chunks[i]);
+						i++;
+					} else if ( i == m_chunks.size() || other.m_chunks[j].key < m_chunks[i].key ){
+						if ( op == ROARING_UNION )
+							result.push_back(this->copy_chunk_(other.m_chunks[j]));
+						j++;
+					} else {
+						roaring_chunk out;
+
+						this->combine_(m_chunks[i], other.m_chunks[j], op, out);
+						this->release_chunk_(m_chunks[i]);
+						if ( out.cardinality != 0 )
+							result.push_back(out);
+						else
+							this->release_chunk_(out);
+						i++;
+						j++;
+					}
+				}
+				for ( size_type index = 0 ; index < result.size() ; index++ ){
+					size += result[index].cardinality;
+				}
+				m_chunks.swap(result);
+				m_size = size;
+			}
+	};
+
+	template<class Alloc>
+	void swap( roaring_set<Alloc> &x, roaring_set<Alloc> &y ){
+		x.swap( y );
+	}
+
+	template <class Alloc>
+	bool operator==( const roaring_set<Alloc>& x, const roaring_set<Alloc>& y ){
+		return x.size() == y.size() && ft::equal(x.begin(), x.end(), y.begin(), y.end());
+	}
+
+	template <class Alloc>
+	bool operator!=( const roaring_set<Alloc>& x, const roaring_set<Alloc>& y ){
+		return !(x == y);
+	}
+
+	template <class Alloc>
+	bool operator< ( const roaring_set<Alloc>& x, const roaring_set<Alloc>& y ){
+		return ft::lexicographical_compare(x.begin(), x.end(), y.begin(), y.end());
+	}
+
+	template <class Alloc>
+	bool operator<=( const roaring_set<Alloc>& x, const roaring_set<Alloc>& y ){
+		return !( y < x );
+	}
+
+	template <class Alloc>
+	bool operator> ( const roaring_set<Alloc>& x, const roaring_set<Alloc>& y ){
+		return y < x;
+	}
+
+	template <class Alloc>
+	bool operator>=( const roaring_set<Alloc>& x, const roaring_set<Alloc>& y ){
+		return !( x < y );
+	}
+}
+
+#endif
@@ -0,0 +1,545 @@
+#ifndef SPLAY_MAP_HPP
+#define SPLAY_MAP_HPP
+
+# include "map.hpp"
+
+namespace ft {
+	/**
+	 * Splay map
+	 *
+	 * Associative container with the interface of ft::map, kept as a self-adjusting
+	 * binary search tree: every insertion, erasure and lookup through a non-const map
+	 * moves the deepest node it reached to the root by splaying. Recently accessed keys
+	 * thus sit near the root, and a lookup costs O(log n) amortized, much less when the
+	 * accesses are skewed towards a small working set, even if it drifts over time.
+	 *
+	 * Nodes, sentinels and iterators are the ones of ft::map, so iterating is unchanged.
+	 * The tree may momentarily be a long path, every walk over it is iterative. Lookups
+	 * through a const map do not splay and leave the tree untouched, so they can run
+	 * concurrently; lookups through a non-const one modify it, even find.
+	 *
+	 */
+	template<
+		class Key,
+		class T,
+		class Compare = std::less<Key>,
+		class Alloc = std::allocator<ft::pair<const Key, T> >
+	>
+	class splay_map {
+		public:
+			typedef Key												key_type;
+			typedef T												mapped_type;
+			typedef ft::pair<const key_type, mapped_type>			value_type;
+			typedef Compare											key_compare;
+			typedef Alloc											allocator_type;
+			typedef typename allocator_type::reference				reference;
+			typedef typename allocator_type::const_reference		const_reference;
+			typedef typename allocator_type::pointer				pointer;
+			typedef typename allocator_type::const_pointer			const_pointer;
+			typedef std::ptrdiff_t									difference_type;
+			typedef std::size_t										size_type;
+			typedef rb_iterator<value_type>							iterator;
+			typedef rb_const_iterator<value_type>					const_iterator;
+			typedef ft::reverse_iterator<iterator>					reverse_iterator;
+			typedef ft::reverse_iterator<const_iterator>			const_reverse_iterator;
+
+			class value_compare : std::binary_function<value_type, value_type, bool> {
+				friend class splay_map;
+				protected:
+					Compare m_comp;
+					value_compare(Compare comp) : m_comp(comp) {}
+				public:
+					typedef bool result_type;
+					typedef value_type first_argument_type;
+					typedef value_type second_argument_type;
+					bool operator()(const value_type &x, const value_type &y) const {
+						return m_comp(x.first, y.first);
+					}
+			};
+
+		private:
+			typedef rb_node<value_type>			node_type;
+			typedef typename node_type::pointer	node_pointer;
+
+			node_pointer		m_root;
+			size_type			m_size;
+			key_compare			m_comp;
+			allocator_type		m_alloc;
+			node_pointer		m_right_sentinel;
+			node_pointer		m_left_sentinel;
+
+		public:
+			explicit splay_map( const key_compare &comp = key_compare(), const allocator_type &alloc = allocator_type() )
+				:   m_root( NULL ),
+					m_size( 0 ),
+					m_comp( comp ),
+					m_alloc( alloc ),
+					m_right_sentinel( node_type::create_sentinel_node() ),
+					m_left_sentinel( node_type::create_sentinel_node() )
+			{
+			}
+
+			template<class InputIterator>
+			splay_map( InputIterator first, InputIterator last, const key_compare &comp = key_compare(),
+				const allocator_type &alloc = allocator_type() )
+				:   m_root( NULL ),
+					m_size( 0 ),
+					m_comp( comp ),
+					m_alloc( alloc ),
+					m_right_sentinel( node_type::create_sentinel_node() ),
+					m_left_sentinel( node_type::create_sentinel_node() )
+			{
+				this->insert(first, last);
+			}
+
+			/**
+			 * Copies are made in key order, each new element becoming the right child of
+			 * the root, so copying takes O(n).
+			 */
+			splay_map( const splay_map &x )
+				:   m_root( NULL ),
+					m_size( 0 ),
+					m_comp( x.m_comp ),
+					m_alloc( x.m_alloc ),
+					m_right_sentinel( node_type::create_sentinel_node() ),
+					m_left_sentinel( node_type::create_sentinel_node() )
+			{
+				this->insert(x.begin(), x.end());
+			}
+
+			splay_map &operator=( const splay_map &x ){
+				if ( this == &x )
+					return *this;
+				this->clear();
+				m_comp = x.m_comp;
+				this->insert(x.begin(), x.end());
+				return *this;
+			}
+
+			~splay_map(){
+				this->clear();
+				node_type::destroy_node(m_right_sentinel);
+				node_type::destroy_node(m_left_sentinel);
+			}
+
+			/**
+			 * Iterators
+			 */
+			iterator begin(){
+				if ( m_root == NULL )
+					return end();
+				return iterator( m_left_sentinel->parent );
+			}
+
+			const_iterator begin() const {
+				if ( m_root == NULL )
+					return end();
+				return const_iterator( m_left_sentinel->parent );
+			}
+
+			iterator end(){ return iterator( m_right_sentinel ); }
+			const_iterator end() const { return const_iterator( m_right_sentinel ); }
+			reverse_iterator rbegin(){ return reverse_iterator( end() ); }
+			const_reverse_iterator rbegin() const { return const_reverse_iterator( end() ); }
+			reverse_iterator rend(){ return reverse_iterator( begin() ); }
+			const_reverse_iterator rend() const { return const_reverse_iterator( begin() ); }
+
+			/**
+			 * Capacity
+			 */
+			bool empty() const { return m_size == 0; }
+			size_type size() const { return m_size; }
+			size_type max_size() const { return node_type().max_size(); }
+
+			/**
+			 * Element access
+			 */
+			mapped_type &operator[]( const key_type &k ){
+				return this->insert( value_type( k, mapped_type() ) ).first->second;
+			}
+
+			/**
+			 * Modifiers
+			 *
+			 * The element inserted, or the one already holding its key, is splayed. An erased
+			 * element is splayed before it is unlinked, its in-order predecessor then taking
+			 * its place at the root.
+			 */
+			ft::pair<iterator, bool> insert( const value_type &val ){
+				node_pointer	x = m_root;
+				node_pointer	parent = NULL;
+				node_pointer	node;
+				bool			left = false;
+
+				while ( x != NULL && !x->is_sentinel() ){
+					parent = x;
+					if ( m_comp(val.first, x->data.first) ){
+						left = true;
+						x = x->left;
+					} else if ( m_comp(x->data.first, val.first) ){
+						left = false;
+						x = x->right;
+					} else {
+						this->splay_(x);
+						return ft::make_pair(iterator( x ), false);
+					}
+				}
+				node = node_type::create_node(val);
+				node->parent = parent;
+				m_size++;
+				if ( parent == NULL ){
+					m_root = node;
+					m_root->set_left(m_left_sentinel);
+					m_root->set_right(m_right_sentinel);
+					return ft::make_pair(iterator( node ), true);
+				}
+				if ( left ){
+					if ( parent->left != NULL )
+						node->set_left(m_left_sentinel);
+					parent->left = node;
+				} else {
+					if ( parent->right != NULL )
+						node->set_right(m_right_sentinel);
+					parent->right = node;
+				}
+				this->splay_(node);
+				return ft::make_pair(iterator( node ), true);
+			}
+
+			iterator insert( iterator position, const value_type &val ){
+				(void)position;
+				return this->insert(val).first;
+			}
+
+			template<class InputIterator>
+			void insert( InputIterator first, InputIterator last ){
+				for ( ; first != last ; ++first ){
+					this->insert(*first);
+				}
+			}
+
+			void erase( iterator position ){
+				node_pointer z = position.m_ptr;
+				node_pointer left;
+				node_pointer right;
+				node_pointer x;
+
+				if ( position == this->end() )
+					return ;
+				this->splay_(z);
+				left = z->left;
+				right = z->right;
+				if ( left != NULL && !left->is_sentinel() ){
+					// The predecessor of z becomes the root, without a right child
+					left->parent = NULL;
+					for ( x = left ; x->right != NULL ; x = x->right ) ;
+					this->splay_(x);
+					x->right = right;
+					if ( right != NULL )
+						right->parent = x;
+				} else if ( right != NULL && !right->is_sentinel() ){
+					right->parent = NULL;
+					m_root = right;
+					if ( left != NULL ){
+						for ( x = right ; x->left != NULL ; x = x->left ) ;
+						this->splay_(x);
+						x->set_left(left);
+					}
+				} else {
+					m_root = NULL;
+				}
+				node_type::destroy_node(z);
+				m_size--;
+			}
+
+			size_type erase( const key_type &k ){
+				iterator it = this->find(k);
+
+				if ( it == this->end() )
+					return 0;
+				this->erase(it);
+				return 1;
+			}
+
+			void erase( iterator first, iterator last ){
+				while ( first != last ){
+					this->erase(first++);
+				}
+			}
+
+			void swap( splay_map &x ){
+				node_pointer	tmp_root = x.m_root;
+				size_type		tmp_size = x.m_size;
+				key_compare		tmp_comp = x.m_comp;
+				allocator_type	tmp_alloc = x.m_alloc;
+				node_pointer	tmp_right = x.m_right_sentinel;
+				node_pointer	tmp_left = x.m_left_sentinel;
+
+				x.m_root = m_root;
+				x.m_size = m_size;
+				x.m_comp = m_comp;
+				x.m_alloc = m_alloc;
+				x.m_right_sentinel = m_right_sentinel;
+				x.m_left_sentinel = m_left_sentinel;
+				m_root = tmp_root;
+				m_size = tmp_size;
+				m_comp = tmp_comp;
+				m_alloc = tmp_alloc;
+				m_right_sentinel = tmp_right;
+				m_left_sentinel = tmp_left;
+			}
+
+			/**
+			 * Destroys every node in post order, climbing back through parent pointers
+			 * instead of recursing.
+			 */
+			void clear(){
+				node_pointer x = m_root;
+				node_pointer parent;
+
+				if ( m_root == NULL )
+					return ;
+				m_left_sentinel->parent->left = NULL;
+				m_right_sentinel->parent->right = NULL;
+				while ( x != NULL ){
+					if ( x->left != NULL ){
+						x = x->left;
+					} else if ( x->right != NULL ){
+						x = x->right;
+					} else {
+						parent = x->parent;
+						if ( parent != NULL ){
+							if ( parent->left == x )
+								parent->left = NULL;
+							else
+								parent->right = NULL;
+						}
+						node_type::destroy_node(x);
+						x = parent;
+					}
+				}
+				m_root = NULL;
+				m_size = 0;
+			}
+
+			/**
+			 * Observers
+			 */
+			key_compare key_comp() const { return m_comp; }
+			value_compare value_comp() const { return value_compare( m_comp ); }
+			allocator_type get_allocator() const { return m_alloc; }
+
+			/**
+			 * Operations
+			 *
+			 * Non-const lookups splay the last node of their descent, found or not, which
+			 * pays for the descent in the amortized bound.
+			 */
+			iterator find( const key_type &k ){
+				node_pointer last;
+				node_pointer lower = this->lower_bound_(k, last);
+
+				this->splay_(last);
+				if ( lower == NULL || m_comp(k, lower->data.first) )
+					return this->end();
+				return iterator( lower );
+			}
+
+			const_iterator find( const key_type &k ) const {
+				node_pointer last;
+				node_pointer lower = this->lower_bound_(k, last);
+
+				if ( lower == NULL || m_comp(k, lower->data.first) )
+					return this->end();
+				return const_iterator( lower );
+			}
+
+			size_type count( const key_type &k ) const {
+				return ( this->find(k) == this->end() ) ? 0 : 1;
+			}
+
+			iterator lower_bound( const key_type &k ){
+				node_pointer last;
+				node_pointer lower = this->lower_bound_(k, last);
+
+				this->splay_(last);
+				return ( lower == NULL ) ? this->end() : iterator( lower );
+			}
+
+			const_iterator lower_bound( const key_type &k ) const {
+				node_pointer last;
+				node_pointer lower = this->lower_bound_(k, last);
+
+				return ( lower == NULL ) ? this->end() : const_iterator( lower );
+			}
+
+			iterator upper_bound( const key_type &k ){
+				node_pointer last;
+				node_pointer upper = this->upper_bound_(k, last);
+
+				this->splay_(last);
+				return ( upper == NULL ) ? this->end() : iterator( upper );
+			}
+
+			const_iterator upper_bound( const key_type &k ) const {
+				node_pointer last;
+				node_pointer upper = this->upper_bound_(k, last);
+
+				return ( upper == NULL ) ? this->end() : const_iterator( upper );
+			}
+
+			ft::pair<iterator, iterator> equal_range( const key_type &k ){
+				iterator lower = this->lower_bound(k);
+
+				if ( lower != this->end() && !m_comp(k, lower->first) ){
+					iterator upper = lower;
+
+					return ft::make_pair(lower, ++upper);
+				}
+				return ft::make_pair(lower, lower);
+			}
+
+			ft::pair<const_iterator, const_iterator> equal_range( const key_type &k ) const {
+				const_iterator lower = this->lower_bound(k);
+
+				if ( lower != this->end() && !m_comp(k, lower->first) ){
+					const_iterator upper = lower;
+
+					return ft::make_pair(lower, ++upper);
+				}
+				return ft::make_pair(lower, lower);
+			}
+
+		private:
+			/**
+			 * Lower and upper bounds of k, NULL standing for end(), with the last node of
+			 * the descent in last.
+			 */
+			node_pointer lower_bound_( const key_type &k, node_pointer &last ) const {
+				node_pointer x = m_root;
+				node_pointer lower = NULL;
+
+				last = NULL;
+				while ( x != NULL && !x->is_sentinel() ){
+					last = x;
+					if ( m_comp(x->data.first, k) ){
+						x = x->right;
+					} else {
+						lower = x;
+						if ( !m_comp(k, x->data.first) )
+							break ;
+						x = x->left;
+					}
+				}
+				return lower;
+			}
+
+			node_pointer upper_bound_( const key_type &k, node_pointer &last ) const {
+				node_pointer x = m_root;
+				node_pointer upper = NULL;
+
+				last = NULL;
+				while ( x != NULL && !x->is_sentinel() ){
+					last = x;
+					if ( m_comp(k, x->data.first) ){
+						upper = x;
+						x = x->left;
+					} else {
+						x = x->right;
+					}
+				}
+				return upper;
+			}
+
+			/**
+			 * Rotates x above its parent. Sentinels move along with the subtrees holding
+			 * them and stay leaves.
+			 */
+			static void rotate_( node_pointer x ){
+				node_pointer p = x->parent;
+				node_pointer g = p->parent;
+
+				if ( x == p->left ){
+					p->left = x->right;
+					if ( p->left != NULL )
+						p->left->parent = p;
+					x->right = p;
+				} else {
+					p->right = x->left;
+					if ( p->right != NULL )
+						p->right->parent = p;
+					x->left = p;
+				}
+				p->parent = x;
+				x->parent = g;
+				if ( g != NULL ){
+					if ( g->left == p )
+						g->left = x;
+					else
+						g->right = x;
+				}
+			}
+
+			/**
+			 * Bottom-up splay of x to the root of its tree, by zig-zig and zig-zag steps
+			 * and a last zig. Does nothing when x is NULL.
+			 */
+			void splay_( node_pointer x ){
+				node_pointer p;
+				node_pointer g;
+
+				if ( x == NULL )
+					return ;
+				while ( ( p = x->parent ) != NULL ){
+					g = p->parent;
+					if ( g == NULL ){
+						rotate_(x);
+					} else if ( ( x == p->left ) == ( p == g->left ) ){
+						rotate_(p);
+						rotate_(x);
+					} else {
+						rotate_(x);
+						rotate_(x);
+					}
+				}
+				m_root = x;
+			}
+	};
+
+	template<class Key, class T, class Compare, class Alloc>
+	void swap( splay_map<Key, T, Compare, Alloc> &x, splay_map<Key, T, Compare, Alloc> &y ){
+		x.swap( y );
+	}
+
+	template <class Key, class T, class Compare, class Alloc>
+	bool operator==( const splay_map<Key,T,Compare,Alloc>& x, const splay_map<Key,T,Compare,Alloc>& y ){
+		return x.size() == y.size() && equal(x.begin(), x.end(), y.begin(), y.end());
+	}
+
+	template <class Key, class T, class Compare, class Alloc>
+	bool operator!=( const splay_map<Key,T,Compare,Alloc>& x, const splay_map<Key,T,Compare,Alloc>& y ){
+		return !(x == y);
+	}
+
+	template <class Key, class T, class Compare, class Alloc>
+	bool operator< ( const splay_map<Key,T,Compare,Alloc>& x, const splay_map<Key,T,Compare,Alloc>& y ){
+		return lexicographical_compare(x.begin(), x.end(), y.begin(), y.end());
+	}
+
+	template <class Key, class T, class Compare, class Alloc>
+	bool operator<=( const splay_map<Key,T,Compare,Alloc>& x, const splay_map<Key,T,Compare,Alloc>& y ){
+		return !( y < x );
+	}
+
+	template <class Key, class T, class Compare, class Alloc>
+	bool operator> ( const splay_map<Key,T,Compare,Alloc>& x, const splay_map<Key,T,Compare,Alloc>& y ){
+		return y < x;
+	}
+
+	template <class Key, class T, class Compare, class Alloc>
+	bool operator>=( const splay_map<Key,T,Compare,Alloc>& x, const splay_map<Key,T,Compare,Alloc>& y ){
+		return !( x < y );
+	}
+}
+
+#endif
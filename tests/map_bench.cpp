@@ -0,0 +1,1510 @@
+#include <sys/time.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <malloc.h>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <map>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <iterator>
+#include "../map.hpp"
+#include "../interval_map.hpp"
+#include "../splay_map.hpp"
+#include "../adaptive_map.hpp"
+#include "../radix_map.hpp"
+#include "../trie_map.hpp"
+#include "../bitmap_set.hpp"
+#include "../roaring_set.hpp"
+#include "../lazy_sorted_vector.hpp"
+#include "../buffered_map.hpp"
+
+class Chrono {
+    struct timeval m_begin;
+    struct timeval m_end;
+
+public:
+    void begin() {
+        gettimeofday(&m_begin, NULL);
+    }
+
+    void end() {
+        gettimeofday(&m_end, NULL);
+    }
+
+    double get_duration_ms() const {
+        return (
+                (double)(m_end.tv_usec - m_begin.tv_usec) / 1000000 +
+                (double)(m_end.tv_sec  - m_begin.tv_sec)) * 1000;
+    }
+};
+
+void    print_header(const char *name){
+    int padding = -20;
+
+    printf("\n== %s\n", name);
+    printf("%*s %*s\n", padding, "NAME", padding, "DURATION (ms)");
+}
+
+void    print_row(const char *name, double duration){
+    int padding = -20;
+
+    printf("%*s %*.2f\n", padding, name, padding, duration);
+}
+
+/*
+ * Runs a case in a child process, so that it starts from a fresh heap whatever
+ * the cases before it allocated and freed.
+ */
+void    run_isolated(void (*run)(int), int arg){
+    int pid;
+
+    fflush(stdout);
+    pid = fork();
+    if ( pid == -1 )
+        return ;
+    if ( pid == 0 ){
+        run(arg);
+        fflush(stdout);
+        exit(EXIT_SUCCESS);
+    }
+    waitpid(pid, NULL, 0);
+}
+
+void    erase_range_std(int size){
+    std::map<int, int>  map;
+    Chrono              chrono;
+
+    for ( int i = 0 ; i < size ; i++ )
+        map.insert(std::make_pair(i + 1, 0));
+    chrono.begin();
+    map.erase(map.find(50000), map.find(900000));
+    chrono.end();
+    print_row("std::map", chrono.get_duration_ms());
+}
+
+void    erase_range_ft(int size){
+    ft::map<int, int>   map;
+    Chrono              chrono;
+
+    for ( int i = 0 ; i < size ; i++ )
+        map.insert(ft::make_pair(i + 1, 0));
+    chrono.begin();
+    map.erase(map.find(50000), map.find(900000));
+    chrono.end();
+    print_row("ft::map", chrono.get_duration_ms());
+}
+
+/*
+ * Erase of [50000, 900000) in a map of 10M keys, test_map_time at 10x scale.
+ */
+void    bench_erase_range(){
+    print_header("erase_range [50000, 900000) of 10M keys");
+    run_isolated(erase_range_std, 10000000);
+    run_isolated(erase_range_ft, 10000000);
+}
+
+struct KeyBelow {
+    int m_limit;
+
+    KeyBelow(int limit) : m_limit(limit) {}
+
+    template<class Pair>
+    bool operator()(const Pair &x) const { return x.first % 100 < m_limit; }
+};
+
+template<class Map, class Pair>
+void    fill_shuffled(Map &map, int size){
+    for ( int i = 0 ; i < size ; i++ )
+        map.insert(Pair((int)((i * 2654435761u) % size), 0));
+}
+
+template<class Map>
+void    erase_loop(Map &map, KeyBelow pred){
+    for ( typename Map::iterator it = map.begin() ; it != map.end() ; ){
+        if ( pred(*it) )
+            map.erase(it++);
+        else
+            ++it;
+    }
+}
+
+void    erase_if_std_loop(int percent){
+    std::map<int, int>  map;
+    Chrono              chrono;
+    char                name[64];
+
+    fill_shuffled<std::map<int, int>, std::pair<int, int> >(map, 2000000);
+    chrono.begin();
+    erase_loop(map, KeyBelow(percent));
+    chrono.end();
+    sprintf(name, "std::map loop %d%%", percent);
+    print_row(name, chrono.get_duration_ms());
+}
+
+void    erase_if_ft_loop(int percent){
+    ft::map<int, int>   map;
+    Chrono              chrono;
+    char                name[64];
+
+    fill_shuffled<ft::map<int, int>, ft::pair<int, int> >(map, 2000000);
+    chrono.begin();
+    erase_loop(map, KeyBelow(percent));
+    chrono.end();
+    sprintf(name, "ft::map loop %d%%", percent);
+    print_row(name, chrono.get_duration_ms());
+}
+
+void    erase_if_ft(int percent){
+    ft::map<int, int>   map;
+    Chrono              chrono;
+    char                name[64];
+
+    fill_shuffled<ft::map<int, int>, ft::pair<int, int> >(map, 2000000);
+    chrono.begin();
+    ft::erase_if(map, KeyBelow(percent));
+    chrono.end();
+    sprintf(name, "ft::erase_if %d%%", percent);
+    print_row(name, chrono.get_duration_ms());
+}
+
+/*
+ * Predicate driven removal of 10% to 90% of a map of 2M shuffled keys.
+ */
+void    bench_erase_if(){
+    const int percents[4] = { 10, 30, 60, 90 };
+
+    print_header("erase_if on 2M keys");
+    for ( int p = 0 ; p < 4 ; p++ ){
+        run_isolated(erase_if_std_loop, percents[p]);
+        run_isolated(erase_if_ft_loop, percents[p]);
+        run_isolated(erase_if_ft, percents[p]);
+    }
+}
+
+const char *g_set_ops[3] = { "union", "intersection", "difference" };
+
+/*
+ * Sessions hold 4M keys, the blocklist 1M keys of which half are sessions.
+ */
+template<class Map, class Pair>
+void    fill_sessions(Map &sessions, Map &blocklist){
+    for ( int i = 0 ; i < 4000000 ; i++ )
+        sessions.insert(Pair(i * 2, i));
+    for ( int i = 0 ; i < 1000000 ; i++ )
+        blocklist.insert(Pair(i * 4 + ( i & 1 ), -i));
+}
+
+void    set_op_std(int op){
+    typedef std::map<int, int>  Map;
+    Map                         sessions;
+    Map                         blocklist;
+    Map                         result;
+    std::insert_iterator<Map>   out(result, result.end());
+    Chrono                      chrono;
+    char                        name[64];
+
+    fill_sessions<Map, Map::value_type>(sessions, blocklist);
+    chrono.begin();
+    if ( op == 0 )
+        std::set_union(sessions.begin(), sessions.end(), blocklist.begin(), blocklist.end(), out, sessions.value_comp());
+    else if ( op == 1 )
+        std::set_intersection(sessions.begin(), sessions.end(), blocklist.begin(), blocklist.end(), out, sessions.value_comp());
+    else
+        std::set_difference(sessions.begin(), sessions.end(), blocklist.begin(), blocklist.end(), out, sessions.value_comp());
+    chrono.end();
+    sprintf(name, "std::%s", g_set_ops[op]);
+    print_row(name, chrono.get_duration_ms());
+}
+
+void    set_op_ft(int arg){
+    typedef ft::map<int, int>   Map;
+    Map                         sessions;
+    Map                         blocklist;
+    Chrono                      chrono;
+    char                        name[64];
+    int                         op = arg / 1000;
+    int                         threads = arg % 1000;
+
+    fill_sessions<Map, Map::value_type>(sessions, blocklist);
+    chrono.begin();
+    if ( op == 0 )
+        ft::map_union(sessions, blocklist, threads);
+    else if ( op == 1 )
+        ft::map_intersection(sessions, blocklist, threads);
+    else
+        ft::map_difference(sessions, blocklist, threads);
+    chrono.end();
+    sprintf(name, "ft::%s x%d", g_set_ops[op], threads);
+    print_row(name, chrono.get_duration_ms());
+}
+
+/*
+ * Set operations between 4M sessions and a 1M blocklist, the std baseline being a
+ * merge of the iterators into a new map, against the join based operations on 1
+ * thread up to every core.
+ */
+void    bench_set_ops(){
+    int threads[5] = { 1, 2, 4, 16, (int)ft::hardware_concurrency() };
+
+    print_header("set operations, 4M and 1M keys");
+    for ( int op = 0 ; op < 3 ; op++ ){
+        run_isolated(set_op_std, op);
+        for ( int t = 0 ; t < 5 ; t++ )
+            run_isolated(set_op_ft, op * 1000 + threads[t]);
+    }
+}
+
+/*
+ * Unsorted rows with about one duplicate key in ten.
+ */
+void    fill_rows(ft::vector<ft::pair<int, int> > &rows, int size){
+    rows.reserve(size);
+    for ( int i = 0 ; i < size ; i++ )
+        rows.push_back(ft::make_pair((int)((i * 2654435761u) % (size - size / 10)), i));
+}
+
+void    bulk_load_range(int size){
+    ft::vector<ft::pair<int, int> > rows;
+    Chrono                          chrono;
+
+    fill_rows(rows, size);
+    chrono.begin();
+    ft::map<int, int>   map(rows.begin(), rows.end());
+    chrono.end();
+    print_row("range constructor", chrono.get_duration_ms());
+}
+
+void    bulk_load_threads(int threads){
+    ft::vector<ft::pair<int, int> > rows;
+    ft::map<int, int>               map;
+    Chrono                          chrono;
+    char                            name[64];
+
+    fill_rows(rows, 5000000);
+    chrono.begin();
+    map.bulk_load(rows.begin(), rows.end(), threads);
+    chrono.end();
+    sprintf(name, "bulk_load x%d", threads);
+    print_row(name, chrono.get_duration_ms());
+}
+
+/*
+ * Load of 5M unsorted rows, one insert at a time against bulk_load on 1 thread up
+ * to every core.
+ */
+void    bench_bulk_load(){
+    int threads[4] = { 1, 4, 16, (int)ft::hardware_concurrency() };
+
+    print_header("load of 5M unsorted rows");
+    run_isolated(bulk_load_range, 5000000);
+    for ( int t = 0 ; t < 4 ; t++ )
+        run_isolated(bulk_load_threads, threads[t]);
+}
+
+/*
+ * A live map of 10M even keys, and a sorted batch of odd keys spread over it.
+ */
+void    fill_live(ft::map<int, int> &map, ft::vector<ft::pair<int, int> > &batch, int size){
+    ft::vector<ft::pair<int, int> > rows;
+
+    for ( int i = 0 ; i < 10000000 ; i++ )
+        rows.push_back(ft::make_pair(i * 2, i));
+    map.bulk_load(rows.begin(), rows.end());
+    for ( int i = 0 ; i < size ; i++ )
+        batch.push_back(ft::make_pair((int)(((long)i * 10000000 / size + i % 7) * 2 + 1), i));
+}
+
+void    batch_insert_loop(int size){
+    ft::map<int, int>               map;
+    ft::vector<ft::pair<int, int> > batch;
+    Chrono                          chrono;
+    char                            name[64];
+
+    fill_live(map, batch, size);
+    chrono.begin();
+    for ( ft::vector<ft::pair<int, int> >::iterator it = batch.begin() ; it != batch.end() ; ++it )
+        map.insert(*it);
+    chrono.end();
+    sprintf(name, "insert loop %dk", size / 1000);
+    print_row(name, chrono.get_duration_ms());
+}
+
+void    batch_insert_sorted(int size){
+    ft::map<int, int>               map;
+    ft::vector<ft::pair<int, int> > batch;
+    Chrono                          chrono;
+    char                            name[64];
+
+    fill_live(map, batch, size);
+    chrono.begin();
+    map.insert_sorted_batch(batch.begin(), batch.end());
+    chrono.end();
+    sprintf(name, "sorted batch %dk", size / 1000);
+    print_row(name, chrono.get_duration_ms());
+}
+
+/*
+ * Sorted batches of 10K to 1M keys into a map of 10M keys.
+ */
+void    bench_sorted_batch(){
+    const int sizes[3] = { 10000, 100000, 1000000 };
+
+    print_header("sorted batch insert into 10M keys");
+    for ( int s = 0 ; s < 3 ; s++ ){
+        run_isolated(batch_insert_loop, sizes[s]);
+        run_isolated(batch_insert_sorted, sizes[s]);
+    }
+}
+
+/*
+ * 16M keys in shuffled insertion order, well past the last level cache, and random
+ * lookups by batches of size keys, half of them missing.
+ */
+void    lookup_case(int size, bool batched){
+    typedef ft::map<int, int>   Map;
+    Map                         map;
+    ft::vector<int>             keys;
+    ft::vector<Map::iterator>   out(size);
+    Chrono                      chrono;
+    char                        name[64];
+    long                        sum = 0;
+    const int                   count = 16000000;
+
+    for ( int i = 0 ; i < count ; i++ )
+        map.insert(ft::make_pair((int)((i * 2654435761u) % count) * 2, i));
+    srand(42);
+    for ( int i = 0 ; i < 4000000 ; i++ )
+        keys.push_back(rand() % (count * 2));
+    chrono.begin();
+    for ( int i = 0 ; i + size <= (int)keys.size() ; i += size ){
+        if ( batched ){
+            map.find_batch(keys.begin() + i, keys.begin() + i + size, out.begin());
+        } else {
+            for ( int k = 0 ; k < size ; k++ )
+                out[k] = map.find(keys[i + k]);
+        }
+        for ( int k = 0 ; k < size ; k++ )
+            sum += ( out[k] != map.end() );
+    }
+    chrono.end();
+    sprintf(name, "%s %d", batched ? "find_batch" : "find loop", size);
+    print_row(name, chrono.get_duration_ms());
+    if ( sum < 0 )
+        printf("%ld\n", sum);
+}
+
+void    lookup_loop(int size){
+    lookup_case(size, false);
+}
+
+void    lookup_batch(int size){
+    lookup_case(size, true);
+}
+
+/*
+ * 4M random lookups in a map of 16M keys.
+ */
+void    bench_find_batch(){
+    const int sizes[2] = { 64, 512 };
+
+    print_header("4M lookups in 16M keys");
+    for ( int s = 0 ; s < 2 ; s++ ){
+        run_isolated(lookup_loop, sizes[s]);
+        run_isolated(lookup_batch, sizes[s]);
+    }
+}
+
+void    seek_case(int step, bool use_cursor){
+    typedef ft::map<int, int>   Map;
+    Map                         map;
+    Chrono                      chrono;
+    char                        name[64];
+    long                        sum = 0;
+    const int                   count = 10000000;
+
+    for ( int i = 0 ; i < count ; i++ )
+        map.insert(ft::make_pair((int)((i * 2654435761u) % count), i));
+    Map::cursor                 cursor(map);
+
+    srand(42);
+    chrono.begin();
+    for ( int key = 0 ; key < count ; key += 1 + rand() % step ){
+        if ( use_cursor )
+            sum += cursor.seek(key)->second;
+        else
+            sum += map.lower_bound(key)->second;
+    }
+    chrono.end();
+    sprintf(name, "%s step %d", use_cursor ? "cursor" : "lower_bound", step);
+    print_row(name, chrono.get_duration_ms());
+    if ( sum < 0 )
+        printf("%ld\n", sum);
+}
+
+void    seek_lower_bound(int step){
+    seek_case(step, false);
+}
+
+void    seek_cursor(int step){
+    seek_case(step, true);
+}
+
+/*
+ * Seeks on slowly increasing keys through a map of 10M keys, keys growing by a
+ * random step between 1 and step.
+ */
+void    bench_cursor(){
+    const int steps[3] = { 4, 64, 1024 };
+
+    print_header("increasing seeks in 10M keys");
+    for ( int s = 0 ; s < 3 ; s++ ){
+        run_isolated(seek_lower_bound, steps[s]);
+        run_isolated(seek_cursor, steps[s]);
+    }
+}
+
+void    reserve_case(int reserve){
+    ft::map<int, int>   map;
+    Chrono              chrono;
+    char                name[64];
+    long                sum = 0;
+    const int           count = 100000;
+
+    chrono.begin();
+    for ( int round = 0 ; round < 50 ; round++ ){
+        if ( reserve )
+            map.reserve(count);
+        for ( int i = 0 ; i < count ; i++ )
+            map.insert(ft::make_pair((int)((i * 2654435761u) % count), i));
+        for ( int i = 0 ; i < count ; i += 2 )
+            map.erase((int)((i * 2654435761u) % count));
+        for ( ft::map<int, int>::iterator it = map.begin() ; it != map.end() ; ++it )
+            sum += it->second;
+        map.clear();
+    }
+    chrono.end();
+    sprintf(name, "%s", reserve ? "reserve" : "no reserve");
+    print_row(name, chrono.get_duration_ms());
+    if ( sum < 0 )
+        printf("%ld\n", sum);
+}
+
+/*
+ * 50 rounds of filling a map with 100K shuffled keys, erasing half of them, scanning
+ * and clearing it, with and without reserve.
+ */
+void    bench_reserve(){
+    print_header("reserve, 50 x 100K keys");
+    run_isolated(reserve_case, 0);
+    run_isolated(reserve_case, 1);
+}
+
+void    scan_and_lookup(ft::map<int, int> &map, int count, const char *label){
+    Chrono      chrono;
+    char        name[64];
+    long        sum = 0;
+
+    chrono.begin();
+    for ( ft::map<int, int>::iterator it = map.begin() ; it != map.end() ; ++it )
+        sum += it->second;
+    chrono.end();
+    sprintf(name, "%s scan", label);
+    print_row(name, chrono.get_duration_ms());
+    srand(42);
+    chrono.begin();
+    for ( int i = 0 ; i < 1000000 ; i++ ){
+        ft::map<int, int>::iterator it = map.find(rand() % count);
+
+        if ( it != map.end() )
+            sum += it->second;
+    }
+    chrono.end();
+    sprintf(name, "%s lookup", label);
+    print_row(name, chrono.get_duration_ms());
+    if ( sum < 0 )
+        printf("%ld\n", sum);
+}
+
+void    compact_case(int count){
+    ft::map<int, int>   map;
+    Chrono              chrono;
+
+    for ( int i = 0 ; i < count ; i++ )
+        map.insert(ft::make_pair((int)((i * 2654435761u) % count), i));
+    srand(7);
+    for ( int i = 0 ; i < count ; i++ ){
+        map.erase(rand() % count);
+        map.insert(ft::make_pair(rand() % count, i));
+    }
+    scan_and_lookup(map, count, "fragmented");
+    chrono.begin();
+    map.compact();
+    chrono.end();
+    print_row("compact", chrono.get_duration_ms());
+    scan_and_lookup(map, count, "compacted");
+}
+
+/*
+ * In-order scan and 1M random lookups on a map of 4M keys fragmented by shuffled
+ * insertion and as many erase and insert pairs, before and after compact.
+ */
+void    bench_compact(){
+    print_header("compact, 4M fragmented keys");
+    run_isolated(compact_case, 4000000);
+}
+
+struct SumValues {
+    long    operator()(long sum, const ft::pair<const int, int> &x) const { return sum + x.second; }
+    long    operator()(long a, long b) const { return a + b; }
+};
+
+void    reduce_case(int threads){
+    ft::map<int, int>   map;
+    Chrono              chrono;
+    char                name[64];
+    long                sum = 0;
+    const int           count = 8000000;
+
+    for ( int i = 0 ; i < count ; i++ )
+        map.insert(ft::make_pair((int)((i * 2654435761u) % count), i));
+    chrono.begin();
+    if ( threads == 0 ){
+        for ( ft::map<int, int>::iterator it = map.begin() ; it != map.end() ; ++it )
+            sum += it->second;
+    } else {
+        sum = ft::parallel_reduce(map, 0L, SumValues(), threads);
+    }
+    chrono.end();
+    if ( threads == 0 )
+        sprintf(name, "iterator loop");
+    else
+        sprintf(name, "parallel_reduce x%d", threads);
+    print_row(name, chrono.get_duration_ms());
+    if ( sum < 0 )
+        printf("%ld\n", sum);
+}
+
+/*
+ * Sum of the values of a map of 8M keys.
+ */
+void    bench_parallel_reduce(){
+    int threads[4] = { 1, 4, 16, (int)ft::hardware_concurrency() };
+
+    print_header("reduce over 8M keys");
+    run_isolated(reduce_case, 0);
+    for ( int t = 0 ; t < 4 ; t++ )
+        run_isolated(reduce_case, threads[t]);
+}
+
+struct SumAugment {
+    typedef long    summary_type;
+
+    long    identity() const { return 0; }
+    long    lift(const ft::pair<const int, int> &x) const { return x.second; }
+    long    combine(long a, long b) const { return a + b; }
+};
+
+typedef ft::map<int, int, std::less<int>, std::allocator<ft::pair<const int, int> >, SumAugment>   sum_map;
+
+template<class Map>
+void    fill_shuffled(Map &map, int count, Chrono &chrono){
+    chrono.begin();
+    for ( int i = 0 ; i < count ; i++ )
+        map.insert(ft::make_pair((int)((i * 2654435761u) % count), i));
+    chrono.end();
+}
+
+void    aggregate_case(int width){
+    const int           count = 1000000;
+    const int           queries = 20000;
+    Chrono              chrono;
+    char                name[64];
+    long                sum = 0;
+    int                 lo;
+
+    if ( width == 0 ){
+        ft::map<int, int>   plain;
+        sum_map             augmented;
+
+        fill_shuffled(plain, count, chrono);
+        print_row("insert plain", chrono.get_duration_ms());
+        fill_shuffled(augmented, count, chrono);
+        print_row("insert augmented", chrono.get_duration_ms());
+        return ;
+    }
+
+    sum_map             map;
+
+    fill_shuffled(map, count, chrono);
+    srand(7);
+    chrono.begin();
+    for ( int i = 0 ; i < queries ; i++ ){
+        lo = rand() % count;
+        for ( sum_map::iterator it = map.lower_bound(lo) ; it != map.end() && it->first < lo + width ; ++it )
+            sum += it->second;
+    }
+    chrono.end();
+    sprintf(name, "iterate %d", width);
+    print_row(name, chrono.get_duration_ms());
+    srand(7);
+    chrono.begin();
+    for ( int i = 0 ; i < queries ; i++ ){
+        lo = rand() % count;
+        sum -= map.aggregate(lo, lo + width);
+    }
+    chrono.end();
+    sprintf(name, "aggregate %d", width);
+    print_row(name, chrono.get_duration_ms());
+    if ( sum != 0 )
+        printf("mismatch %ld\n", sum);
+}
+
+/*
+ * 20k sums over random key ranges of a map of 1M keys, by iterating the range
+ * and by map::aggregate, and the cost of keeping the summaries on insertion.
+ */
+void    bench_aggregate(){
+    int widths[3] = { 10, 100, 1000 };
+
+    print_header("aggregate over 1M keys");
+    run_isolated(aggregate_case, 0);
+    for ( int w = 0 ; w < 3 ; w++ )
+        run_isolated(aggregate_case, widths[w]);
+}
+
+struct CountOut {
+    long    *count;
+
+    CountOut &operator*() { return *this; }
+    CountOut &operator++(int) { return *this; }
+    template<class It>
+    CountOut &operator=(const It &) { ++*count; return *this; }
+};
+
+void    interval_case(int use_tree){
+    const int                                   count = 1000000;
+    const int                                   queries = 100000;
+    const int                                   span = 100000000;
+    const int                                   max_length = 100000;
+    ft::interval_map<int, int>                  tree;
+    ft::map<ft::pair<int, int>, int>            map;
+    Chrono                                      chrono;
+    long                                        found = 0;
+
+    srand(11);
+    for ( int i = 0 ; i < count ; i++ ){
+        int lo = rand() % span;
+        int length = ( i % 1000 == 0 ) ? rand() % max_length : rand() % 1000;
+
+        if ( use_tree )
+            tree.insert(lo, lo + length, i);
+        else
+            map.insert(ft::make_pair(ft::make_pair(lo, lo + length), i));
+    }
+    srand(13);
+    chrono.begin();
+    for ( int i = 0 ; i < queries ; i++ ){
+        int a = rand() % span;
+        int b = a + rand() % 100;
+
+        if ( use_tree ){
+            CountOut out = { &found };
+
+            tree.overlapping(a, b, out);
+        } else {
+            // Every interval starting after b - max_length may reach a
+            ft::map<ft::pair<int, int>, int>::iterator it = map.upper_bound(ft::make_pair(b, span + max_length));
+
+            while ( it != map.begin() ){
+                --it;
+                if ( it->first.first < a - max_length )
+                    break ;
+                if ( it->first.second >= a )
+                    found++;
+            }
+        }
+    }
+    chrono.end();
+    print_row(use_tree ? "interval_map" : "map backward scan", chrono.get_duration_ms());
+    printf("%ld overlaps\n", found);
+}
+
+/*
+ * 100k overlap queries on 1M intervals, mostly short with one in a thousand up to
+ * 100k long, against lower bound and backward scan on a map bounded by the max length.
+ */
+void    bench_interval(){
+    print_header("overlap queries, 1M intervals");
+    run_isolated(interval_case, 0);
+    run_isolated(interval_case, 1);
+}
+
+long    g_comparisons = 0;
+
+struct CountingLess {
+    bool    operator()(int a, int b) const { g_comparisons++; return a < b; }
+};
+
+template<class Map>
+void    balance_case(const char *label, int ascending){
+    const int   count = 1000000;
+    Map         map;
+    Chrono      chrono;
+    char        name[64];
+    long        sum = 0;
+
+    srand(3);
+    chrono.begin();
+    for ( int i = 0 ; i < count ; i++ )
+        map.insert(ft::make_pair(ascending ? i * 4 : rand() % (count * 4), i));
+    chrono.end();
+    sprintf(name, "%s insert", label);
+    print_row(name, chrono.get_duration_ms());
+    g_comparisons = 0;
+    chrono.begin();
+    for ( int i = 0 ; i < count ; i++ ){
+        typename Map::iterator it = map.find(rand() % (count * 4));
+
+        if ( it != map.end() )
+            sum += it->second;
+    }
+    chrono.end();
+    sprintf(name, "%s find", label);
+    print_row(name, chrono.get_duration_ms());
+    printf("%-20s %.2f\n", "  compares / find", (double)g_comparisons / count);
+    chrono.begin();
+    for ( int i = 0 ; i < count ; i++ )
+        map.erase(rand() % (count * 4));
+    chrono.end();
+    sprintf(name, "%s erase", label);
+    print_row(name, chrono.get_duration_ms());
+    if ( sum < 0 )
+        printf("%ld\n", sum);
+}
+
+typedef ft::map<int, int, CountingLess>     rb_counting_map;
+typedef ft::map<int, int, CountingLess, std::allocator<ft::pair<const int, int> >,
+    ft::rb_no_augment, ft::avl_balance>     avl_counting_map;
+
+void    balance_rb(int ascending){ balance_case<rb_counting_map>("red black", ascending); }
+void    balance_avl(int ascending){ balance_case<avl_counting_map>("avl", ascending); }
+
+/*
+ * 1M inserts, in random then ascending key order, followed by 1M random finds and
+ * erases, for each balancing policy. The number of key comparisons per find is one
+ * more than the depth of the node found.
+ */
+void    bench_balance(){
+    print_header("balancing policies, 1M random keys");
+    run_isolated(balance_rb, 0);
+    run_isolated(balance_avl, 0);
+    print_header("balancing policies, 1M ascending keys");
+    run_isolated(balance_rb, 1);
+    run_isolated(balance_avl, 1);
+}
+
+/*
+ * count keys drawn from a Zipf distribution of exponent s over n ranks, rank r
+ * mapping to key (r * 2654435761 + shift) % n. The shift moves the hot keys.
+ */
+void    zipf_keys(std::vector<int> &keys, int n, double s, int count, unsigned shift){
+    std::vector<double> cdf(n);
+    double              total = 0;
+
+    for ( int r = 0 ; r < n ; r++ ){
+        total += 1.0 / pow(r + 1, s);
+        cdf[r] = total;
+    }
+    for ( int i = 0 ; i < count ; i++ ){
+        double  u = (double)rand() / RAND_MAX * total;
+        int     r = std::lower_bound(cdf.begin(), cdf.end(), u) - cdf.begin();
+
+        if ( r >= n )
+            r = n - 1;
+        keys.push_back((int)(((unsigned)r * 2654435761u + shift) % n));
+    }
+}
+
+template<class Map>
+void    zipf_run(const char *label, double s){
+    const int           n = 1000000;
+    const int           count = 2000000;
+    Map                 map;
+    std::vector<int>    keys;
+    Chrono              chrono;
+    char                name[64];
+    long                sum = 0;
+
+    for ( int i = 0 ; i < n ; i++ )
+        map.insert(ft::make_pair((int)((i * 2654435761u) % n), i));
+    srand(5);
+    zipf_keys(keys, n, s, count / 2, 0);
+    // The hot set drifts half way through
+    zipf_keys(keys, n, s, count / 2, n / 2);
+    chrono.begin();
+    for ( int i = 0 ; i < count ; i++ ){
+        typename Map::iterator it = map.find(keys[i]);
+
+        if ( it != map.end() )
+            sum += it->second;
+    }
+    chrono.end();
+    sprintf(name, "%s s=%.1f", label, s);
+    print_row(name, chrono.get_duration_ms());
+    if ( sum < 0 )
+        printf("%ld\n", sum);
+}
+
+void    zipf_map(int tenths){ zipf_run< ft::map<int, int> >("map", tenths / 10.0); }
+void    zipf_splay(int tenths){ zipf_run< ft::splay_map<int, int> >("splay_map", tenths / 10.0); }
+
+/*
+ * 2M finds on 1M keys drawn from Zipf distributions, the hot keys moving after 1M.
+ * At s=1.2 about 90% of the finds hit 1% of the keys, at s=1.5 about 99%.
+ */
+void    bench_zipf(){
+    int exponents[4] = { 0, 10, 12, 15 };
+
+    print_header("zipf finds, 1M keys");
+    for ( int e = 0 ; e < 4 ; e++ ){
+        run_isolated(zipf_map, exponents[e]);
+        run_isolated(zipf_splay, exponents[e]);
+    }
+}
+
+/*
+ * Short lived maps of size keys: each round builds one, finds every key 8 times
+ * and drops it, for about 4M operations per size.
+ */
+template<class Map>
+void    small_run(const char *label, int size){
+    const int   rounds = 4000000 / (size * 9);
+    Chrono      chrono;
+    char        name[64];
+    long        sum = 0;
+
+    chrono.begin();
+    for ( int round = 0 ; round < rounds ; round++ ){
+        Map map;
+
+        for ( int i = 0 ; i < size ; i++ )
+            map.insert(ft::make_pair((int)((i * 2654435761u + round) % 1000), i));
+        for ( int pass = 0 ; pass < 8 ; pass++ )
+            for ( int i = 0 ; i < size ; i++ )
+                sum += map.find((int)((i * 2654435761u + round) % 1000))->second;
+    }
+    chrono.end();
+    snprintf(name, sizeof(name), "%s %d", label, size);
+    print_row(name, chrono.get_duration_ms());
+    if ( sum == -1 )
+        printf("unreachable\n");
+}
+
+void    small_map(int size){ small_run< ft::map<int, int> >("map", size); }
+void    small_adaptive(int size){ small_run< ft::adaptive_map<int, int> >("adaptive_map", size); }
+
+/*
+ * ft::adaptive_map keeps up to 16 elements inline, past that it holds an ft::map.
+ */
+void    bench_small(){
+    int sizes[7] = { 1, 4, 8, 16, 17, 32, 64 };
+
+    print_header("small maps, 4M operations");
+    for ( int i = 0 ; i < 7 ; i++ ){
+        run_isolated(small_map, sizes[i]);
+        run_isolated(small_adaptive, sizes[i]);
+    }
+}
+
+/*
+ * 1M keys, dense (0 to 1M - 1) or sparse (spread over 64 bits), inserted and
+ * looked up in random order, then walked in order and erased.
+ */
+void    radix_keys(std::vector<unsigned long> &keys, int sparse){
+    const int   n = 1000000;
+
+    for ( int i = 0 ; i < n ; i++ ){
+        unsigned long   key = (unsigned long)((i * 2654435761u) % n);
+
+        if ( sparse )
+            key = key * 0x9E3779B97F4A7C15ul;
+        keys.push_back(key);
+    }
+}
+
+template<class Map>
+void    radix_run(const char *label, int sparse){
+    std::vector<unsigned long>  keys;
+    Map                         map;
+    Chrono                      chrono;
+    char                        name[64];
+    long                        sum = 0;
+
+    radix_keys(keys, sparse);
+    chrono.begin();
+    for ( size_t i = 0 ; i < keys.size() ; i++ )
+        map.insert(ft::make_pair(keys[i], (int)i));
+    chrono.end();
+    snprintf(name, sizeof(name), "%s insert", label);
+    print_row(name, chrono.get_duration_ms());
+    chrono.begin();
+    for ( size_t i = 0 ; i < keys.size() ; i++ )
+        sum += map.find(keys[keys.size() - 1 - i])->second;
+    chrono.end();
+    snprintf(name, sizeof(name), "%s find", label);
+    print_row(name, chrono.get_duration_ms());
+    chrono.begin();
+    for ( size_t i = 0 ; i < keys.size() ; i++ )
+        sum += map.lower_bound(keys[i] + 1) != map.end();
+    chrono.end();
+    snprintf(name, sizeof(name), "%s lower_bound", label);
+    print_row(name, chrono.get_duration_ms());
+    chrono.begin();
+    for ( typename Map::iterator it = map.begin() ; it != map.end() ; ++it )
+        sum += it->second;
+    chrono.end();
+    snprintf(name, sizeof(name), "%s iterate", label);
+    print_row(name, chrono.get_duration_ms());
+    chrono.begin();
+    for ( size_t i = 0 ; i < keys.size() ; i++ )
+        map.erase(keys[i]);
+    chrono.end();
+    snprintf(name, sizeof(name), "%s erase", label);
+    print_row(name, chrono.get_duration_ms());
+    if ( sum == -1 )
+        printf("unreachable\n");
+}
+
+void    radix_map_tree(int sparse){ radix_run< ft::map<unsigned long, int> >("map", sparse); }
+void    radix_map_radix(int sparse){ radix_run< ft::radix_map<unsigned long, int> >("radix_map", sparse); }
+
+void    bench_radix(){
+    print_header("radix_map, 1M dense keys");
+    run_isolated(radix_map_tree, 0);
+    run_isolated(radix_map_radix, 0);
+    print_header("radix_map, 1M sparse keys");
+    run_isolated(radix_map_tree, 1);
+    run_isolated(radix_map_radix, 1);
+}
+
+/*
+ * 1M string keys, random 16 letter words or urls sharing a 25 byte prefix, the
+ * latter never decided by the cached prefix. Inserted then looked up in random order.
+ */
+void    string_keys(std::vector<std::string> &keys, int urls){
+    const int   n = 1000000;
+    char        buffer[64];
+
+    srand(7);
+    for ( int i = 0 ; i < n ; i++ ){
+        if ( urls ){
+            snprintf(buffer, sizeof(buffer), "https://example.com/item/%d", (int)((i * 2654435761u) % n));
+        } else {
+            for ( int c = 0 ; c < 16 ; c++ )
+                buffer[c] = 'a' + rand() % 26;
+            buffer[16] = '\0';
+        }
+        keys.push_back(buffer);
+    }
+}
+
+template<class Map>
+void    string_run(const char *label, int urls){
+    std::vector<std::string>    keys;
+    Map                         map;
+    Chrono                      chrono;
+    char                        name[64];
+    long                        sum = 0;
+
+    string_keys(keys, urls);
+    chrono.begin();
+    for ( size_t i = 0 ; i < keys.size() ; i++ )
+        map.insert(ft::make_pair(keys[i], (int)i));
+    chrono.end();
+    snprintf(name, sizeof(name), "%s insert", label);
+    print_row(name, chrono.get_duration_ms());
+    chrono.begin();
+    for ( size_t i = 0 ; i < keys.size() ; i++ )
+        sum += map.find(keys[keys.size() - 1 - i])->second;
+    chrono.end();
+    snprintf(name, sizeof(name), "%s find", label);
+    print_row(name, chrono.get_duration_ms());
+    if ( sum == -1 )
+        printf("unreachable\n");
+}
+
+void    string_less(int urls){ string_run< ft::map<std::string, int> >("less", urls); }
+void    string_prefix(int urls){ string_run< ft::map<std::string, int, ft::prefix_less<std::string> > >("prefix_less", urls); }
+
+void    bench_string_keys(){
+    print_header("string keys, 1M random words");
+    run_isolated(string_less, 0);
+    run_isolated(string_prefix, 0);
+    print_header("string keys, 1M urls");
+    run_isolated(string_less, 1);
+    run_isolated(string_prefix, 1);
+}
+
+/*
+ * Bytes handed out by malloc, mapped blocks included, and not freed yet, in KB, or
+ * 0 where glibc cannot tell.
+ */
+long    heap_in_use_kb(){
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+    struct mallinfo2 info = mallinfo2();
+
+    return (long)((info.uordblks + info.hblkhd) / 1024);
+#else
+    return 0;
+#endif
+}
+
+/*
+ * 1M keys "tenant<t>/<id>" over 100 tenants, short enough to fit std::string's inline
+ * buffer or not. Reports the memory the map takes, 1M finds, and a scan of every
+ * tenant through its prefix.
+ */
+template<class Map>
+void    trie_run(const char *label, int long_keys){
+    const int                   n = 1000000;
+    std::vector<std::string>    keys;
+    Map                         map;
+    Chrono                      chrono;
+    char                        name[64];
+    char                        buffer[64];
+    long                        sum = 0;
+    long                        before;
+
+    for ( int i = 0 ; i < n ; i++ ){
+        int id = (int)((unsigned long)i * 2654435761ul % n);
+
+        snprintf(buffer, sizeof(buffer), long_keys ? "tenant%d/user-%08d" : "t%d/%d", id % 100, id);
+        keys.push_back(buffer);
+    }
+    before = heap_in_use_kb();
+    for ( int i = 0 ; i < n ; i++ )
+        map.insert(ft::make_pair(keys[i], i));
+    snprintf(name, sizeof(name), "%s memory (MB)", label);
+    print_row(name, (heap_in_use_kb() - before) / 1024.0);
+    chrono.begin();
+    for ( int i = 0 ; i < n ; i++ )
+        sum += map.find(keys[n - 1 - i])->second;
+    chrono.end();
+    snprintf(name, sizeof(name), "%s find", label);
+    print_row(name, chrono.get_duration_ms());
+    chrono.begin();
+    for ( int t = 0 ; t < 100 ; t++ ){
+        std::string prefix;
+
+        snprintf(buffer, sizeof(buffer), long_keys ? "tenant%d/" : "t%d/", t);
+        prefix = buffer;
+        for ( typename Map::iterator it = map.lower_bound(prefix) ;
+            it != map.end() && it->first.compare(0, prefix.size(), prefix) == 0 ; ++it )
+            sum += it->second;
+    }
+    chrono.end();
+    snprintf(name, sizeof(name), "%s prefix scan", label);
+    print_row(name, chrono.get_duration_ms());
+    if ( sum == -1 )
+        printf("unreachable\n");
+}
+
+void    trie_tree(int long_keys){ trie_run< ft::map<std::string, int> >("map", long_keys); }
+void    trie_trie(int long_keys){ trie_run< ft::trie_map<int> >("trie_map", long_keys); }
+
+void    bench_trie(){
+    print_header("trie_map, 1M short keys");
+    run_isolated(trie_tree, 0);
+    run_isolated(trie_trie, 0);
+    print_header("trie_map, 1M long keys");
+    run_isolated(trie_tree, 1);
+    run_isolated(trie_trie, 1);
+}
+
+/*
+ * 1M ids out of a 16M universe, inserted, looked up and erased in random order,
+ * successors of random ids, then walked in order. ft::map<unsigned, bool> as the
+ * set it replaces.
+ */
+typedef ft::map<unsigned int, bool>     id_map;
+typedef ft::bitmap_set<unsigned int>    id_set;
+
+void            id_insert(id_map &map, unsigned int id){ map.insert(ft::make_pair(id, true)); }
+void            id_insert(id_set &set, unsigned int id){ set.insert(id); }
+unsigned int    id_of(id_map::iterator it){ return it->first; }
+unsigned int    id_of(id_set::iterator it){ return *it; }
+
+template<class Set>
+void    bitmap_run(const char *label){
+    const unsigned int          universe = 1u << 24;
+    const int                   n = 1000000;
+    std::vector<unsigned int>   ids;
+    Set                         set;
+    Chrono                      chrono;
+    char                        name[64];
+    long                        sum = 0;
+    long                        before;
+
+    for ( int i = 0 ; i < n ; i++ )
+        ids.push_back((unsigned int)((unsigned long)i * 2654435761ul % universe));
+    before = heap_in_use_kb();
+    chrono.begin();
+    for ( int i = 0 ; i < n ; i++ )
+        id_insert(set, ids[i]);
+    chrono.end();
+    snprintf(name, sizeof(name), "%s memory (MB)", label);
+    print_row(name, (heap_in_use_kb() - before) / 1024.0);
+    snprintf(name, sizeof(name), "%s insert", label);
+    print_row(name, chrono.get_duration_ms());
+    chrono.begin();
+    for ( int i = 0 ; i < n ; i++ )
+        sum += set.count(ids[n - 1 - i]);
+    chrono.end();
+    snprintf(name, sizeof(name), "%s count", label);
+    print_row(name, chrono.get_duration_ms());
+    chrono.begin();
+    for ( int i = 0 ; i < n ; i++ ){
+        typename Set::iterator it = set.lower_bound((unsigned int)((unsigned long)i * 40503ul % universe));
+
+        if ( it != set.end() )
+            sum += id_of(it);
+    }
+    chrono.end();
+    snprintf(name, sizeof(name), "%s lower_bound", label);
+    print_row(name, chrono.get_duration_ms());
+    chrono.begin();
+    for ( typename Set::iterator it = set.begin() ; it != set.end() ; ++it )
+        sum += id_of(it);
+    chrono.end();
+    snprintf(name, sizeof(name), "%s iterate", label);
+    print_row(name, chrono.get_duration_ms());
+    chrono.begin();
+    for ( int i = 0 ; i < n ; i++ )
+        set.erase(ids[i]);
+    chrono.end();
+    snprintf(name, sizeof(name), "%s erase", label);
+    print_row(name, chrono.get_duration_ms());
+    if ( sum == -1 )
+        printf("unreachable\n");
+}
+
+void    bitmap_tree(int){ bitmap_run<id_map>("map"); }
+void    bitmap_bits(int){ bitmap_run<id_set>("bitmap_set"); }
+
+void    bench_bitmap(){
+    print_header("bitmap_set, 1M ids out of 16M");
+    run_isolated(bitmap_tree, 0);
+    run_isolated(bitmap_bits, 0);
+}
+
+/*
+ * 3M ids of mixed density: 1M spread over 32 bits, 1M packed in 2M values, and 1M
+ * in ranges of 1000. Memory held by ft::map<unsigned, bool>, a sorted
+ * ft::vector<unsigned> and an optimized roaring_set, then union, intersection and
+ * difference of two such sets, roaring_set in place on copies of the left one.
+ */
+void    roaring_ids(std::vector<unsigned int> &ids, unsigned int seed){
+    unsigned int    state = seed;
+
+    for ( int i = 0 ; i < 1000000 ; i++ ){
+        state = state * 1664525u + 1013904223u;
+        ids.push_back(state);
+        ids.push_back(0x40000000u + (state >> 11));
+    }
+    for ( int range = 0 ; range < 1000 ; range++ ){
+        state = state * 1664525u + 1013904223u;
+        for ( unsigned int i = 0 ; i < 1000 ; i++ )
+            ids.push_back(0x80000000u + (state >> 4) + i);
+    }
+}
+
+void    roaring_memory_map(int){
+    std::vector<unsigned int>   ids;
+    long                        before;
+
+    roaring_ids(ids, 1);
+    before = heap_in_use_kb();
+    {
+        ft::map<unsigned int, bool> map;
+
+        for ( size_t i = 0 ; i < ids.size() ; i++ )
+            map.insert(ft::make_pair(ids[i], true));
+        print_row("map memory (MB)", (heap_in_use_kb() - before) / 1024.0);
+    }
+}
+
+void    roaring_memory_vector(int){
+    std::vector<unsigned int>   ids;
+    long                        before;
+
+    roaring_ids(ids, 1);
+    std::sort(ids.begin(), ids.end());
+    before = heap_in_use_kb();
+    {
+        ft::vector<unsigned int> vector(ids.begin(), std::unique(ids.begin(), ids.end()));
+
+        print_row("vector memory (MB)", (heap_in_use_kb() - before) / 1024.0);
+    }
+}
+
+void    roaring_memory_roaring(int){
+    std::vector<unsigned int>   ids;
+    long                        before;
+
+    roaring_ids(ids, 1);
+    before = heap_in_use_kb();
+    {
+        ft::roaring_set<> set(ids.begin(), ids.end());
+
+        print_row("roaring memory (MB)", (heap_in_use_kb() - before) / 1024.0);
+        set.optimize();
+        print_row("optimized (MB)", (heap_in_use_kb() - before) / 1024.0);
+    }
+}
+
+void    roaring_ops_vector(int op){
+    std::vector<unsigned int>   a;
+    std::vector<unsigned int>   b;
+    std::vector<unsigned int>   out;
+    Chrono                      chrono;
+    char                        name[64];
+
+    roaring_ids(a, 1);
+    roaring_ids(b, 2);
+    std::sort(a.begin(), a.end());
+    a.erase(std::unique(a.begin(), a.end()), a.end());
+    std::sort(b.begin(), b.end());
+    b.erase(std::unique(b.begin(), b.end()), b.end());
+    out.reserve(a.size() + b.size());
+    chrono.begin();
+    for ( int repeat = 0 ; repeat < 10 ; repeat++ ){
+        out.clear();
+        if ( op == 0 )
+            std::set_union(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(out));
+        else if ( op == 1 )
+            std::set_intersection(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(out));
+        else
+            std::set_difference(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(out));
+    }
+    chrono.end();
+    snprintf(name, sizeof(name), "vector %s x10", g_set_ops[op]);
+    print_row(name, chrono.get_duration_ms());
+}
+
+void    roaring_ops_roaring(int op){
+    std::vector<unsigned int>   ids;
+    ft::roaring_set<>           a;
+    ft::roaring_set<>           b;
+    Chrono                      chrono;
+    char                        name[64];
+
+    roaring_ids(ids, 1);
+    a.insert(ids.begin(), ids.end());
+    ids.clear();
+    roaring_ids(ids, 2);
+    b.insert(ids.begin(), ids.end());
+    a.optimize();
+    b.optimize();
+    std::vector< ft::roaring_set<> > out(10, a);
+    chrono.begin();
+    for ( int repeat = 0 ; repeat < 10 ; repeat++ ){
+        if ( op == 0 )
+            out[repeat].set_union(b);
+        else if ( op == 1 )
+            out[repeat].set_intersection(b);
+        else
+            out[repeat].set_difference(b);
+    }
+    chrono.end();
+    snprintf(name, sizeof(name), "roaring %s x10", g_set_ops[op]);
+    print_row(name, chrono.get_duration_ms());
+}
+
+void    bench_roaring(){
+    print_header("roaring_set, 3M ids of mixed density");
+    run_isolated(roaring_memory_map, 0);
+    run_isolated(roaring_memory_vector, 0);
+    run_isolated(roaring_memory_roaring, 0);
+    for ( int op = 0 ; op < 3 ; op++ ){
+        run_isolated(roaring_ops_vector, op);
+        run_isolated(roaring_ops_roaring, op);
+    }
+}
+
+/*
+ * 1M random keys appended in bursts, each burst followed by 1000 lookups, then 1M
+ * lookups once loaded. ft::map<int, int> against lazy_sorted_vector<int>, which sorts
+ * each burst on the first lookup after it.
+ */
+typedef ft::map<int, int>               lazy_map;
+typedef ft::lazy_sorted_vector<int>     lazy_vector;
+
+void    lazy_append(lazy_map &map, int key){ map.insert(ft::make_pair(key, 0)); }
+void    lazy_append(lazy_vector &vector, int key){ vector.push_back(key); }
+
+template<class Set>
+void    lazy_run(const char *label, int burst){
+    const int       n = 1000000;
+    Set             set;
+    Chrono          chrono;
+    char            name[64];
+    unsigned int    state = 12345;
+    long            sum = 0;
+
+    chrono.begin();
+    for ( int i = 0 ; i < n ; i += burst ){
+        for ( int j = 0 ; j < burst ; j++ ){
+            state = state * 1103515245u + 12345u;
+            lazy_append(set, (int)( state >> 1 ));
+        }
+        for ( int j = 0 ; j < 1000 ; j++ ){
+            state = state * 1103515245u + 12345u;
+            sum += set.count((int)( state >> 1 ));
+        }
+    }
+    chrono.end();
+    snprintf(name, sizeof(name), "%s bursts of %d", label, burst);
+    print_row(name, chrono.get_duration_ms());
+    chrono.begin();
+    for ( int i = 0 ; i < n ; i++ ){
+        state = state * 1103515245u + 12345u;
+        sum += set.count((int)( state >> 1 ));
+    }
+    chrono.end();
+    snprintf(name, sizeof(name), "%s count", label);
+    print_row(name, chrono.get_duration_ms());
+    if ( sum == -1 )
+        printf("unreachable\n");
+}
+
+void    lazy_tree(int burst){ lazy_run<lazy_map>("map", burst); }
+void    lazy_sorted(int burst){ lazy_run<lazy_vector>("lazy_sorted", burst); }
+
+void    bench_lazy_sorted(){
+    print_header("lazy_sorted_vector, 1M keys appended in bursts");
+    run_isolated(lazy_tree, 100000);
+    run_isolated(lazy_sorted, 100000);
+    run_isolated(lazy_tree, 10000);
+    run_isolated(lazy_sorted, 10000);
+}
+
+/*
+ * 1M random keys written into a map already holding 1M, then 1M random erases, every
+ * write followed by a count one time in ten. ft::map against buffered_map with logs
+ * of 4096, 65536 (the default) and 262144 writes, the last one applied before the
+ * clock stops.
+ */
+typedef ft::buffered_map<int, int>      write_buffered;
+
+void    write_insert(lazy_map &map, int key){ map.insert(ft::make_pair(key, key)); }
+void    write_insert(write_buffered &map, int key){ map.insert(ft::make_pair(key, key)); }
+void    write_flush(lazy_map &){ }
+void    write_flush(write_buffered &map){ map.flush(); }
+void    write_setup(lazy_map &, int){ }
+void    write_setup(write_buffered &map, int buffer){ map.buffer_size(buffer); }
+
+template<class Map>
+void    write_run(const char *label, int buffer){
+    const int       n = 1000000;
+    Map             map;
+    Chrono          chrono;
+    char            name[64];
+    unsigned int    state = 12345;
+    long            sum = 0;
+
+    write_setup(map, buffer);
+    for ( int i = 0 ; i < n ; i++ ){
+        state = state * 1103515245u + 12345u;
+        write_insert(map, (int)( state >> 1 ));
+    }
+    write_flush(map);
+    chrono.begin();
+    for ( int i = 0 ; i < n ; i++ ){
+        state = state * 1103515245u + 12345u;
+        write_insert(map, (int)( state >> 1 ));
+        if ( i % 10 == 0 )
+            sum += map.count((int)( state >> 3 ));
+    }
+    write_flush(map);
+    chrono.end();
+    snprintf(name, sizeof(name), "%s insert", label);
+    print_row(name, chrono.get_duration_ms());
+    state = 12345;
+    chrono.begin();
+    for ( int i = 0 ; i < n ; i++ ){
+        state = state * 1103515245u + 12345u;
+        map.erase((int)( state >> 1 ));
+        if ( i % 10 == 0 )
+            sum += map.count((int)( state >> 3 ));
+    }
+    write_flush(map);
+    chrono.end();
+    snprintf(name, sizeof(name), "%s erase", label);
+    print_row(name, chrono.get_duration_ms());
+    if ( sum == -1 )
+        printf("unreachable\n");
+}
+
+void    write_tree(int){ write_run<lazy_map>("map", 0); }
+
+void    write_buffer(int buffer){
+    char label[32];
+
+    snprintf(label, sizeof(label), "buffered %d", buffer);
+    write_run<write_buffered>(label, buffer);
+}
+
+void    bench_write_buffer(){
+    print_header("buffered_map, 1M random writes into 1M keys");
+    run_isolated(write_tree, 0);
+    run_isolated(write_buffer, 4096);
+    run_isolated(write_buffer, 65536);
+    run_isolated(write_buffer, 262144);
+}
+
+struct Bench {
+    const char  *name;
+    void        (*run)();
+};
+
+const Bench g_benches[] = {
+    { "erase_range", bench_erase_range },
+    { "erase_if", bench_erase_if },
+    { "set_ops", bench_set_ops },
+    { "bulk_load", bench_bulk_load },
+    { "sorted_batch", bench_sorted_batch },
+    { "find_batch", bench_find_batch },
+    { "cursor", bench_cursor },
+    { "reserve", bench_reserve },
+    { "compact", bench_compact },
+    { "parallel_reduce", bench_parallel_reduce },
+    { "aggregate", bench_aggregate },
+    { "interval", bench_interval },
+    { "balance", bench_balance },
+    { "zipf", bench_zipf },
+    { "small", bench_small },
+    { "radix", bench_radix },
+    { "string_keys", bench_string_keys },
+    { "trie", bench_trie },
+    { "bitmap", bench_bitmap },
+    { "roaring", bench_roaring },
+    { "lazy_sorted", bench_lazy_sorted },
+    { "write_buffer", bench_write_buffer },
+};
+
+int     main(int argc, char *argv[]){
+    const int count = sizeof(g_benches) / sizeof(*g_benches);
+
+    for ( int i = 0 ; i < count ; i++ ){
+        bool selected = argc == 1;
+
+        for ( int arg = 1 ; arg < argc ; arg++ )
+            selected = selected || strcmp(argv[arg], g_benches[i].name) == 0;
+        if ( selected )
+            g_benches[i].run();
+    }
+}
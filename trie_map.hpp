@@ -0,0 +1,994 @@
+#ifndef TRIE_MAP_HPP
+#define TRIE_MAP_HPP
+
+# include <string>
+# include <cstring>
+# include <stdint.h>
+# include "map.hpp"
+
+namespace ft {
+	enum trie_entry_kind { TRIE_INNER, TRIE_BUCKET };
+
+	/**
+	 * Entries of a trie_map
+	 *
+	 * An inner node of depth d splits the keys below it, which share their first d
+	 * characters, on the next one: slot 0 holds the key of length d, if any, and slot
+	 * 1 + c the keys whose next character is c. Its children are inner nodes or
+	 * buckets, which hold the keys of a subtree sorted in a contiguous array.
+	 *
+	 * The characters the keys of an inner node share past the depth its parent gives
+	 * it, one more than the depth of the parent or 0 for the root, are kept in skip,
+	 * so that a burst does not leave levels holding a single child.
+	 *
+	 */
+	struct trie_inner;
+
+	struct trie_entry {
+		unsigned char	kind;
+		trie_inner		*parent;
+		unsigned short	slot;
+
+		trie_entry(unsigned char __kind) : kind( __kind ), parent( NULL ), slot( 0 ) { }
+	};
+
+	struct trie_inner : trie_entry {
+		const static std::size_t SLOTS = 257;
+
+		std::size_t		depth;
+		std::size_t		count;
+		std::string		skip;
+		trie_entry		*children[SLOTS];
+
+		trie_inner(std::size_t __depth, const std::string &__skip)
+			: trie_entry( TRIE_INNER ), depth( __depth ), count( 0 ), skip( __skip )
+		{
+			for ( std::size_t i = 0 ; i < SLOTS ; i++ ){
+				children[i] = NULL;
+			}
+		}
+	};
+
+	/**
+	 * Buckets are chained in key order, the head of the chain being held by the map
+	 * as its end.
+	 */
+	struct trie_link {
+		trie_link *prev;
+		trie_link *next;
+	};
+
+	/**
+	 * Elements of a bucket are appended to items as they come, and order holds their
+	 * positions in key order, so an insertion only moves positions. Items get sorted
+	 * whenever the bucket grows. prefixes holds, in key order too, the 8 characters
+	 * of every key after the depth of the bucket as an integer, see prefix_(), so a
+	 * binary search mostly reads that array and not the keys.
+	 */
+	template<class T>
+	struct trie_bucket : trie_entry, trie_link {
+		std::size_t		depth;
+		T				*items;
+		unsigned short	*order;
+		uint64_t		*prefixes;
+		std::size_t		size;
+		std::size_t		capacity;
+
+		trie_bucket(std::size_t __depth)
+			: trie_entry( TRIE_BUCKET ), depth( __depth ), items( NULL ), order( NULL ), prefixes( NULL ),
+			size( 0 ), capacity( 0 ) { }
+
+		T &at(std::size_t rank) { return items[order[rank]]; }
+		const T &at(std::size_t rank) const { return items[order[rank]]; }
+	};
+
+	template<class T>
+	struct trie_iterator {
+		typedef T								value_type;
+		typedef T&								reference;
+		typedef T*								pointer;
+		typedef std::bidirectional_iterator_tag	iterator_category;
+		typedef std::ptrdiff_t					difference_type;
+		typedef trie_iterator<T>				_self;
+		typedef trie_bucket<T>					_bucket;
+
+		trie_iterator() : m_bucket( NULL ), m_index( 0 ) { }
+		trie_iterator(trie_link *bucket, std::size_t index) : m_bucket( bucket ), m_index( index ) { }
+
+		reference operator*() const { return static_cast<_bucket *>( m_bucket )->at(m_index); }
+		pointer operator->() const { return &**this; }
+
+		_self &operator++(){
+			if ( ++m_index == static_cast<_bucket *>( m_bucket )->size ){
+				m_bucket = m_bucket->next;
+				m_index = 0;
+			}
+			return *this;
+		}
+
+		_self operator++(int){
+			_self tmp = *this;
+
+			++*this;
+			return tmp;
+		}
+
+		_self &operator--(){
+			if ( m_index == 0 ){
+				m_bucket = m_bucket->prev;
+				m_index = static_cast<_bucket *>( m_bucket )->size;
+			}
+			--m_index;
+			return *this;
+		}
+
+		_self operator--(int){
+			_self tmp = *this;
+
+			--*this;
+			return tmp;
+		}
+
+		bool operator==(const _self &it) const { return m_bucket == it.m_bucket && m_index == it.m_index; }
+		bool operator!=(const _self &it) const { return !( *this == it ); }
+
+		trie_link	*m_bucket;
+		std::size_t	m_index;
+	};
+
+	template<class T>
+	struct trie_const_iterator {
+		typedef T								value_type;
+		typedef const T&						reference;
+		typedef const T*						pointer;
+		typedef std::bidirectional_iterator_tag	iterator_category;
+		typedef std::ptrdiff_t					difference_type;
+		typedef trie_const_iterator<T>			_self;
+		typedef trie_bucket<T>					_bucket;
+
+		trie_const_iterator() : m_bucket( NULL ), m_index( 0 ) { }
+		trie_const_iterator(const trie_link *bucket, std::size_t index) : m_bucket( bucket ), m_index( index ) { }
+		trie_const_iterator(const trie_iterator<T> &it) : m_bucket( it.m_bucket ), m_index( it.m_index ) { }
+
+		reference operator*() const { return static_cast<const _bucket *>( m_bucket )->at(m_index); }
+		pointer operator->() const { return &**this; }
+
+		_self &operator++(){
+			if ( ++m_index == static_cast<const _bucket *>( m_bucket )->size ){
+				m_bucket = m_bucket->next;
+				m_index = 0;
+			}
+			return *this;
+		}
+
+		_self operator++(int){
+			_self tmp = *this;
+
+			++*this;
+			return tmp;
+		}
+
+		_self &operator--(){
+			if ( m_index == 0 ){
+				m_bucket = m_bucket->prev;
+				m_index = static_cast<const _bucket *>( m_bucket )->size;
+			}
+			--m_index;
+			return *this;
+		}
+
+		_self operator--(int){
+			_self tmp = *this;
+
+			--*this;
+			return tmp;
+		}
+
+		bool operator==(const _self &it) const { return m_bucket == it.m_bucket && m_index == it.m_index; }
+		bool operator!=(const _self &it) const { return !( *this == it ); }
+
+		const trie_link	*m_bucket;
+		std::size_t		m_index;
+	};
+
+	/**
+	 * Trie map
+	 *
+	 * Associative container with the interface of ft::map for string keys, ordered as
+	 * std::string::compare does, plus prefix_range() to get all keys starting with a
+	 * prefix. It is a burst trie: the elements are stored in arrays, the buckets,
+	 * hanging from a trie on the first characters of the keys. A bucket of more than
+	 * BURST_SIZE elements bursts into a trie node with one bucket per character at the
+	 * first place its keys differ, so a lookup goes down one node per character that
+	 * tells keys apart, checks the ones they share in passing, then binary searches the
+	 * bucket comparing what follows only.
+	 *
+	 * Elements sit next to each other without any node of their own, which saves the
+	 * pointers and the allocation of each node of ft::map, and a lookup reads a few
+	 * contiguous arrays instead of chasing one pointer per comparison. In exchange,
+	 * elements move when their bucket grows, bursts, or loses an element, so that
+	 * insertions and erasures invalidate all iterators, pointers and references, as
+	 * for a vector. Buckets are freed once empty, but never merged back.
+	 *
+	 */
+	template<
+		class T,
+		class Alloc = std::allocator<ft::pair<const std::string, T> >
+	>
+	class trie_map {
+		public:
+			typedef std::string										key_type;
+			typedef T												mapped_type;
+			typedef ft::pair<const key_type, mapped_type>			value_type;
+			typedef std::less<key_type>								key_compare;
+			typedef Alloc											allocator_type;
+			typedef typename allocator_type::reference				reference;
+			typedef typename allocator_type::const_reference		const_reference;
+			typedef typename allocator_type::pointer				pointer;
+			typedef typename allocator_type::const_pointer			const_pointer;
+			typedef std::ptrdiff_t									difference_type;
+			typedef std::size_t										size_type;
+			typedef trie_iterator<value_type>						iterator;
+			typedef trie_const_iterator<value_type>					const_iterator;
+			typedef ft::reverse_iterator<iterator>					reverse_iterator;
+			typedef ft::reverse_iterator<const_iterator>			const_reverse_iterator;
+
+			const static size_type									BURST_SIZE = 1024;
+
+			class value_compare : std::binary_function<value_type, value_type, bool> {
+				friend class trie_map;
+				protected:
+					key_compare m_comp;
+					value_compare(key_compare comp) : m_comp(comp) {}
+				public:
+					typedef bool result_type;
+					typedef value_type first_argument_type;
+					typedef value_type second_argument_type;
+					bool operator()(const value_type &x, const value_type &y) const {
+						return m_comp(x.first, y.first);
+					}
+			};
+
+		private:
+			typedef trie_bucket<value_type>							bucket_type;
+			typedef std::allocator<bucket_type>						bucket_allocator_type;
+			typedef std::allocator<trie_inner>						inner_allocator_type;
+			typedef std::allocator<unsigned short>					order_allocator_type;
+			typedef std::allocator<uint64_t>						prefix_allocator_type;
+
+			/**
+			 * Where a descent on a key stopped: its bucket, or the empty slot of inner
+			 * it would go to. Both are NULL for an empty map. When the key differs from
+			 * the characters the keys of an inner node share, bucket is NULL, that node
+			 * is branch, in the slot of inner, and depth is the place of the difference.
+			 */
+			struct trie_descent_ {
+				bucket_type	*bucket;
+				trie_inner	*inner;
+				size_type	slot;
+				trie_inner	*branch;
+				size_type	depth;
+			};
+
+			trie_entry		*m_root;
+			trie_link		m_head;
+			size_type		m_size;
+			allocator_type	m_alloc;
+
+		public:
+			explicit trie_map( const key_compare &comp = key_compare(), const allocator_type &alloc = allocator_type() )
+				: m_root( NULL ), m_size( 0 ), m_alloc( alloc )
+			{
+				(void)comp;
+				m_head.prev = &m_head;
+				m_head.next = &m_head;
+			}
+
+			template<class InputIterator>
+			trie_map( InputIterator first, InputIterator last, const key_compare &comp = key_compare(),
+				const allocator_type &alloc = allocator_type() )
+				: m_root( NULL ), m_size( 0 ), m_alloc( alloc )
+			{
+				(void)comp;
+				m_head.prev = &m_head;
+				m_head.next = &m_head;
+				this->insert(first, last);
+			}
+
+			trie_map( const trie_map &x ) : m_root( NULL ), m_size( 0 ), m_alloc( x.m_alloc ){
+				m_head.prev = &m_head;
+				m_head.next = &m_head;
+				this->insert(x.begin(), x.end());
+			}
+
+			trie_map &operator=( const trie_map &x ){
+				if ( this == &x )
+					return *this;
+				this->clear();
+				this->insert(x.begin(), x.end());
+				return *this;
+			}
+
+			~trie_map(){
+				this->clear();
+			}
+
+			/**
+			 * Iterators
+			 */
+			iterator begin(){ return iterator( m_head.next, 0 ); }
+			const_iterator begin() const { return const_iterator( m_head.next, 0 ); }
+			iterator end(){ return iterator( &m_head, 0 ); }
+			const_iterator end() const { return const_iterator( &m_head, 0 ); }
+			reverse_iterator rbegin(){ return reverse_iterator( end() ); }
+			const_reverse_iterator rbegin() const { return const_reverse_iterator( end() ); }
+			reverse_iterator rend(){ return reverse_iterator( begin() ); }
+			const_reverse_iterator rend() const { return const_reverse_iterator( begin() ); }
+
+			/**
+			 * Capacity
+			 */
+			bool empty() const { return m_size == 0; }
+			size_type size() const { return m_size; }
+			size_type max_size() const { return m_alloc.max_size(); }
+
+			/**
+			 * Element access
+			 */
+			mapped_type &operator[]( const key_type &k ){
+				iterator it = this->find(k);
+
+				if ( it == this->end() )
+					it = this->insert( value_type( k, mapped_type() ) ).first;
+				return it->second;
+			}
+
+			/**
+			 * Modifiers
+			 */
+			ft::pair<iterator, bool> insert( const value_type &val ){
+				trie_descent_	descent = this->descend_(val.first);
+				bucket_type		*bucket = descent.bucket;
+				size_type		index;
+
+				if ( bucket == NULL ){
+					if ( descent.branch != NULL ){
+						descent.inner = this->split_(descent.branch, descent.depth);
+						descent.slot = slot_(val.first, descent.depth);
+					}
+					bucket = this->create_bucket_(descent.inner, descent.slot);
+					index = 0;
+				} else {
+					index = this->lower_index_(bucket, val.first);
+					if ( index < bucket->size && bucket->prefixes[index] == prefix_(val.first, bucket->depth)
+						&& rest_(bucket->at(index).first, val.first, bucket->depth) == 0 )
+						return ft::make_pair(iterator( bucket, index ), false);
+				}
+				this->insert_item_(bucket, index, val);
+				m_size++;
+				if ( bucket->size > BURST_SIZE ){
+					this->burst_(bucket);
+					return ft::make_pair(this->find(val.first), true);
+				}
+				return ft::make_pair(iterator( bucket, index ), true);
+			}
+
+			iterator insert( iterator position, const value_type &val ){
+				(void)position;
+				return this->insert(val).first;
+			}
+
+			template<class InputIterator>
+			void insert( InputIterator first, InputIterator last ){
+				for ( ; first != last ; ++first ){
+					this->insert(*first);
+				}
+			}
+
+			void erase( iterator position ){
+				this->erase_item_(position);
+			}
+
+			size_type erase( const key_type &k ){
+				iterator it = this->find(k);
+
+				if ( it == this->end() )
+					return 0;
+				this->erase_item_(it);
+				return 1;
+			}
+
+			void erase( iterator first, iterator last ){
+				size_type count = 0;
+
+				for ( iterator it = first ; it != last ; ++it ){
+					count++;
+				}
+				while ( count-- > 0 ){
+					first = this->erase_item_(first);
+				}
+			}
+
+			void swap( trie_map &x ){
+				trie_entry		*root = m_root;
+				trie_link		head = m_head;
+				size_type		size = m_size;
+				allocator_type	alloc = m_alloc;
+
+				m_root = x.m_root;
+				m_head = x.m_head;
+				m_size = x.m_size;
+				m_alloc = x.m_alloc;
+				x.m_root = root;
+				x.m_head = head;
+				x.m_size = size;
+				x.m_alloc = alloc;
+				relink_(m_head, x.m_head);
+				relink_(x.m_head, m_head);
+			}
+
+			void clear(){
+				this->destroy_(m_root);
+				m_root = NULL;
+				m_head.prev = &m_head;
+				m_head.next = &m_head;
+				m_size = 0;
+			}
+
+			/**
+			 * Observers
+			 */
+			key_compare key_comp() const { return key_compare(); }
+			value_compare value_comp() const { return value_compare( key_compare() ); }
+			allocator_type get_allocator() const { return m_alloc; }
+
+			/**
+			 * Operations
+			 */
+			iterator find( const key_type &k ){
+				const_iterator it = static_cast<const trie_map *>( this )->find(k);
+
+				return iterator( const_cast<trie_link *>( it.m_bucket ), it.m_index );
+			}
+
+			const_iterator find( const key_type &k ) const {
+				trie_descent_	descent = this->descend_(k);
+				size_type		index;
+
+				if ( descent.bucket == NULL )
+					return this->end();
+				index = this->lower_index_(descent.bucket, k);
+				if ( index < descent.bucket->size && descent.bucket->prefixes[index] == prefix_(k, descent.bucket->depth)
+					&& rest_(descent.bucket->at(index).first, k, descent.bucket->depth) == 0 )
+					return const_iterator( descent.bucket, index );
+				return this->end();
+			}
+
+			size_type count( const key_type &k ) const {
+				return ( this->find(k) == this->end() ) ? 0 : 1;
+			}
+
+			iterator lower_bound( const key_type &k ){
+				const_iterator it = static_cast<const trie_map *>( this )->lower_bound(k);
+
+				return iterator( const_cast<trie_link *>( it.m_bucket ), it.m_index );
+			}
+
+			/**
+			 * Keys of a bucket and of the subtrees of the slots before its own all go
+			 * before those of the subtrees of the following slots, so a key going after
+			 * the whole bucket, or missing from a slot, has for lower bound the first
+			 * element of the next bucket. A key differing from the characters the keys
+			 * of an inner node share goes before or after its whole subtree.
+			 */
+			const_iterator lower_bound( const key_type &k ) const {
+				trie_descent_	descent = this->descend_(k);
+				size_type		index;
+
+				if ( descent.bucket == NULL ){
+					trie_inner *branch = descent.branch;
+
+					if ( branch != NULL && ( descent.depth == k.size() || static_cast<unsigned char>( k[descent.depth] )
+						< static_cast<unsigned char>( branch->skip[descent.depth - start_(branch)] ) ) )
+						return const_iterator( first_bucket_(branch), 0 );
+					if ( descent.inner == NULL )
+						return this->end();
+					return const_iterator( this->next_bucket_(descent.inner, descent.slot), 0 );
+				}
+				index = this->lower_index_(descent.bucket, k);
+				if ( index == descent.bucket->size )
+					return const_iterator( descent.bucket->next, 0 );
+				return const_iterator( descent.bucket, index );
+			}
+
+			iterator upper_bound( const key_type &k ){
+				iterator it = this->lower_bound(k);
+
+				if ( it != this->end() && it->first == k )
+					++it;
+				return it;
+			}
+
+			const_iterator upper_bound( const key_type &k ) const {
+				const_iterator it = this->lower_bound(k);
+
+				if ( it != this->end() && it->first == k )
+					++it;
+				return it;
+			}
+
+			ft::pair<iterator, iterator> equal_range( const key_type &k ){
+				return ft::make_pair(this->lower_bound(k), this->upper_bound(k));
+			}
+
+			ft::pair<const_iterator, const_iterator> equal_range( const key_type &k ) const {
+				return ft::make_pair(this->lower_bound(k), this->upper_bound(k));
+			}
+
+			/**
+			 * Prefix range
+			 *
+			 * Range of the elements whose key starts with prefix, from the lower bound of
+			 * prefix to the lower bound of the least string going after all of them: prefix
+			 * with its last character not equal to '\xff' incremented, and the following
+			 * ones dropped. Costs two descents, O(|prefix| + log(BURST_SIZE)).
+			 */
+			ft::pair<iterator, iterator> prefix_range( const key_type &prefix ){
+				ft::pair<const_iterator, const_iterator> range = static_cast<const trie_map *>( this )->prefix_range(prefix);
+
+				return ft::make_pair(iterator( const_cast<trie_link *>( range.first.m_bucket ), range.first.m_index ),
+					iterator( const_cast<trie_link *>( range.second.m_bucket ), range.second.m_index ));
+			}
+
+			ft::pair<const_iterator, const_iterator> prefix_range( const key_type &prefix ) const {
+				key_type bound = prefix;
+
+				while ( !bound.empty() && static_cast<unsigned char>( bound[bound.size() - 1] ) == 0xff ){
+					bound.erase(bound.size() - 1);
+				}
+				if ( bound.empty() )
+					return ft::make_pair(this->lower_bound(prefix), this->end());
+				bound[bound.size() - 1] = static_cast<char>( static_cast<unsigned char>( bound[bound.size() - 1] ) + 1 );
+				return ft::make_pair(this->lower_bound(prefix), this->lower_bound(bound));
+			}
+
+		private:
+			static size_type slot_( const key_type &k, size_type depth ){
+				return ( depth < k.size() ) ? 1 + static_cast<unsigned char>( k[depth] ) : 0;
+			}
+
+			static void relink_( trie_link &head, trie_link &other ){
+				if ( head.next == &other ){
+					head.prev = &head;
+					head.next = &head;
+				} else {
+					head.next->prev = &head;
+					head.prev->next = &head;
+				}
+			}
+
+			static void link_before_( trie_link *link, trie_link *next ){
+				link->next = next;
+				link->prev = next->prev;
+				next->prev->next = link;
+				next->prev = link;
+			}
+
+			static void unlink_( trie_link *link ){
+				link->prev->next = link->next;
+				link->next->prev = link->prev;
+			}
+
+			trie_descent_ descend_( const key_type &k ) const {
+				trie_descent_	descent;
+				trie_entry		*entry = m_root;
+
+				descent.bucket = NULL;
+				descent.inner = NULL;
+				descent.slot = 0;
+				descent.branch = NULL;
+				descent.depth = 0;
+				while ( entry != NULL && entry->kind == TRIE_INNER ){
+					trie_inner *inner = static_cast<trie_inner *>( entry );
+
+					if ( !inner->skip.empty() ){
+						descent.depth = mismatch_(inner, k);
+						if ( descent.depth != inner->depth ){
+							descent.branch = inner;
+							return descent;
+						}
+					}
+					descent.inner = inner;
+					descent.slot = slot_(k, inner->depth);
+					entry = inner->children[descent.slot];
+				}
+				descent.bucket = static_cast<bucket_type *>( entry );
+				return descent;
+			}
+
+			/**
+			 * Depth the skipped characters of inner start at.
+			 */
+			static size_type start_( const trie_inner *inner ){
+				return inner->depth - inner->skip.size();
+			}
+
+			/**
+			 * Place of the first character of k differing from the skipped ones of inner,
+			 * or the depth of inner when there is none. k reaching inner, it is at least
+			 * as long as their start.
+			 */
+			static size_type mismatch_( const trie_inner *inner, const key_type &k ){
+				size_type start = start_(inner);
+
+				if ( k.compare(start, inner->skip.size(), inner->skip) == 0 )
+					return inner->depth;
+				for ( size_type depth = start ; depth < inner->depth ; depth++ ){
+					if ( depth == k.size() || k[depth] != inner->skip[depth - start] )
+						return depth;
+				}
+				return inner->depth;
+			}
+
+			/**
+			 * The 8 characters of k from depth on, the first one most significant and
+			 * padded with zeros, which order as the rest of the keys do until they are
+			 * equal.
+			 */
+			static uint64_t prefix_( const key_type &k, size_type depth ){
+				uint64_t prefix = 0;
+
+				for ( size_type i = depth ; i < depth + 8 ; i++ ){
+					prefix <<= 8;
+					if ( i < k.size() )
+						prefix |= static_cast<unsigned char>( k[i] );
+				}
+				return prefix;
+			}
+
+			/**
+			 * Compares the characters after depth of key and k, whose prefixes at depth
+			 * are equal. When both end within their prefix, the shorter one is padded with
+			 * zeros and goes first, so their sizes tell without reading their characters.
+			 */
+			static int rest_( const key_type &key, const key_type &k, size_type depth ){
+				if ( key.size() <= depth + 8 && k.size() <= depth + 8 )
+					return ( key.size() < k.size() ) ? -1 : ( key.size() > k.size() );
+				return key.compare(depth, key_type::npos, k, depth, key_type::npos);
+			}
+
+			/**
+			 * First element of bucket whose key does not go before k, comparing the
+			 * prefixes, then on ties the rest of the keys.
+			 */
+			static size_type lower_index_( const bucket_type *bucket, const key_type &k ){
+				uint64_t	prefix = prefix_(k, bucket->depth);
+				size_type	low = 0;
+				size_type	high = bucket->size;
+
+				while ( low < high ){
+					size_type	mid = low + ( high - low ) / 2;
+					uint64_t	other = bucket->prefixes[mid];
+
+					if ( other < prefix || ( other == prefix
+						&& rest_(bucket->at(mid).first, k, bucket->depth) < 0 ) )
+						low = mid + 1;
+					else
+						high = mid;
+				}
+				return low;
+			}
+
+			static trie_link *first_bucket_( trie_entry *entry ){
+				while ( entry->kind == TRIE_INNER ){
+					trie_inner	*inner = static_cast<trie_inner *>( entry );
+					size_type	slot = 0;
+
+					while ( inner->children[slot] == NULL )
+						slot++;
+					entry = inner->children[slot];
+				}
+				return static_cast<bucket_type *>( entry );
+			}
+
+			/**
+			 * First bucket after the subtree of slot in inner, climbing until one of the
+			 * following slots is used, or the head of the chain.
+			 */
+			trie_link *next_bucket_( trie_inner *inner, size_type slot ) const {
+				while ( inner != NULL ){
+					for ( size_type next = slot + 1 ; next < trie_inner::SLOTS ; next++ ){
+						if ( inner->children[next] != NULL )
+							return first_bucket_(inner->children[next]);
+					}
+					slot = inner->slot;
+					inner = inner->parent;
+				}
+				return const_cast<trie_link *>( &m_head );
+			}
+
+			/**
+			 * New empty bucket in the empty slot of inner, or as the root when inner is
+			 * NULL, chained before the next bucket in key order.
+			 */
+			bucket_type *create_bucket_( trie_inner *inner, size_type slot ){
+				bucket_type *bucket = bucket_allocator_type().allocate(1);
+
+				bucket_allocator_type().construct(bucket, bucket_type( 0 ));
+				if ( inner == NULL ){
+					m_root = bucket;
+					link_before_(bucket, &m_head);
+					return bucket;
+				}
+				bucket->depth = ( slot == 0 ) ? inner->depth : inner->depth + 1;
+				bucket->parent = inner;
+				bucket->slot = static_cast<unsigned short>( slot );
+				link_before_(bucket, this->next_bucket_(inner, slot));
+				inner->children[slot] = bucket;
+				inner->count++;
+				return bucket;
+			}
+
+			/**
+			 * Puts the entry at the place of old in the trie.
+			 */
+			void replace_( trie_entry *old, trie_entry *entry ){
+				entry->parent = old->parent;
+				entry->slot = old->slot;
+				if ( old->parent == NULL )
+					m_root = entry;
+				else
+					old->parent->children[old->slot] = entry;
+			}
+
+			/**
+			 * Splits the skipped characters of inner at depth, where a new key differs
+			 * from them: a new inner node of that depth takes its place, holding inner
+			 * with what is left of its skipped characters in the slot of the first one.
+			 * Returns the new node, the key going to one of its empty slots.
+			 */
+			trie_inner *split_( trie_inner *inner, size_type depth ){
+				size_type	start = start_(inner);
+				trie_inner	*node = inner_allocator_type().allocate(1);
+				size_type	slot = 1 + static_cast<unsigned char>( inner->skip[depth - start] );
+
+				try {
+					inner_allocator_type().construct(node, trie_inner( depth, inner->skip.substr(0, depth - start) ));
+				} catch ( ... ){
+					inner_allocator_type().deallocate(node, 1);
+					throw ;
+				}
+				inner->skip.erase(0, depth - start + 1);
+				this->replace_(inner, node);
+				inner->parent = node;
+				inner->slot = static_cast<unsigned short>( slot );
+				node->children[slot] = inner;
+				node->count = 1;
+				return node;
+			}
+
+			/**
+			 * Removes the empty entry from the trie, then the inner nodes left empty.
+			 */
+			void detach_( trie_entry *entry ){
+				trie_inner *parent = entry->parent;
+
+				if ( parent == NULL ){
+					m_root = NULL;
+					return ;
+				}
+				parent->children[entry->slot] = NULL;
+				if ( --parent->count == 0 ){
+					this->detach_(parent);
+					inner_allocator_type().destroy(parent);
+					inner_allocator_type().deallocate(parent, 1);
+				}
+			}
+
+			/**
+			 * Moves the elements of bucket to arrays of capacity, in key order.
+			 */
+			void reserve_( bucket_type *bucket, size_type capacity ){
+				value_type		*items;
+				unsigned short	*order;
+				uint64_t		*prefixes;
+
+				if ( capacity <= bucket->capacity )
+					return ;
+				items = m_alloc.allocate(capacity);
+				order = order_allocator_type().allocate(capacity);
+				prefixes = prefix_allocator_type().allocate(capacity);
+				for ( size_type rank = 0 ; rank < bucket->size ; rank++ ){
+					m_alloc.construct(items + rank, bucket->at(rank));
+					order[rank] = static_cast<unsigned short>( rank );
+					prefixes[rank] = bucket->prefixes[rank];
+				}
+				this->release_items_(bucket);
+				bucket->items = items;
+				bucket->order = order;
+				bucket->prefixes = prefixes;
+				bucket->capacity = capacity;
+			}
+
+			/**
+			 * Appends a copy of val to the items of bucket, at rank in key order. Grows
+			 * by half, buckets holding up to BURST_SIZE + 1 elements.
+			 */
+			void insert_item_( bucket_type *bucket, size_type rank, const value_type &val ){
+				if ( bucket->size == bucket->capacity ){
+					size_type capacity = bucket->capacity + bucket->capacity / 2;
+
+					if ( capacity < 4 )
+						capacity = 4;
+					if ( capacity > BURST_SIZE + 1 )
+						capacity = BURST_SIZE + 1;
+					this->reserve_(bucket, capacity);
+				}
+				m_alloc.construct(bucket->items + bucket->size, val);
+				std::memmove(bucket->order + rank + 1, bucket->order + rank, ( bucket->size - rank ) * sizeof(unsigned short));
+				std::memmove(bucket->prefixes + rank + 1, bucket->prefixes + rank, ( bucket->size - rank ) * sizeof(uint64_t));
+				bucket->order[rank] = static_cast<unsigned short>( bucket->size );
+				bucket->prefixes[rank] = prefix_(val.first, bucket->depth);
+				bucket->size++;
+			}
+
+			/**
+			 * Erases the element at position and returns the one after it, freeing its
+			 * bucket once empty.
+			 */
+			iterator erase_item_( iterator position ){
+				bucket_type		*bucket = static_cast<bucket_type *>( position.m_bucket );
+				value_type		*items = bucket->items;
+				trie_link		*next = bucket->next;
+				unsigned short	hole = bucket->order[position.m_index];
+				unsigned short	last = static_cast<unsigned short>( bucket->size - 1 );
+
+				// The last item fills the hole, its position follows it
+				std::memmove(bucket->order + position.m_index, bucket->order + position.m_index + 1,
+					( last - position.m_index ) * sizeof(unsigned short));
+				std::memmove(bucket->prefixes + position.m_index, bucket->prefixes + position.m_index + 1,
+					( last - position.m_index ) * sizeof(uint64_t));
+				if ( hole != last ){
+					m_alloc.destroy(items + hole);
+					m_alloc.construct(items + hole, items[last]);
+					for ( size_type rank = 0 ; rank < last ; rank++ ){
+						if ( bucket->order[rank] == last ){
+							bucket->order[rank] = hole;
+							break ;
+						}
+					}
+				}
+				m_alloc.destroy(items + last);
+				bucket->size--;
+				m_size--;
+				if ( bucket->size == 0 ){
+					unlink_(bucket);
+					this->detach_(bucket);
+					this->destroy_bucket_(bucket);
+					return iterator( next, 0 );
+				}
+				if ( position.m_index == bucket->size )
+					return iterator( next, 0 );
+				return position;
+			}
+
+			/**
+			 * Bursts bucket into a trie node splitting its keys on the first character
+			 * they do not all share, found comparing the first and last keys. The new
+			 * buckets, sized for their keys, are filled in key order one after the other,
+			 * and take the place of bucket in the chain. The keys going to two slots at
+			 * least, none of the new buckets goes over BURST_SIZE.
+			 */
+			void burst_( bucket_type *bucket ){
+				const key_type	&first = bucket->at(0).first;
+				const key_type	&last = bucket->at(bucket->size - 1).first;
+				size_type		depth = bucket->depth;
+				trie_inner		*inner = inner_allocator_type().allocate(1);
+				size_type		counts[trie_inner::SLOTS] = { 0 };
+				bucket_type		*child = NULL;
+
+				while ( depth < first.size() && first[depth] == last[depth] )
+					depth++;
+				try {
+					inner_allocator_type().construct(inner, trie_inner( depth, first.substr(bucket->depth, depth - bucket->depth) ));
+				} catch ( ... ){
+					inner_allocator_type().deallocate(inner, 1);
+					throw ;
+				}
+				this->replace_(bucket, inner);
+				for ( size_type rank = 0 ; rank < bucket->size ; rank++ ){
+					counts[slot_(bucket->at(rank).first, inner->depth)]++;
+				}
+				for ( size_type rank = 0 ; rank < bucket->size ; rank++ ){
+					size_type slot = slot_(bucket->at(rank).first, inner->depth);
+
+					if ( inner->children[slot] == NULL ){
+						child = bucket_allocator_type().allocate(1);
+						bucket_allocator_type().construct(child, bucket_type( ( slot == 0 ) ? inner->depth : inner->depth + 1 ));
+						child->parent = inner;
+						child->slot = static_cast<unsigned short>( slot );
+						inner->children[slot] = child;
+						inner->count++;
+						link_before_(child, bucket);
+						this->reserve_(child, counts[slot]);
+					}
+					this->insert_item_(child, child->size, bucket->at(rank));
+				}
+				unlink_(bucket);
+				this->destroy_bucket_(bucket);
+			}
+
+			/**
+			 * Destroys the elements of bucket and frees its arrays.
+			 */
+			void release_items_( bucket_type *bucket ){
+				for ( size_type index = 0 ; index < bucket->size ; index++ ){
+					m_alloc.destroy(bucket->items + index);
+				}
+				if ( bucket->items != NULL ){
+					m_alloc.deallocate(bucket->items, bucket->capacity);
+					order_allocator_type().deallocate(bucket->order, bucket->capacity);
+					prefix_allocator_type().deallocate(bucket->prefixes, bucket->capacity);
+				}
+			}
+
+			void destroy_bucket_( bucket_type *bucket ){
+				this->release_items_(bucket);
+				bucket_allocator_type().destroy(bucket);
+				bucket_allocator_type().deallocate(bucket, 1);
+			}
+
+			void destroy_( trie_entry *entry ){
+				if ( entry == NULL )
+					return ;
+				if ( entry->kind == TRIE_BUCKET ){
+					this->destroy_bucket_(static_cast<bucket_type *>( entry ));
+					return ;
+				}
+				trie_inner *inner = static_cast<trie_inner *>( entry );
+
+				for ( size_type slot = 0 ; slot < trie_inner::SLOTS ; slot++ ){
+					this->destroy_(inner->children[slot]);
+				}
+				inner_allocator_type().destroy(inner);
+				inner_allocator_type().deallocate(inner, 1);
+			}
+	};
+
+	template<class T, class Alloc>
+	void swap( trie_map<T, Alloc> &x, trie_map<T, Alloc> &y ){
+		x.swap( y );
+	}
+
+	template <class T, class Alloc>
+	bool operator==( const trie_map<T,Alloc>& x, const trie_map<T,Alloc>& y ){
+		return x.size() == y.size() && ft::equal(x.begin(), x.end(), y.begin(), y.end());
+	}
+
+	template <class T, class Alloc>
+	bool operator!=( const trie_map<T,Alloc>& x, const trie_map<T,Alloc>& y ){
+		return !(x == y);
+	}
+
+	template <class T, class Alloc>
+	bool operator< ( const trie_map<T,Alloc>& x, const trie_map<T,Alloc>& y ){
+		return ft::lexicographical_compare(x.begin(), x.end(), y.begin(), y.end());
+	}
+
+	template <class T, class Alloc>
+	bool operator<=( const trie_map<T,Alloc>& x, const trie_map<T,Alloc>& y ){
+		return !( y < x );
+	}
+
+	template <class T, class Alloc>
+	bool operator> ( const trie_map<T,Alloc>& x, const trie_map<T,Alloc>& y ){
+		return y < x;
+	}
+
+	template <class T, class Alloc>
+	bool operator>=( const trie_map<T,Alloc>& x, const trie_map<T,Alloc>& y ){
+		return !( x < y );
+	}
+}
+
+#endif
@@ -0,0 +1,100 @@
+#ifndef THREAD_HPP
+#define THREAD_HPP
+
+# include <cstddef>
+# include <pthread.h>
+# include <unistd.h>
+
+namespace ft {
+	template<class Task>
+	void *thread_run_(void *task){
+		(*static_cast<Task *>(task))();
+		return NULL;
+	}
+
+	/**
+	 * Fork join
+	 * 
+	 * Runs first on a new thread and second on the calling thread, and returns once both
+	 * are done. When no thread can be created, first runs on the calling thread after second.
+	 * 
+	 */
+	template<class First, class Second>
+	void parallel_invoke(First &first, Second &second){
+		pthread_t	thread;
+		bool		spawned = pthread_create(&thread, NULL, thread_run_<First>, &first) == 0;
+
+		second();
+		if ( spawned )
+			pthread_join(thread, NULL);
+		else
+			first();
+	}
+
+	template<class Task>
+	void parallel_repeat(const Task &task, std::size_t count);
+
+	template<class Task>
+	struct parallel_repeat_ {
+		const Task	*task;
+		std::size_t	count;
+
+		void operator()(){
+			parallel_repeat(*task, count);
+		}
+	};
+
+	/**
+	 * Runs count copies of task, each on its own thread but the first one which runs on
+	 * the calling thread, and returns once all of them are done.
+	 * 
+	 */
+	template<class Task>
+	void parallel_repeat(const Task &task, std::size_t count){
+		if ( count <= 1 ){
+			Task copy( task );
+
+			copy();
+			return ;
+		}
+
+		parallel_repeat_<Task>	first = { &task, count / 2 };
+		parallel_repeat_<Task>	second = { &task, count - count / 2 };
+
+		ft::parallel_invoke(second, first);
+	}
+
+	/**
+	 * Atomic operations
+	 * 
+	 * atomic_add adds value to target and returns the result. atomic_exchange stores
+	 * value in target and returns the former one. atomic_compare_exchange stores value
+	 * in target only if it still holds expected, and returns what target held before,
+	 * so that the store happened if and only if expected is returned.
+	 * 
+	 */
+	inline long atomic_add(volatile long &target, long value){
+		return __sync_add_and_fetch(&target, value);
+	}
+
+	template<class T>
+	T *atomic_exchange(T *volatile &target, T *value){
+		return __sync_lock_test_and_set(&target, value);
+	}
+
+	template<class T>
+	T *atomic_compare_exchange(T *volatile &target, T *expected, T *value){
+		return __sync_val_compare_and_swap(&target, expected, value);
+	}
+
+	/**
+	 * Number of processors online, at least one.
+	 */
+	inline std::size_t hardware_concurrency(){
+		long count = sysconf(_SC_NPROCESSORS_ONLN);
+
+		return ( count < 1 ) ? 1 : static_cast<std::size_t>(count);
+	}
+}
+
+#endif